@@ -0,0 +1,443 @@
+// BenchMain.cpp
+// SlangCompilerBench: times each phase of a compile separately over a
+// synthetic corpus and writes percentiles and throughput as JSON.
+#include "BenchStats.h"
+#include "CoreModuleCache.h"
+#include "ShaderCompiler.h"
+#include "ShaderCorpus.h"
+#include "SpirvCodec.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct BenchOptions
+    {
+        size_t iterations = 20;
+        size_t warmup = 2;
+        size_t globalSessionIterations = 3;
+        std::filesystem::path corpusDirectory = std::filesystem::temp_directory_path() / "SlangCompilerBench";
+        std::string outputPath; // stdout when empty
+        std::vector<CorpusConfig> configs;
+    };
+
+    struct CodecResult
+    {
+        size_t spirvBytes = 0;
+        size_t encodedBytes = 0;
+        size_t strippedBytes = 0;
+        PhaseSamples encode;
+        PhaseSamples decode; // One sample per pass over all modules
+    };
+
+    struct CorpusResult
+    {
+        CorpusConfig config;
+        size_t sourceBytes = 0; // Main shader plus imported modules
+        PhaseSamples session;
+        PhaseSamples loadModule;
+        PhaseSamples link;
+        PhaseSamples entryPointCode; // One sample per entry point
+        PhaseSamples reflection;
+        PhaseSamples total;
+        PhaseSamples targetCode; // One whole-program module per compile, outside total
+        size_t entryPointCodeBytes = 0; // Per-entry modules of the last timed compile
+        size_t targetCodeBytes = 0;
+        std::vector<std::vector<uint8_t>> spirv; // Last timed compile, for the codec
+        CodecResult codec;
+        std::string error;
+    };
+
+
+    void printUsage(const char* programName)
+    {
+        std::cout << "Slang Shader Compiler Benchmark\n";
+        std::cout << "Usage:\n";
+        std::cout << "  " << programName << " [options]\n\n";
+        std::cout << "Options:\n";
+        std::cout << "  -iterations <n>              Timed compiles per corpus (default: 20)\n";
+        std::cout << "  -warmup <n>                  Untimed compiles per corpus first (default: 2)\n";
+        std::cout << "  -config <e,d,c,s>            Entry points, include depth, cbuffers, source bytes; repeatable\n";
+        std::cout << "  -corpus <dir>                Where generated shaders are written\n";
+        std::cout << "  -out <file>                  Write the JSON report to <file> instead of stdout\n";
+    }
+
+    std::vector<CorpusConfig> defaultConfigs()
+    {
+        std::vector<CorpusConfig> configs;
+        for (size_t entryCount : { 1, 8 })
+        {
+            for (size_t includeDepth : { 0, 4 })
+            {
+                for (size_t cbufferCount : { 1, 16 })
+                {
+                    for (size_t sourceBytes : { 4u << 10, 64u << 10 })
+                    {
+                        configs.push_back({ entryCount, includeDepth, cbufferCount, sourceBytes });
+                    }
+                }
+            }
+        }
+        return configs;
+    }
+
+    bool parseConfig(const std::string& text, CorpusConfig& config)
+    {
+        std::stringstream stream(text);
+        char comma1 = 0, comma2 = 0, comma3 = 0;
+        stream >> config.entryCount >> comma1 >> config.includeDepth >> comma2 >> config.cbufferCount >> comma3 >> config.sourceBytes;
+        return stream && comma1 == ',' && comma2 == ',' && comma3 == ',' && config.entryCount > 0;
+    }
+
+    Slang::ComPtr<slang::ISession> createSession(slang::IGlobalSession* globalSession, const ShaderCorpus& corpus)
+    {
+        std::string searchPath = corpus.directory.string();
+        const char* searchPaths[] = { searchPath.c_str() };
+
+        slang::TargetDesc targetDesc = {};
+        targetDesc.format = SLANG_SPIRV;
+        targetDesc.profile = globalSession->findProfile("sm_6_0");
+
+        slang::SessionDesc sessionDesc = {};
+        sessionDesc.targets = &targetDesc;
+        sessionDesc.targetCount = 1;
+        sessionDesc.searchPaths = searchPaths;
+        sessionDesc.searchPathCount = 1;
+
+        Slang::ComPtr<slang::ISession> session;
+        globalSession->createSession(sessionDesc, session.writeRef());
+        if (!session)
+        {
+            throw std::runtime_error("Failed to create Slang session");
+        }
+        return session;
+    }
+
+    // One cold compile in a fresh session, timed phase by phase
+    void compileOnce(slang::IGlobalSession* globalSession, const ShaderCorpus& corpus, CorpusResult* result)
+    {
+        Slang::ComPtr<slang::IBlob> diagnostics;
+        Clock::time_point start = Clock::now();
+
+        Slang::ComPtr<slang::ISession> session = createSession(globalSession, corpus);
+        Clock::time_point sessionDone = Clock::now();
+
+        std::string path = corpus.mainPath.string();
+        slang::IModule* module = session->loadModuleFromSourceString("bench_main", path.c_str(),
+            corpus.mainSource.c_str(), diagnostics.writeRef());
+        if (!module)
+        {
+            std::string message = diagnostics ? std::string((const char*)diagnostics->getBufferPointer(), diagnostics->getBufferSize()) : "";
+            throw std::runtime_error("Failed to load benchmark module: " + message);
+        }
+        Clock::time_point loadDone = Clock::now();
+
+        std::vector<Slang::ComPtr<slang::IEntryPoint>> entryPoints;
+        std::vector<slang::IComponentType*> components{ module };
+        for (const auto& name : corpus.entryPoints)
+        {
+            Slang::ComPtr<slang::IEntryPoint> entryPoint;
+            module->findEntryPointByName(name.c_str(), entryPoint.writeRef());
+            if (!entryPoint)
+            {
+                throw std::runtime_error("Failed to find entry point: " + name);
+            }
+            components.push_back(entryPoint.get());
+            entryPoints.push_back(entryPoint);
+        }
+        Slang::ComPtr<slang::IComponentType> program;
+        session->createCompositeComponentType(components.data(), (SlangInt)components.size(),
+            program.writeRef(), diagnostics.writeRef());
+        Slang::ComPtr<slang::IComponentType> linkedProgram;
+        if (program)
+        {
+            program->link(linkedProgram.writeRef(), diagnostics.writeRef());
+        }
+        if (!linkedProgram)
+        {
+            throw std::runtime_error("Failed to link benchmark program");
+        }
+        Clock::time_point linkDone = Clock::now();
+
+        std::vector<Clock::duration> codegen;
+        for (size_t i = 0; i < corpus.entryPoints.size(); ++i)
+        {
+            Clock::time_point entryStart = Clock::now();
+            Slang::ComPtr<slang::IBlob> code;
+            linkedProgram->getEntryPointCode((SlangInt)i, 0, code.writeRef(), diagnostics.writeRef());
+            if (!code)
+            {
+                throw std::runtime_error("No code generated for entry point: " + corpus.entryPoints[i]);
+            }
+            codegen.push_back(Clock::now() - entryStart);
+            if (result)
+            {
+                const uint8_t* bytes = static_cast<const uint8_t*>(code->getBufferPointer());
+                result->spirv.resize(corpus.entryPoints.size());
+                result->spirv[i].assign(bytes, bytes + code->getBufferSize());
+            }
+        }
+        Clock::time_point codegenDone = Clock::now();
+
+        std::shared_ptr<const ReflectionTable> reflection = SlangCompiler::extractResourceBindings(linkedProgram.get(), 0);
+        Clock::time_point reflectionDone = Clock::now();
+
+        // The same entry points as one module, as CompileOptions::wholeProgram produces
+        Slang::ComPtr<slang::IBlob> targetCode;
+        linkedProgram->getTargetCode(0, targetCode.writeRef(), diagnostics.writeRef());
+        if (!targetCode)
+        {
+            throw std::runtime_error("No whole-program code generated");
+        }
+        Clock::time_point targetCodeDone = Clock::now();
+
+        // Warm-up runs pass no result
+        if (result)
+        {
+            result->session.add(sessionDone - start);
+            result->loadModule.add(loadDone - sessionDone);
+            result->link.add(linkDone - loadDone);
+            for (Clock::duration elapsed : codegen)
+            {
+                result->entryPointCode.add(elapsed);
+            }
+            result->reflection.add(reflectionDone - codegenDone);
+            result->total.add(reflectionDone - start);
+            result->targetCode.add(targetCodeDone - reflectionDone);
+            result->entryPointCodeBytes = 0;
+            for (const auto& module : result->spirv)
+            {
+                result->entryPointCodeBytes += module.size();
+            }
+            result->targetCodeBytes = targetCode->getBufferSize();
+        }
+    }
+
+    // Encodes every module once, then decodes all of them repeatedly into one reused buffer
+    CodecResult benchSpirvCodec(const std::vector<std::vector<uint8_t>>& modules, size_t iterations)
+    {
+        CodecResult codec;
+        std::vector<std::vector<uint8_t>> encoded;
+        size_t largest = 0;
+        for (const auto& spirv : modules)
+        {
+            Clock::time_point start = Clock::now();
+            encoded.push_back(encodeSpirv(spirv));
+            codec.encode.add(Clock::now() - start);
+            codec.spirvBytes += spirv.size();
+            codec.encodedBytes += encoded.back().size();
+            codec.strippedBytes += encodeSpirv(spirv, { true }).size();
+            largest = std::max(largest, spirv.size());
+        }
+        std::vector<uint32_t> words(largest / 4);
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            Clock::time_point start = Clock::now();
+            for (const auto& module : encoded)
+            {
+                decodeSpirv(module, words);
+            }
+            codec.decode.add(Clock::now() - start);
+        }
+        return codec;
+    }
+
+    void writeCodec(JsonWriter& json, const CodecResult& codec)
+    {
+        double decodeSeconds = codec.decode.total() / 1e6;
+        double encodeSeconds = codec.encode.total() / 1e6;
+        size_t passes = codec.decode.summary().count;
+        json.beginObject("spirvCodec");
+        json.value("spirvBytes", (uint64_t)codec.spirvBytes);
+        json.value("encodedBytes", (uint64_t)codec.encodedBytes);
+        json.value("strippedBytes", (uint64_t)codec.strippedBytes);
+        json.value("ratio", codec.encodedBytes ? (double)codec.spirvBytes / codec.encodedBytes : 0.0);
+        json.value("strippedRatio", codec.strippedBytes ? (double)codec.spirvBytes / codec.strippedBytes : 0.0);
+        json.value("encodeMBPerSecond", encodeSeconds > 0 ? codec.spirvBytes / encodeSeconds / (1 << 20) : 0.0);
+        json.value("decodeMBPerSecond", decodeSeconds > 0 ? passes * codec.spirvBytes / decodeSeconds / (1 << 20) : 0.0);
+        json.endObject();
+    }
+
+    void writeThroughput(JsonWriter& json, const CorpusResult& result)
+    {
+        double seconds = result.total.total() / 1e6;
+        size_t compiles = result.total.summary().count;
+        json.beginObject("throughput");
+        json.value("compilesPerSecond", seconds > 0 ? compiles / seconds : 0.0);
+        json.value("entryPointsPerSecond", seconds > 0 ? compiles * result.config.entryCount / seconds : 0.0);
+        json.value("sourceMBPerSecond", seconds > 0 ? compiles * result.sourceBytes / seconds / (1 << 20) : 0.0);
+        json.endObject();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-iterations" && hasValue) {
+            options.iterations = std::max<size_t>(1, std::stoul(argv[++i]));
+        }
+        else if (arg == "-warmup" && hasValue) {
+            options.warmup = std::stoul(argv[++i]);
+        }
+        else if (arg == "-config" && hasValue) {
+            CorpusConfig config;
+            if (!parseConfig(argv[++i], config)) {
+                std::cerr << "Error: -config expects <entries,depth,cbuffers,bytes>\n";
+                return 1;
+            }
+            options.configs.push_back(config);
+        }
+        else if (arg == "-corpus" && hasValue) {
+            options.corpusDirectory = argv[++i];
+        }
+        else if (arg == "-out" && hasValue) {
+            options.outputPath = argv[++i];
+        }
+        else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else {
+            std::cerr << "Unknown or incomplete argument: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.configs.empty())
+    {
+        options.configs = defaultConfigs();
+    }
+
+    // Global session creation is paid once per process; sample it a few times
+    PhaseSamples globalSessionSamples;
+    Slang::ComPtr<slang::IGlobalSession> globalSession;
+    SlangGlobalSessionDesc globalDesc = {};
+    for (size_t i = 0; i < options.globalSessionIterations; ++i)
+    {
+        Clock::time_point start = Clock::now();
+        globalSession = nullptr;
+        slang::createGlobalSession(&globalDesc, globalSession.writeRef());
+        globalSessionSamples.add(Clock::now() - start);
+    }
+    if (!globalSession)
+    {
+        std::cerr << "Error: failed to create the Slang global session\n";
+        return 1;
+    }
+
+    // Same again from a core module snapshot; the first call writes it and is not sampled
+    PhaseSamples snapshotSamples;
+    try
+    {
+        std::filesystem::path snapshotDirectory = options.corpusDirectory / "core";
+        createGlobalSessionWithSnapshot(globalDesc, snapshotDirectory);
+        for (size_t i = 0; i < options.globalSessionIterations; ++i)
+        {
+            Clock::time_point start = Clock::now();
+            createGlobalSessionWithSnapshot(globalDesc, snapshotDirectory);
+            snapshotSamples.add(Clock::now() - start);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Warning: core module snapshot: " << e.what() << "\n";
+    }
+
+    std::vector<CorpusResult> results;
+    for (const CorpusConfig& config : options.configs)
+    {
+        CorpusResult result;
+        result.config = config;
+        try
+        {
+            ShaderCorpus corpus = generateCorpus(config, options.corpusDirectory / config.name());
+            result.sourceBytes = corpus.mainSource.size();
+            for (const auto& entry : std::filesystem::directory_iterator(corpus.directory))
+            {
+                if (entry.path() != corpus.mainPath && entry.path().extension() == ".slang")
+                {
+                    result.sourceBytes += (size_t)entry.file_size();
+                }
+            }
+
+            for (size_t i = 0; i < options.warmup; ++i)
+            {
+                compileOnce(globalSession, corpus, nullptr);
+            }
+            for (size_t i = 0; i < options.iterations; ++i)
+            {
+                compileOnce(globalSession, corpus, &result);
+            }
+            result.codec = benchSpirvCodec(result.spirv, std::max<size_t>(options.iterations, 100));
+        }
+        catch (const std::exception& e)
+        {
+            result.error = e.what();
+        }
+        std::cerr << config.name() << ": " << (result.error.empty()
+            ? std::to_string(result.total.summary().p50Us) + " us p50" : result.error) << "\n";
+        results.push_back(std::move(result));
+    }
+
+    std::ofstream file;
+    if (!options.outputPath.empty())
+    {
+        file.open(options.outputPath, std::ios::out | std::ios::trunc);
+        if (!file)
+        {
+            std::cerr << "Error: cannot write " << options.outputPath << "\n";
+            return 1;
+        }
+    }
+    JsonWriter json(options.outputPath.empty() ? std::cout : file);
+    json.beginObject();
+    json.value("slangBuildTag", std::string_view(globalSession->getBuildTagString()));
+    json.value("iterations", (uint64_t)options.iterations);
+    json.summary("globalSession", globalSessionSamples.summary());
+    json.summary("globalSessionSnapshot", snapshotSamples.summary());
+    json.beginArray("corpora");
+    bool failed = false;
+    for (const CorpusResult& result : results)
+    {
+        json.beginObject();
+        json.value("name", result.config.name());
+        json.value("entryPoints", (uint64_t)result.config.entryCount);
+        json.value("includeDepth", (uint64_t)result.config.includeDepth);
+        json.value("cbuffers", (uint64_t)result.config.cbufferCount);
+        json.value("sourceBytes", (uint64_t)result.sourceBytes);
+        if (!result.error.empty())
+        {
+            json.value("error", result.error);
+            failed = true;
+        }
+        else
+        {
+            json.beginObject("phases");
+            json.summary("createSession", result.session.summary());
+            json.summary("loadModuleFromSourceString", result.loadModule.summary());
+            json.summary("link", result.link.summary());
+            json.summary("getEntryPointCode", result.entryPointCode.summary());
+            json.summary("extractResourceBindings", result.reflection.summary());
+            json.summary("total", result.total.summary());
+            json.summary("getTargetCode", result.targetCode.summary());
+            json.endObject();
+            json.beginObject("codeBytes");
+            json.value("perEntryPoint", (uint64_t)result.entryPointCodeBytes);
+            json.value("wholeProgram", (uint64_t)result.targetCodeBytes);
+            json.endObject();
+            writeThroughput(json, result);
+            writeCodec(json, result.codec);
+        }
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+#include "BenchStats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+namespace
+{
+    // Nearest-rank percentile of sorted samples
+    double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        size_t rank = (size_t)std::ceil(fraction * sorted.size());
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+}
+
+double PhaseSamples::total() const
+{
+    return std::accumulate(m_samples.begin(), m_samples.end(), 0.0);
+}
+
+PhaseSummary PhaseSamples::summary() const
+{
+    PhaseSummary summary;
+    if (m_samples.empty())
+    {
+        return summary;
+    }
+    std::vector<double> sorted = m_samples;
+    std::sort(sorted.begin(), sorted.end());
+    summary.count = sorted.size();
+    summary.minUs = sorted.front();
+    summary.maxUs = sorted.back();
+    summary.meanUs = total() / sorted.size();
+    summary.p50Us = percentile(sorted, 0.50);
+    summary.p90Us = percentile(sorted, 0.90);
+    summary.p99Us = percentile(sorted, 0.99);
+    return summary;
+}
+
+void JsonWriter::beginObject(std::string_view key)
+{
+    separator(key);
+    m_stream << '{';
+    m_hasItems.push_back(false);
+    ++m_depth;
+}
+
+void JsonWriter::endObject()
+{
+    --m_depth;
+    bool hadItems = m_hasItems.back();
+    m_hasItems.pop_back();
+    if (hadItems)
+    {
+        m_stream << '\n' << std::string(m_depth * 2, ' ');
+    }
+    m_stream << '}';
+    if (m_depth == 0)
+    {
+        m_stream << '\n';
+    }
+}
+
+void JsonWriter::beginArray(std::string_view key)
+{
+    separator(key);
+    m_stream << '[';
+    m_hasItems.push_back(false);
+    ++m_depth;
+}
+
+void JsonWriter::endArray()
+{
+    --m_depth;
+    bool hadItems = m_hasItems.back();
+    m_hasItems.pop_back();
+    if (hadItems)
+    {
+        m_stream << '\n' << std::string(m_depth * 2, ' ');
+    }
+    m_stream << ']';
+}
+
+void JsonWriter::value(std::string_view key, std::string_view text)
+{
+    separator(key);
+    writeString(text);
+}
+
+void JsonWriter::value(std::string_view key, double number)
+{
+    separator(key);
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", std::isfinite(number) ? number : 0.0);
+    m_stream << buffer;
+}
+
+void JsonWriter::value(std::string_view key, uint64_t number)
+{
+    separator(key);
+    m_stream << number;
+}
+
+void JsonWriter::summary(std::string_view key, const PhaseSummary& summary)
+{
+    beginObject(key);
+    value("count", (uint64_t)summary.count);
+    value("minUs", summary.minUs);
+    value("meanUs", summary.meanUs);
+    value("p50Us", summary.p50Us);
+    value("p90Us", summary.p90Us);
+    value("p99Us", summary.p99Us);
+    value("maxUs", summary.maxUs);
+    endObject();
+}
+
+void JsonWriter::separator(std::string_view key)
+{
+    if (!m_hasItems.empty())
+    {
+        if (m_hasItems.back())
+        {
+            m_stream << ',';
+        }
+        m_hasItems.back() = true;
+        m_stream << '\n' << std::string(m_depth * 2, ' ');
+    }
+    if (!key.empty())
+    {
+        writeString(key);
+        m_stream << ": ";
+    }
+}
+
+void JsonWriter::writeString(std::string_view text)
+{
+    m_stream << '"';
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"': m_stream << "\\\""; break;
+        case '\\': m_stream << "\\\\"; break;
+        case '\n': m_stream << "\\n"; break;
+        case '\t': m_stream << "\\t"; break;
+        default:
+            if ((unsigned char)c < 0x20)
+            {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                m_stream << buffer;
+            }
+            else
+            {
+                m_stream << c;
+            }
+        }
+    }
+    m_stream << '"';
+}
@@ -0,0 +1,63 @@
+#pragma once
+// BenchStats.h
+// Timing samples, percentile summaries and a minimal JSON writer for the
+// benchmark report.
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PhaseSummary
+{
+    size_t count = 0;
+    double minUs = 0;
+    double meanUs = 0;
+    double p50Us = 0;
+    double p90Us = 0;
+    double p99Us = 0;
+    double maxUs = 0;
+};
+
+class PhaseSamples
+{
+public:
+    void add(std::chrono::steady_clock::duration elapsed)
+    {
+        m_samples.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+    }
+    void addMicroseconds(double microseconds) { m_samples.push_back(microseconds); }
+
+    bool empty() const { return m_samples.empty(); }
+    double total() const;
+    PhaseSummary summary() const;
+
+private:
+    std::vector<double> m_samples;
+};
+
+// Streaming JSON writer; callers are responsible for well-formed nesting
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::ostream& stream) : m_stream(stream) {}
+
+    void beginObject(std::string_view key = {});
+    void endObject();
+    void beginArray(std::string_view key = {});
+    void endArray();
+
+    void value(std::string_view key, std::string_view text);
+    void value(std::string_view key, double number);
+    void value(std::string_view key, uint64_t number);
+    void summary(std::string_view key, const PhaseSummary& summary);
+
+private:
+    std::ostream& m_stream;
+    std::vector<bool> m_hasItems; // Per open scope
+    int m_depth = 0;
+
+    void separator(std::string_view key);
+    void writeString(std::string_view text);
+};
@@ -0,0 +1,96 @@
+#include "ShaderCorpus.h"
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    void writeFile(const std::filesystem::path& path, const std::string& text)
+    {
+        std::ofstream stream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.write(text.data(), (std::streamsize)text.size()))
+        {
+            throw std::runtime_error("Failed to write corpus file: " + path.string());
+        }
+    }
+
+    std::string moduleName(size_t level)
+    {
+        return "bench_inc" + std::to_string(level);
+    }
+}
+
+std::string CorpusConfig::name() const
+{
+    return "e" + std::to_string(entryCount) + "_d" + std::to_string(includeDepth) +
+        "_c" + std::to_string(cbufferCount) + "_s" + std::to_string(sourceBytes);
+}
+
+ShaderCorpus generateCorpus(const CorpusConfig& config, const std::filesystem::path& directory)
+{
+    ShaderCorpus corpus;
+    corpus.config = config;
+    corpus.directory = directory;
+    std::filesystem::create_directories(directory);
+
+    // Import chain: each level calls into the next so none of it is dead code
+    for (size_t level = 0; level < config.includeDepth; ++level)
+    {
+        std::string text;
+        bool last = level + 1 == config.includeDepth;
+        if (!last)
+        {
+            text += "import " + moduleName(level + 1) + ";\n\n";
+        }
+        text += "public float4 " + moduleName(level) + "_value(float4 x)\n{\n";
+        text += last ? "    return x;\n" : "    return " + moduleName(level + 1) + "_value(x) * 0.5 + " + std::to_string(level) + ".0;\n";
+        text += "}\n";
+        writeFile(directory / (moduleName(level) + ".slang"), text);
+    }
+
+    std::string& source = corpus.mainSource;
+    if (config.includeDepth > 0)
+    {
+        source += "import " + moduleName(0) + ";\n\n";
+    }
+    source += "RWStructuredBuffer<float4> gOutput;\n\n";
+
+    std::string cbufferSum = "float4(0.0)";
+    for (size_t c = 0; c < config.cbufferCount; ++c)
+    {
+        std::string prefix = "cb" + std::to_string(c);
+        source += "cbuffer CB" + std::to_string(c) + "\n{\n";
+        source += "    float4 " + prefix + "_scale;\n";
+        source += "    float4x4 " + prefix + "_transform;\n";
+        source += "};\n\n";
+        cbufferSum += " + mul(" + prefix + "_transform, " + prefix + "_scale)";
+    }
+
+    for (size_t e = 0; e < config.entryCount; ++e)
+    {
+        std::string name = "entry" + std::to_string(e);
+        corpus.entryPoints.push_back(name);
+        std::string value = "float4(float3(id), " + std::to_string(e) + ".0)";
+        if (config.includeDepth > 0)
+        {
+            value = moduleName(0) + "_value(" + value + ")";
+        }
+        source += "[shader(\"compute\")]\n[numthreads(64, 1, 1)]\n";
+        source += "void " + name + "(uint3 id : SV_DispatchThreadID)\n{\n";
+        source += "    gOutput[id.x] = " + value + " + " + cbufferSum + ";\n";
+        source += "}\n\n";
+    }
+
+    // Unused helpers bring the source up to size; they cost parse and check time only
+    for (size_t pad = 0; source.size() < config.sourceBytes; ++pad)
+    {
+        std::string index = std::to_string(pad);
+        source += "float4 padding" + index + "(float4 x, float4 y)\n{\n";
+        source += "    float4 t = x * " + index + ".0 + y;\n";
+        source += "    return t * t - float4(dot(x, y), length(t), " + index + ".5, 1.0);\n";
+        source += "}\n\n";
+    }
+
+    corpus.mainPath = directory / ("bench_main_" + config.name() + ".slang");
+    writeFile(corpus.mainPath, source);
+    return corpus;
+}
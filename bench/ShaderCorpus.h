@@ -0,0 +1,31 @@
+#pragma once
+// ShaderCorpus.h
+// Synthetic Slang sources for benchmarking. Each corpus is a main shader with
+// a number of compute entry points and constant buffers, padded to a target
+// size, importing a chain of modules includeDepth deep.
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct CorpusConfig
+{
+    size_t entryCount = 1;
+    size_t includeDepth = 0;
+    size_t cbufferCount = 1;
+    size_t sourceBytes = 4096; // Approximate size of the main shader
+
+    std::string name() const;
+};
+
+struct ShaderCorpus
+{
+    CorpusConfig config;
+    std::filesystem::path directory; // Holds the imported modules; use as a search path
+    std::filesystem::path mainPath;
+    std::string mainSource;
+    std::vector<std::string> entryPoints;
+};
+
+// Writes the corpus under directory (created if needed) and returns it
+ShaderCorpus generateCorpus(const CorpusConfig& config, const std::filesystem::path& directory);
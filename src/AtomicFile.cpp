@@ -0,0 +1,58 @@
+#include "AtomicFile.h"
+#include "Hash.h"
+#include <atomic>
+#include <fstream>
+#include <random>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+std::filesystem::path uniqueTempPath(const std::filesystem::path& path)
+{
+    // The pid separates processes on one machine, the random salt processes on
+    // different machines sharing a directory, and the counter threads of one process
+    static const uint64_t salt = ((uint64_t)std::random_device{}() << 32) | std::random_device{}();
+    static std::atomic<uint64_t> counter{ 0 };
+#ifdef _WIN32
+    uint64_t pid = GetCurrentProcessId();
+#else
+    uint64_t pid = (uint64_t)::getpid();
+#endif
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp" + std::to_string(pid) + "-" + toHex(salt) + "-" +
+        std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+    return tempPath;
+}
+
+bool writeFileAtomically(const std::filesystem::path& path, std::initializer_list<std::span<const uint8_t>> parts)
+{
+    std::filesystem::path tempPath = uniqueTempPath(path);
+    std::error_code error;
+    {
+        std::ofstream stream(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        for (std::span<const uint8_t> part : parts)
+        {
+            stream.write(reinterpret_cast<const char*>(part.data()), (std::streamsize)part.size());
+        }
+        stream.flush();
+        if (!stream)
+        {
+            stream.close();
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
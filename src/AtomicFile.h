@@ -0,0 +1,17 @@
+#pragma once
+// AtomicFile.h
+// Whole-file writes that readers never see half done: the bytes go to a
+// temporary file next to the target, which is then renamed over it. Temporary
+// names are unique across threads and processes, so several writers (e.g. build
+// processes sharing a cache directory) can race on the same target safely.
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <span>
+
+// Sibling of path that no other thread or process will pick
+std::filesystem::path uniqueTempPath(const std::filesystem::path& path);
+
+// Writes the parts back to back and renames the result into place. Returns
+// false, leaving no temporary behind, if writing or renaming failed.
+bool writeFileAtomically(const std::filesystem::path& path, std::initializer_list<std::span<const uint8_t>> parts);
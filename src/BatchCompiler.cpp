@@ -0,0 +1,415 @@
+#include "BatchCompiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <set>
+#include <sstream>
+
+namespace
+{
+    std::vector<std::string> splitList(std::string_view text)
+    {
+        std::vector<std::string> items;
+        std::stringstream stream{ std::string(text) };
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            if (!item.empty())
+            {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    bool readFile(const std::filesystem::path& path, std::string& contents)
+    {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        if (!stream)
+        {
+            return false;
+        }
+        contents.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    void writeFile(const std::filesystem::path& path, const void* data, size_t size)
+    {
+        std::ofstream stream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.write(static_cast<const char*>(data), (std::streamsize)size))
+        {
+            throw std::runtime_error("Failed to write " + path.string());
+        }
+    }
+
+    const char* resourceTypeName(ShaderResourceBinding::ResourceType type)
+    {
+        using ResourceType = ShaderResourceBinding::ResourceType;
+        switch (type)
+        {
+        case ResourceType::ConstantBuffer: return "constantBuffer";
+        case ResourceType::StructuredBuffer: return "structuredBuffer";
+        case ResourceType::Texture: return "texture";
+        case ResourceType::Sampler: return "sampler";
+        case ResourceType::UAV: return "uav";
+        case ResourceType::TypedBuffer: return "typedBuffer";
+        case ResourceType::CombinedTextureSampler: return "combinedTextureSampler";
+        case ResourceType::AccelerationStructure: return "accelerationStructure";
+        case ResourceType::PushConstant: return "pushConstant";
+        }
+        return "unknown";
+    }
+
+    std::string jsonString(std::string_view text)
+    {
+        std::string quoted = "\"";
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                quoted += '\\';
+                quoted += c;
+            }
+            else if ((unsigned char)c < 0x20)
+            {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                quoted += buffer;
+            }
+            else
+            {
+                quoted += c;
+            }
+        }
+        return quoted + "\"";
+    }
+
+    // One object per target; every entry point of a target shares its table
+    std::string reflectionJson(const std::vector<ShaderOutput>& outputs, const std::vector<SlangCompileTarget>& targets)
+    {
+        std::ostringstream json;
+        json << "{\"targets\":[";
+        for (size_t t = 0; t < targets.size(); ++t)
+        {
+            const ReflectionTable* table = nullptr;
+            for (size_t i = t; i < outputs.size() && !table; i += targets.size())
+            {
+                table = outputs[i].reflection.get();
+            }
+            json << (t ? ",\n" : "\n") << "{\"target\":\"" << targetExtension(targets[t]) << "\"";
+            if (table)
+            {
+                json << ",\"bindings\":[";
+                for (size_t b = 0; b < table->bindings().size(); ++b)
+                {
+                    const ShaderResourceBinding& binding = table->bindings()[b];
+                    json << (b ? ",\n" : "\n") << "{\"name\":" << jsonString(binding.name)
+                        << ",\"type\":\"" << resourceTypeName(binding.resourceType) << "\""
+                        << ",\"binding\":" << binding.binding << ",\"set\":" << binding.set
+                        << ",\"count\":" << binding.count << ",\"sizeInBytes\":" << binding.sizeInBytes
+                        << ",\"stageMask\":" << binding.stageMask << "}";
+                }
+                json << "],\"vertexInputs\":[";
+                for (size_t v = 0; v < table->vertexInputs().size(); ++v)
+                {
+                    const VertexInputAttribute& attribute = table->vertexInputs()[v];
+                    json << (v ? ",\n" : "\n") << "{\"name\":" << jsonString(attribute.name)
+                        << ",\"semantic\":" << jsonString(attribute.semanticName)
+                        << ",\"semanticIndex\":" << attribute.semanticIndex << ",\"location\":" << attribute.location
+                        << ",\"scalarType\":" << attribute.scalarType << ",\"components\":" << attribute.componentCount << "}";
+                }
+                json << "],\"entryPoints\":[";
+                for (size_t e = 0; e < table->entryPoints().size(); ++e)
+                {
+                    const EntryPointInfo& entryPoint = table->entryPoints()[e];
+                    json << (e ? ",\n" : "\n") << "{\"name\":" << jsonString(entryPoint.name)
+                        << ",\"stage\":" << (int)entryPoint.stage << ",\"threadGroupSize\":["
+                        << entryPoint.threadGroupSize[0] << "," << entryPoint.threadGroupSize[1] << ","
+                        << entryPoint.threadGroupSize[2] << "]}";
+                }
+                json << "]";
+            }
+            json << "}";
+        }
+        json << "\n]}\n";
+        return json.str();
+    }
+
+    BatchItemResult compileEntry(SlangCompiler& compiler, const ManifestEntry& entry, const BatchOptions& options)
+    {
+        BatchItemResult result;
+        result.name = entry.name;
+
+        CompileJob job;
+        job.path = entry.source.string();
+        job.entryPoints = entry.entryPoints;
+        job.targets = entry.targets;
+        job.options = entry.options;
+        // One snapshot is hashed for the stamp and cache keys and compiled
+        try
+        {
+            job.sourceView = ShaderSource::readFile(entry.source, compiler.fileSystem().get());
+        }
+        catch (const std::exception&)
+        {
+            result.error = "Failed to open " + job.path;
+            return result;
+        }
+
+        std::filesystem::path base = options.outputDirectory / entry.name;
+        std::vector<std::filesystem::path> outputPaths;
+        for (const auto& entryPoint : entry.entryPoints)
+        {
+            for (SlangCompileTarget target : entry.targets)
+            {
+                // A whole-program module is written once, without an entry point in its name
+                std::filesystem::path outputPath = base;
+                if (!SlangCompiler::sharesTargetCode(entry.options, target))
+                {
+                    outputPath += "." + entryPoint;
+                }
+                outputPath += std::string(".") + targetExtension(target);
+                outputPaths.push_back(std::move(outputPath));
+            }
+        }
+        std::filesystem::path reflectionPath = base;
+        reflectionPath += ".reflection.json";
+        std::filesystem::path stampPath = base;
+        stampPath += ".stamp";
+
+        // The stamp covers the source, its imports, options and the Slang build;
+        // the imports are scanned once for both the stamp and the compile
+        std::vector<ImportedFile> imports = compiler.importClosure(job.sourceView.text, job.path, job.options);
+        std::string key = compiler.diskCacheKey(job.sourceView.text, job.entryPoints, job.targets, job.path, job.options, imports);
+        std::string stamp;
+        if (!options.force && readFile(stampPath, stamp) && stamp == key)
+        {
+            bool complete = std::filesystem::exists(reflectionPath);
+            for (const auto& outputPath : outputPaths)
+            {
+                complete = complete && std::filesystem::exists(outputPath);
+            }
+            if (complete)
+            {
+                result.status = BatchItemResult::Status::Skipped;
+                return result;
+            }
+        }
+
+        std::vector<ShaderOutput> outputs = compiler.compile(job, imports);
+        for (size_t i = 0; i < outputs.size(); ++i)
+        {
+            if (outputs[i].empty())
+            {
+                result.error = "No code generated for " + outputs[i].entryPointName + " (" + targetExtension(outputs[i].target) + ")";
+                return result;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::remove(stampPath, error);
+        for (size_t i = 0; i < outputs.size(); ++i)
+        {
+            if (std::find(outputPaths.begin(), outputPaths.begin() + i, outputPaths[i]) == outputPaths.begin() + i)
+            {
+                writeFile(outputPaths[i], outputs[i].bytes().data(), outputs[i].bytes().size());
+            }
+        }
+        std::string reflection = reflectionJson(outputs, entry.targets);
+        writeFile(reflectionPath, reflection.data(), reflection.size());
+        writeFile(stampPath, key.data(), key.size());
+
+        result.status = BatchItemResult::Status::Compiled;
+        return result;
+    }
+}
+
+bool parseTargetName(std::string_view name, SlangCompileTarget& target)
+{
+    static const std::pair<std::string_view, SlangCompileTarget> kTargets[] = {
+        { "spirv", SLANG_SPIRV }, { "glsl", SLANG_GLSL }, { "hlsl", SLANG_HLSL },
+        { "dxil", SLANG_DXIL }, { "metal", SLANG_METAL }, { "wgsl", SLANG_WGSL },
+    };
+    for (const auto& [targetName, value] : kTargets)
+    {
+        if (targetName == name)
+        {
+            target = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* targetExtension(SlangCompileTarget target)
+{
+    switch (target)
+    {
+    case SLANG_SPIRV: return "spv";
+    case SLANG_GLSL: return "glsl";
+    case SLANG_HLSL: return "hlsl";
+    case SLANG_DXIL: return "dxil";
+    case SLANG_METAL: return "metal";
+    case SLANG_WGSL: return "wgsl";
+    default: return "bin";
+    }
+}
+
+std::vector<ManifestEntry> parseManifest(std::istream& stream, const std::filesystem::path& baseDirectory)
+{
+    std::vector<ManifestEntry> entries;
+    std::set<std::string> names;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(stream, line); ++lineNumber)
+    {
+        line = line.substr(0, line.find('#'));
+        std::stringstream tokens(line);
+        std::string token;
+        if (!(tokens >> token))
+        {
+            continue;
+        }
+
+        auto fail = [&](const std::string& message)
+        {
+            throw std::runtime_error("Manifest line " + std::to_string(lineNumber) + ": " + message);
+        };
+
+        ManifestEntry entry;
+        entry.line = lineNumber;
+        entry.source = baseDirectory / token;
+        entry.name = entry.source.stem().string();
+        // Imports next to the shader resolve without extra include= lines
+        entry.options.searchPaths.insert(entry.options.searchPaths.begin(), entry.source.parent_path().string());
+
+        while (tokens >> token)
+        {
+            size_t equals = token.find('=');
+            if (equals == std::string::npos)
+            {
+                fail("expected key=value, got '" + token + "'");
+            }
+            std::string key = token.substr(0, equals);
+            std::string value = token.substr(equals + 1);
+            if (key == "entry")
+            {
+                std::vector<std::string> entryPoints = splitList(value);
+                entry.entryPoints.insert(entry.entryPoints.end(), entryPoints.begin(), entryPoints.end());
+            }
+            else if (key == "target")
+            {
+                for (const auto& name : splitList(value))
+                {
+                    SlangCompileTarget target;
+                    if (!parseTargetName(name, target))
+                    {
+                        fail("unknown target '" + name + "'");
+                    }
+                    entry.targets.push_back(target);
+                }
+            }
+            else if (key == "define")
+            {
+                size_t valueStart = value.find('=');
+                if (valueStart == std::string::npos)
+                {
+                    entry.options.macros.push_back({ value, "1" });
+                }
+                else
+                {
+                    entry.options.macros.push_back({ value.substr(0, valueStart), value.substr(valueStart + 1) });
+                }
+            }
+            else if (key == "profile")
+            {
+                entry.options.profile = value;
+            }
+            else if (key == "include")
+            {
+                entry.options.searchPaths.push_back((baseDirectory / value).string());
+            }
+            else if (key == "name")
+            {
+                entry.name = value;
+            }
+            else if (key == "spirv")
+            {
+                if (value != "module" && value != "entry")
+                {
+                    fail("spirv= expects module or entry, got '" + value + "'");
+                }
+                entry.options.wholeProgram = value == "module";
+            }
+            else
+            {
+                fail("unknown key '" + key + "'");
+            }
+        }
+
+        if (entry.entryPoints.empty())
+        {
+            fail("no entry points");
+        }
+        if (entry.targets.empty())
+        {
+            entry.targets.push_back(SLANG_SPIRV);
+        }
+        if (!names.insert(entry.name).second)
+        {
+            fail("output name '" + entry.name + "' is used twice; set name=");
+        }
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+std::vector<ManifestEntry> readManifest(const std::filesystem::path& path)
+{
+    std::ifstream stream(path);
+    if (!stream)
+    {
+        throw std::runtime_error("Failed to open manifest: " + path.string());
+    }
+    return parseManifest(stream, path.parent_path());
+}
+
+BatchReport runBatch(CompilerPool& pool, const std::vector<ManifestEntry>& entries, const BatchOptions& options)
+{
+    std::error_code error;
+    std::filesystem::create_directories(options.outputDirectory, error);
+
+    BatchReport report;
+    report.items.resize(entries.size());
+    std::vector<std::future<void>> pending;
+    pending.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        pending.push_back(pool.run([&entries, &options, &report, i](SlangCompiler& compiler)
+        {
+            report.items[i] = compileEntry(compiler, entries[i], options);
+        }));
+    }
+
+    for (size_t i = 0; i < pending.size(); ++i)
+    {
+        try
+        {
+            pending[i].get();
+        }
+        catch (const std::exception& e)
+        {
+            report.items[i].name = entries[i].name;
+            report.items[i].status = BatchItemResult::Status::Failed;
+            report.items[i].error = e.what();
+        }
+
+        switch (report.items[i].status)
+        {
+        case BatchItemResult::Status::Compiled: ++report.compiled; break;
+        case BatchItemResult::Status::Skipped: ++report.skipped; break;
+        case BatchItemResult::Status::Failed: ++report.failed; break;
+        }
+    }
+    return report;
+}
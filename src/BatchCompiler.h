@@ -0,0 +1,64 @@
+#pragma once
+// BatchCompiler.h
+// Manifest-driven batch compiles for build systems: one process compiles every
+// shader on a CompilerPool, writes code and reflection to an output directory,
+// and skips shaders whose inputs have not changed since the last run.
+//
+// Manifest format, one shader per line, '#' starts a comment:
+//   shaders/lit.slang entry=vertexMain,fragmentMain target=spirv,hlsl define=FOG=1 define=SHADOWS
+// Optional keys: profile=<name>, include=<dir> (repeatable), name=<output name>,
+// spirv=module (one SPIR-V module with every entry point, written as <name>.spv) or spirv=entry (default).
+// Paths are relative to the manifest and may not contain spaces.
+#include "CompilerPool.h"
+#include <filesystem>
+#include <istream>
+#include <string>
+#include <vector>
+
+struct ManifestEntry
+{
+    std::filesystem::path source;
+    std::vector<std::string> entryPoints;
+    std::vector<SlangCompileTarget> targets;
+    CompileOptions options;
+    std::string name; // Output file prefix, defaults to the source stem
+    size_t line = 0;
+};
+
+// Throws std::runtime_error naming the line of the first malformed entry
+std::vector<ManifestEntry> parseManifest(std::istream& stream, const std::filesystem::path& baseDirectory);
+std::vector<ManifestEntry> readManifest(const std::filesystem::path& path);
+
+// Target names used in manifests and as output file extensions
+bool parseTargetName(std::string_view name, SlangCompileTarget& target);
+const char* targetExtension(SlangCompileTarget target);
+
+struct BatchOptions
+{
+    std::filesystem::path outputDirectory = "shader_out";
+    bool force = false; // Rebuild even if the stamp matches
+};
+
+struct BatchItemResult
+{
+    enum class Status { Compiled, Skipped, Failed };
+
+    std::string name;
+    Status status = Status::Failed;
+    std::string error;
+};
+
+struct BatchReport
+{
+    std::vector<BatchItemResult> items; // In manifest order
+    size_t compiled = 0;
+    size_t skipped = 0;
+    size_t failed = 0;
+
+    bool succeeded() const { return failed == 0; }
+};
+
+// Writes <name>.<entry>.<ext> per entry point and target, <name>.reflection.json and
+// a <name>.stamp holding the inputs' hash, which is written last so an interrupted
+// build is redone. Failures are reported per item and never stop the batch.
+BatchReport runBatch(CompilerPool& pool, const std::vector<ManifestEntry>& entries, const BatchOptions& options);
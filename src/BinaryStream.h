@@ -0,0 +1,100 @@
+#pragma once
+// BinaryStream.h
+// Minimal helpers for the compact binary formats (cache records,
+// pipeline layouts). Values are written in host byte order; readers bounds
+// check every access and report truncation by returning false.
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+class BinaryWriter
+{
+public:
+    explicit BinaryWriter(std::vector<uint8_t>& buffer) : m_buffer(buffer) {}
+
+    template <typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(&value, sizeof(T));
+    }
+
+    void write(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+    }
+
+    // u32 length followed by the bytes
+    void writeString(std::string_view text)
+    {
+        write((uint32_t)text.size());
+        write(text.data(), text.size());
+    }
+
+    void align(size_t alignment) { m_buffer.resize(alignUp(m_buffer.size(), alignment), 0); }
+
+    size_t size() const { return m_buffer.size(); }
+
+    static size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+private:
+    std::vector<uint8_t>& m_buffer;
+};
+
+class BinaryReader
+{
+public:
+    explicit BinaryReader(std::span<const uint8_t> data) : m_data(data) {}
+
+    template <typename T>
+    bool read(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const uint8_t* bytes = take(sizeof(T));
+        if (!bytes) return false;
+        std::memcpy(&value, bytes, sizeof(T));
+        return true;
+    }
+
+    // Returns nullptr if fewer than size bytes remain
+    const uint8_t* take(size_t size)
+    {
+        if (size > m_data.size() - m_offset) return nullptr;
+        const uint8_t* bytes = m_data.data() + m_offset;
+        m_offset += size;
+        return bytes;
+    }
+
+    // The view points into the underlying data
+    bool readString(std::string_view& text)
+    {
+        uint32_t size = 0;
+        if (!read(size)) return false;
+        const uint8_t* bytes = take(size);
+        if (!bytes && size > 0) return false;
+        text = std::string_view(reinterpret_cast<const char*>(bytes), size);
+        return true;
+    }
+
+    bool align(size_t alignment)
+    {
+        size_t aligned = BinaryWriter::alignUp(m_offset, alignment);
+        if (aligned > m_data.size()) return false;
+        m_offset = aligned;
+        return true;
+    }
+
+    size_t offset() const { return m_offset; }
+    size_t remaining() const { return m_data.size() - m_offset; }
+
+private:
+    std::span<const uint8_t> m_data;
+    size_t m_offset = 0;
+};
@@ -0,0 +1,493 @@
+#include "CompileDaemon.h"
+#include "BinaryStream.h"
+#include "ShaderRecord.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr uint64_t kMaxPayloadSize = uint64_t(1) << 30;
+
+    std::string toString(std::string_view text)
+    {
+        return std::string(text);
+    }
+
+    void writeStrings(BinaryWriter& writer, const std::vector<std::string>& strings)
+    {
+        writer.write((uint32_t)strings.size());
+        for (const auto& text : strings)
+        {
+            writer.writeString(text);
+        }
+    }
+
+    bool readStrings(BinaryReader& reader, std::vector<std::string>& strings)
+    {
+        uint32_t count = 0;
+        if (!reader.read(count)) return false;
+        strings.clear();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            std::string_view text;
+            if (!reader.readString(text)) return false;
+            strings.push_back(toString(text));
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> writeCompileJob(const CompileJob& job)
+    {
+        std::vector<uint8_t> payload;
+        BinaryWriter writer(payload);
+        writer.writeString(job.path);
+        writer.writeString(job.sourceText().text);
+        writeStrings(writer, job.entryPoints);
+        writer.write((uint32_t)job.targets.size());
+        for (SlangCompileTarget target : job.targets)
+        {
+            writer.write((uint32_t)target);
+        }
+        writer.writeString(job.options.profile);
+        writeStrings(writer, job.options.searchPaths);
+        writer.write((uint32_t)job.options.macros.size());
+        for (const auto& macro : job.options.macros)
+        {
+            writer.writeString(macro.name);
+            writer.writeString(macro.value);
+        }
+        writer.write((uint8_t)job.options.wholeProgram);
+        return payload;
+    }
+
+    bool readCompileJob(std::span<const uint8_t> payload, CompileJob& job)
+    {
+        BinaryReader reader(payload);
+        std::string_view path, source, profile;
+        uint32_t targetCount = 0, macroCount = 0;
+        if (!reader.readString(path) || !reader.readString(source) ||
+            !readStrings(reader, job.entryPoints) || !reader.read(targetCount))
+        {
+            return false;
+        }
+        job.path = toString(path);
+        job.source = toString(source);
+        for (uint32_t i = 0; i < targetCount; ++i)
+        {
+            uint32_t target = 0;
+            if (!reader.read(target)) return false;
+            job.targets.push_back(static_cast<SlangCompileTarget>(target));
+        }
+        if (!reader.readString(profile) || !readStrings(reader, job.options.searchPaths) || !reader.read(macroCount))
+        {
+            return false;
+        }
+        job.options.profile = toString(profile);
+        job.options.macros.clear();
+        for (uint32_t i = 0; i < macroCount; ++i)
+        {
+            std::string_view name, value;
+            if (!reader.readString(name) || !reader.readString(value)) return false;
+            job.options.macros.push_back({ toString(name), toString(value) });
+        }
+        uint8_t wholeProgram = 0;
+        if (!reader.read(wholeProgram)) return false;
+        job.options.wholeProgram = wholeProgram != 0;
+        return reader.remaining() == 0;
+    }
+
+    std::vector<uint8_t> writeBatchReport(const BatchReport& report)
+    {
+        std::vector<uint8_t> payload;
+        BinaryWriter writer(payload);
+        writer.write((uint32_t)report.items.size());
+        for (const auto& item : report.items)
+        {
+            writer.writeString(item.name);
+            writer.write((uint32_t)item.status);
+            writer.writeString(item.error);
+        }
+        return payload;
+    }
+
+    bool readBatchReport(std::span<const uint8_t> payload, BatchReport& report)
+    {
+        BinaryReader reader(payload);
+        uint32_t count = 0;
+        if (!reader.read(count)) return false;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            BatchItemResult item;
+            std::string_view name, error;
+            uint32_t status = 0;
+            if (!reader.readString(name) || !reader.read(status) || !reader.readString(error) ||
+                status > (uint32_t)BatchItemResult::Status::Failed)
+            {
+                return false;
+            }
+            item.name = toString(name);
+            item.status = static_cast<BatchItemResult::Status>(status);
+            item.error = toString(error);
+            switch (item.status)
+            {
+            case BatchItemResult::Status::Compiled: ++report.compiled; break;
+            case BatchItemResult::Status::Skipped: ++report.skipped; break;
+            case BatchItemResult::Status::Failed: ++report.failed; break;
+            }
+            report.items.push_back(std::move(item));
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> textPayload(std::string_view text)
+    {
+        return std::vector<uint8_t>(text.begin(), text.end());
+    }
+
+#ifndef _WIN32
+    sockaddr_un socketAddress(const std::filesystem::path& path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::string text = path.string();
+        if (text.size() >= sizeof(address.sun_path))
+        {
+            throw std::runtime_error("Socket path is too long: " + text);
+        }
+        std::copy(text.begin(), text.end(), address.sun_path);
+        return address;
+    }
+
+    bool sendAll(int socket, const void* data, size_t size)
+    {
+#ifdef MSG_NOSIGNAL
+        constexpr int kFlags = MSG_NOSIGNAL; // A vanished peer must not kill the process
+#else
+        constexpr int kFlags = 0;
+#endif
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0)
+        {
+            ssize_t sent = ::send(socket, bytes, size, kFlags);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return false;
+            bytes += sent;
+            size -= (size_t)sent;
+        }
+        return true;
+    }
+
+    bool receiveAll(int socket, void* data, size_t size)
+    {
+        uint8_t* bytes = static_cast<uint8_t*>(data);
+        while (size > 0)
+        {
+            ssize_t received = ::recv(socket, bytes, size, 0);
+            if (received < 0 && errno == EINTR) continue;
+            if (received <= 0) return false;
+            bytes += received;
+            size -= (size_t)received;
+        }
+        return true;
+    }
+
+    bool sendFrame(int socket, DaemonMessage message, const std::vector<uint8_t>& payload)
+    {
+        DaemonFrame frame{ kDaemonMagic, kDaemonProtocolVersion, (uint32_t)message, 0, payload.size() };
+        return sendAll(socket, &frame, sizeof(frame)) && sendAll(socket, payload.data(), payload.size());
+    }
+
+    // False on disconnect or a malformed frame
+    bool receiveFrame(int socket, DaemonMessage& message, std::vector<uint8_t>& payload)
+    {
+        DaemonFrame frame{};
+        if (!receiveAll(socket, &frame, sizeof(frame)) || frame.magic != kDaemonMagic ||
+            frame.version != kDaemonProtocolVersion || frame.payloadSize > kMaxPayloadSize)
+        {
+            return false;
+        }
+        message = static_cast<DaemonMessage>(frame.message);
+        payload.resize((size_t)frame.payloadSize);
+        return receiveAll(socket, payload.data(), payload.size());
+    }
+#endif
+}
+
+#ifdef _WIN32
+
+CompileDaemon::CompileDaemon(CompilerPool& pool, std::filesystem::path socketPath)
+    : m_pool(pool), m_socketPath(std::move(socketPath))
+{
+    throw std::runtime_error("The compile daemon is not supported on Windows");
+}
+CompileDaemon::~CompileDaemon() = default;
+void CompileDaemon::serve() {}
+void CompileDaemon::serveConnection(int) {}
+void CompileDaemon::reapConnections(bool) {}
+
+CompileClient::CompileClient(const std::filesystem::path&)
+{
+    throw std::runtime_error("The compile daemon is not supported on Windows");
+}
+CompileClient::~CompileClient() = default;
+DaemonMessage CompileClient::request(DaemonMessage, const std::vector<uint8_t>&, std::vector<uint8_t>&)
+{
+    return DaemonMessage::Failed;
+}
+
+#else
+
+// ----- CompileDaemon -----
+
+CompileDaemon::CompileDaemon(CompilerPool& pool, std::filesystem::path socketPath)
+    : m_pool(pool), m_socketPath(std::move(socketPath))
+{
+    sockaddr_un address = socketAddress(m_socketPath);
+
+    // A socket file nobody answers on is left over from a daemon that died
+    if (std::filesystem::exists(m_socketPath))
+    {
+        int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        bool live = probe >= 0 && ::connect(probe, (const sockaddr*)&address, sizeof(address)) == 0;
+        if (probe >= 0) ::close(probe);
+        if (live)
+        {
+            throw std::runtime_error("A compile daemon is already listening on " + m_socketPath.string());
+        }
+        std::error_code error;
+        std::filesystem::remove(m_socketPath, error);
+    }
+
+    m_listenSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listenSocket < 0 ||
+        ::bind(m_listenSocket, (const sockaddr*)&address, sizeof(address)) != 0 ||
+        ::listen(m_listenSocket, 64) != 0)
+    {
+        if (m_listenSocket >= 0) ::close(m_listenSocket);
+        throw std::runtime_error("Failed to listen on " + m_socketPath.string());
+    }
+}
+
+CompileDaemon::~CompileDaemon()
+{
+    stop();
+    reapConnections(true);
+    ::close(m_listenSocket);
+    std::error_code error;
+    std::filesystem::remove(m_socketPath, error);
+}
+
+void CompileDaemon::serve()
+{
+    while (!m_stopping.load(std::memory_order_relaxed))
+    {
+        // Wake up regularly to notice stop()
+        pollfd listening{ m_listenSocket, POLLIN, 0 };
+        int ready = ::poll(&listening, 1, 100);
+        reapConnections(false);
+        if (ready <= 0)
+        {
+            continue;
+        }
+
+        int socket = ::accept(m_listenSocket, nullptr, nullptr);
+        if (socket < 0)
+        {
+            continue;
+        }
+        auto finished = std::make_shared<std::atomic<bool>>(false);
+        std::thread thread([this, socket, finished]
+        {
+            serveConnection(socket);
+            finished->store(true, std::memory_order_release);
+        });
+        m_connections.push_back({ socket, std::move(thread), std::move(finished) });
+    }
+    reapConnections(true);
+}
+
+void CompileDaemon::reapConnections(bool all)
+{
+    for (auto it = m_connections.begin(); it != m_connections.end();)
+    {
+        if (all || it->finished->load(std::memory_order_acquire))
+        {
+            // Unblocks a handler waiting for the client's next request
+            ::shutdown(it->socket, SHUT_RDWR);
+            it->thread.join();
+            ::close(it->socket);
+            it = m_connections.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void CompileDaemon::serveConnection(int socket)
+{
+    DaemonMessage message;
+    std::vector<uint8_t> payload;
+    while (!m_stopping.load(std::memory_order_relaxed) && receiveFrame(socket, message, payload))
+    {
+        m_requests.fetch_add(1, std::memory_order_relaxed);
+        DaemonMessage replyMessage = DaemonMessage::Ok;
+        std::vector<uint8_t> reply;
+        switch (message)
+        {
+        case DaemonMessage::Compile:
+        {
+            CompileJob job;
+            if (!readCompileJob(payload, job))
+            {
+                replyMessage = DaemonMessage::Failed;
+                reply = textPayload("Malformed compile request");
+                break;
+            }
+            CompileHandle handle = m_pool.compileAsync(std::move(job));
+            const CompileResult& result = handle.get();
+            if (result.succeeded())
+            {
+                reply = writeShaderRecord(result.outputs);
+            }
+            else
+            {
+                replyMessage = result.cancelled ? DaemonMessage::Cancelled : DaemonMessage::Failed;
+                reply = textPayload(result.error);
+            }
+            break;
+        }
+        case DaemonMessage::Batch:
+        {
+            BinaryReader reader(payload);
+            std::string_view manifestPath, outputDirectory;
+            uint8_t force = 0;
+            if (!reader.readString(manifestPath) || !reader.readString(outputDirectory) || !reader.read(force))
+            {
+                replyMessage = DaemonMessage::Failed;
+                reply = textPayload("Malformed batch request");
+                break;
+            }
+            try
+            {
+                BatchOptions options;
+                options.outputDirectory = outputDirectory;
+                options.force = force != 0;
+                reply = writeBatchReport(runBatch(m_pool, readManifest(manifestPath), options));
+            }
+            catch (const std::exception& e)
+            {
+                replyMessage = DaemonMessage::Failed;
+                reply = textPayload(e.what());
+            }
+            break;
+        }
+        case DaemonMessage::Shutdown:
+            stop();
+            break;
+        default:
+            replyMessage = DaemonMessage::Failed;
+            reply = textPayload("Unknown request");
+            break;
+        }
+
+        if (!sendFrame(socket, replyMessage, reply))
+        {
+            break;
+        }
+    }
+}
+
+// ----- CompileClient -----
+
+CompileClient::CompileClient(const std::filesystem::path& socketPath)
+{
+    sockaddr_un address = socketAddress(socketPath);
+    m_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket < 0 || ::connect(m_socket, (const sockaddr*)&address, sizeof(address)) != 0)
+    {
+        if (m_socket >= 0) ::close(m_socket);
+        throw std::runtime_error("No compile daemon is listening on " + socketPath.string());
+    }
+}
+
+CompileClient::~CompileClient()
+{
+    ::close(m_socket);
+}
+
+DaemonMessage CompileClient::request(DaemonMessage message, const std::vector<uint8_t>& payload,
+    std::vector<uint8_t>& reply)
+{
+    DaemonMessage replyMessage;
+    if (!sendFrame(m_socket, message, payload) || !receiveFrame(m_socket, replyMessage, reply))
+    {
+        throw std::runtime_error("Lost connection to the compile daemon");
+    }
+    return replyMessage;
+}
+
+#endif
+
+CompileResult CompileClient::compile(const CompileJob& job)
+{
+    // The daemon has its own working directory
+    CompileJob resolved = job;
+    if (!resolved.path.empty())
+    {
+        resolved.path = std::filesystem::absolute(resolved.path).string();
+    }
+    for (auto& searchPath : resolved.options.searchPaths)
+    {
+        searchPath = std::filesystem::absolute(searchPath).string();
+    }
+
+    CompileResult result;
+    auto reply = std::make_shared<std::vector<uint8_t>>();
+    DaemonMessage message = request(DaemonMessage::Compile, writeCompileJob(resolved), *reply);
+    if (message != DaemonMessage::Ok)
+    {
+        result.cancelled = message == DaemonMessage::Cancelled;
+        result.error.assign(reply->begin(), reply->end());
+    }
+    else if (!readShaderRecord(*reply, reply, result.outputs))
+    {
+        result.error = "Malformed reply from the compile daemon";
+    }
+    return result;
+}
+
+BatchReport CompileClient::runBatch(const std::filesystem::path& manifestPath, const BatchOptions& options)
+{
+    std::vector<uint8_t> payload;
+    BinaryWriter writer(payload);
+    writer.writeString(std::filesystem::absolute(manifestPath).string());
+    writer.writeString(std::filesystem::absolute(options.outputDirectory).string());
+    writer.write((uint8_t)options.force);
+
+    std::vector<uint8_t> reply;
+    DaemonMessage message = request(DaemonMessage::Batch, payload, reply);
+    if (message != DaemonMessage::Ok)
+    {
+        throw std::runtime_error(std::string(reply.begin(), reply.end()));
+    }
+    BatchReport report;
+    if (!readBatchReport(reply, report))
+    {
+        throw std::runtime_error("Malformed reply from the compile daemon");
+    }
+    return report;
+}
+
+void CompileClient::shutdownDaemon()
+{
+    std::vector<uint8_t> reply;
+    request(DaemonMessage::Shutdown, {}, reply);
+}
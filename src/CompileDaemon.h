@@ -0,0 +1,109 @@
+#pragma once
+// CompileDaemon.h
+// Keeps a CompilerPool (warm global sessions, session pools and caches)
+// resident and serves compile requests over a local Unix domain socket, so
+// repeated tool invocations skip global session startup. CompileClient is the
+// thin side used by the CLI. Cached results and warm sessions are checked against
+// the current contents of every imported file on each request, so edits made
+// between builds are picked up without restarting the daemon. The pool's file
+// system (e.g. -root) should trust negative lookups only briefly (see
+// VirtualFileSystem::setNegativeLookupLifetime), or files created after an
+// import was first found missing stay missing for the daemon's lifetime.
+//
+// Protocol: every message is a DaemonFrame followed by payloadSize bytes.
+// Compile requests carry a serialized CompileJob and are answered with a
+// ShaderRecord (see ShaderRecord.h); batch requests name a manifest and are
+// answered with the per-shader report. Failures answer with the error text.
+// Not available on Windows.
+#include "BatchCompiler.h"
+#include "CompilerPool.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+constexpr uint32_t kDaemonMagic = 0x44435353; // "SSCD"
+constexpr uint32_t kDaemonProtocolVersion = 2;
+
+enum class DaemonMessage : uint32_t
+{
+    Compile = 1,  // CompileJob -> ShaderRecord
+    Batch = 2,    // Manifest path and BatchOptions -> BatchReport
+    Shutdown = 3, // Empty -> empty; the daemon stops after replying
+    // Replies
+    Ok = 100,
+    Failed = 101,
+    Cancelled = 102,
+};
+
+struct DaemonFrame
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t message; // DaemonMessage
+    uint32_t reserved;
+    uint64_t payloadSize;
+};
+
+class CompileDaemon
+{
+public:
+    // Binds and listens on socketPath, replacing a stale socket file. Throws
+    // std::runtime_error if another daemon is already serving that path.
+    CompileDaemon(CompilerPool& pool, std::filesystem::path socketPath);
+    ~CompileDaemon();
+
+    CompileDaemon(const CompileDaemon&) = delete;
+    CompileDaemon& operator=(const CompileDaemon&) = delete;
+
+    // Accepts connections until stop() or a Shutdown request; each connection
+    // is served on its own thread and may send any number of requests
+    void serve();
+    // Safe from any thread, including a request handler
+    void stop() { m_stopping.store(true, std::memory_order_relaxed); }
+
+    const std::filesystem::path& socketPath() const { return m_socketPath; }
+    uint64_t requestsServed() const { return m_requests.load(std::memory_order_relaxed); }
+
+private:
+    CompilerPool& m_pool;
+    std::filesystem::path m_socketPath;
+    int m_listenSocket = -1;
+    std::atomic<bool> m_stopping{ false };
+    std::atomic<uint64_t> m_requests{ 0 };
+    struct Connection
+    {
+        int socket;
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> finished;
+    };
+    std::vector<Connection> m_connections; // Only touched by serve()
+
+    void serveConnection(int socket);
+    void reapConnections(bool all);
+};
+
+class CompileClient
+{
+public:
+    // Throws std::runtime_error if no daemon is listening on socketPath
+    explicit CompileClient(const std::filesystem::path& socketPath);
+    ~CompileClient();
+
+    CompileClient(const CompileClient&) = delete;
+    CompileClient& operator=(const CompileClient&) = delete;
+
+    // Relative paths in the job are resolved against this process's working
+    // directory before sending. Failures are reported in the result.
+    CompileResult compile(const CompileJob& job);
+    // Runs a manifest on the daemon's pool; throws if the manifest cannot be read
+    BatchReport runBatch(const std::filesystem::path& manifestPath, const BatchOptions& options);
+    void shutdownDaemon();
+
+private:
+    int m_socket = -1;
+
+    DaemonMessage request(DaemonMessage message, const std::vector<uint8_t>& payload, std::vector<uint8_t>& reply);
+};
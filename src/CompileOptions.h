@@ -0,0 +1,21 @@
+#pragma once
+// CompileOptions.h
+// Per-compile settings shared by SlangCompiler and the session pool.
+#include <string>
+#include <vector>
+
+struct ShaderMacro
+{
+    std::string name;
+    std::string value;
+};
+
+struct CompileOptions
+{
+    std::string profile = "sm_6_0";
+    std::vector<std::string> searchPaths = { "./", "../shaders/", "../../shaders/" };
+    std::vector<ShaderMacro> macros;
+    // SPIR-V targets get one module holding every entry point, shared by their
+    // outputs, instead of a module per entry point. Stages select by name.
+    bool wholeProgram = false;
+};
@@ -0,0 +1,290 @@
+#include "CompileTrace.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+    std::mutex g_sinkMutex;
+    std::shared_ptr<TraceSink> g_sink;
+
+    std::shared_ptr<TraceSink> currentSink()
+    {
+        std::lock_guard<std::mutex> lock(g_sinkMutex);
+        return g_sink;
+    }
+
+    void writeJsonString(std::ostream& stream, std::string_view text)
+    {
+        stream << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                stream << '\\' << c;
+            }
+            else if ((unsigned char)c < 0x20)
+            {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                stream << buffer;
+            }
+            else
+            {
+                stream << c;
+            }
+        }
+        stream << '"';
+    }
+}
+
+std::atomic<bool> CompileTrace::s_enabled{ false };
+
+void CompileTrace::setSink(std::shared_ptr<TraceSink> sink)
+{
+    std::lock_guard<std::mutex> lock(g_sinkMutex);
+    g_sink = std::move(sink);
+    s_enabled.store(g_sink != nullptr, std::memory_order_relaxed);
+}
+
+std::shared_ptr<TraceSink> CompileTrace::sink()
+{
+    return currentSink();
+}
+
+uint64_t CompileTrace::nowUs()
+{
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - epoch).count();
+}
+
+uint32_t CompileTrace::threadId()
+{
+    static std::atomic<uint32_t> nextId{ 1 };
+    thread_local uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void CompileTrace::emitCounter(const char* name, int64_t value)
+{
+    if (std::shared_ptr<TraceSink> sink = currentSink())
+    {
+        sink->counter(name, value, nowUs(), threadId());
+    }
+}
+
+void ScopedTrace::finish()
+{
+    m_event->durationUs = CompileTrace::nowUs() - m_event->startUs;
+    m_event->threadId = CompileTrace::threadId();
+    if (std::shared_ptr<TraceSink> sink = currentSink())
+    {
+        sink->record(*m_event);
+    }
+}
+
+// ----- ChromeTraceSink -----
+
+void ChromeTraceSink::record(const TraceEvent& event)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.push_back(event);
+}
+
+void ChromeTraceSink::counter(const char* name, int64_t value, uint64_t timestampUs, uint32_t threadId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int64_t total = m_counterTotals[name] += value;
+    m_counters.push_back({ name, total, timestampUs, threadId });
+}
+
+void ChromeTraceSink::write(std::ostream& stream) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const TraceEvent& event : m_events)
+    {
+        stream << (first ? "\n" : ",\n");
+        first = false;
+        stream << "{\"name\":";
+        writeJsonString(stream, event.name);
+        stream << ",\"cat\":";
+        writeJsonString(stream, event.category);
+        stream << ",\"ph\":\"X\",\"ts\":" << event.startUs << ",\"dur\":" << event.durationUs
+            << ",\"pid\":1,\"tid\":" << event.threadId << ",\"args\":{";
+        bool firstArg = true;
+        if (!event.detail.empty())
+        {
+            stream << "\"detail\":";
+            writeJsonString(stream, event.detail);
+            firstArg = false;
+        }
+        for (size_t i = 0; i < event.argCount; ++i)
+        {
+            stream << (firstArg ? "" : ",");
+            firstArg = false;
+            writeJsonString(stream, event.args[i].key);
+            stream << ':' << event.args[i].value;
+        }
+        stream << "}}";
+    }
+    for (const CounterSample& sample : m_counters)
+    {
+        stream << (first ? "\n" : ",\n");
+        first = false;
+        stream << "{\"name\":";
+        writeJsonString(stream, sample.name);
+        stream << ",\"ph\":\"C\",\"ts\":" << sample.timestampUs << ",\"pid\":1,\"tid\":" << sample.threadId
+            << ",\"args\":{\"value\":" << sample.total << "}}";
+    }
+    stream << "\n]}\n";
+}
+
+bool ChromeTraceSink::writeFile(const std::string& path) const
+{
+    std::ofstream stream(path, std::ios::out | std::ios::trunc);
+    if (!stream)
+    {
+        return false;
+    }
+    write(stream);
+    return (bool)stream;
+}
+
+size_t ChromeTraceSink::eventCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_events.size() + m_counters.size();
+}
+
+void ChromeTraceSink::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.clear();
+    m_counters.clear();
+    m_counterTotals.clear();
+}
+
+// ----- HistogramSink -----
+
+uint64_t HistogramSink::Histogram::percentileUs(double fraction) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    uint64_t target = std::max<uint64_t>(1, (uint64_t)(fraction * count + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= target)
+        {
+            return std::min<uint64_t>(maxUs, (1ull << i) - 1);
+        }
+    }
+    return maxUs;
+}
+
+void HistogramSink::record(const TraceEvent& event)
+{
+    size_t bucket = std::min<size_t>(Histogram::kBuckets - 1, (size_t)std::bit_width(event.durationUs));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_histograms.find(std::string_view(event.name));
+    if (found == m_histograms.end())
+    {
+        found = m_histograms.emplace(event.name, Histogram{}).first;
+    }
+    Histogram& histogram = found->second;
+    ++histogram.count;
+    histogram.totalUs += event.durationUs;
+    histogram.minUs = std::min(histogram.minUs, event.durationUs);
+    histogram.maxUs = std::max(histogram.maxUs, event.durationUs);
+    ++histogram.buckets[bucket];
+}
+
+void HistogramSink::counter(const char* name, int64_t value, uint64_t, uint32_t)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_counters.find(std::string_view(name));
+    if (found == m_counters.end())
+    {
+        found = m_counters.emplace(name, 0).first;
+    }
+    found->second += value;
+}
+
+std::map<std::string, HistogramSink::Histogram> HistogramSink::histograms() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return { m_histograms.begin(), m_histograms.end() };
+}
+
+std::map<std::string, int64_t> HistogramSink::counters() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return { m_counters.begin(), m_counters.end() };
+}
+
+void HistogramSink::writeJson(std::ostream& stream) const
+{
+    std::map<std::string, Histogram> histograms = this->histograms();
+    std::map<std::string, int64_t> counters = this->counters();
+
+    stream << "{\"phases\":{";
+    bool first = true;
+    for (const auto& [name, histogram] : histograms)
+    {
+        stream << (first ? "\n" : ",\n");
+        first = false;
+        writeJsonString(stream, name);
+        stream << ":{\"count\":" << histogram.count << ",\"totalUs\":" << histogram.totalUs
+            << ",\"minUs\":" << histogram.minUs << ",\"maxUs\":" << histogram.maxUs
+            << ",\"p50Us\":" << histogram.percentileUs(0.5) << ",\"p90Us\":" << histogram.percentileUs(0.9)
+            << ",\"p99Us\":" << histogram.percentileUs(0.99) << ",\"log2Buckets\":[";
+        for (size_t i = 0; i < Histogram::kBuckets; ++i)
+        {
+            stream << (i ? "," : "") << histogram.buckets[i];
+        }
+        stream << "]}";
+    }
+    stream << "},\"counters\":{";
+    first = true;
+    for (const auto& [name, value] : counters)
+    {
+        stream << (first ? "\n" : ",\n");
+        first = false;
+        writeJsonString(stream, name);
+        stream << ':' << value;
+    }
+    stream << "}}\n";
+}
+
+void HistogramSink::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_histograms.clear();
+    m_counters.clear();
+}
+
+// ----- TeeTraceSink -----
+
+void TeeTraceSink::record(const TraceEvent& event)
+{
+    for (const auto& sink : m_sinks)
+    {
+        sink->record(event);
+    }
+}
+
+void TeeTraceSink::counter(const char* name, int64_t value, uint64_t timestampUs, uint32_t threadId)
+{
+    for (const auto& sink : m_sinks)
+    {
+        sink->counter(name, value, timestampUs, threadId);
+    }
+}
@@ -0,0 +1,203 @@
+#pragma once
+// CompileTrace.h
+// Scoped timers and counters for the compile pipeline. Events go to a
+// process-wide pluggable sink; ChromeTraceSink writes trace-event JSON for
+// chrome://tracing or Perfetto, HistogramSink aggregates per-phase timings.
+// With no sink installed a ScopedTrace is one relaxed atomic load; its event,
+// string included, is only constructed while tracing is on.
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct TraceArg
+{
+    const char* key = nullptr; // String literal
+    int64_t value = 0;
+};
+
+struct TraceEvent
+{
+    static constexpr size_t kMaxArgs = 6;
+
+    const char* name = nullptr;     // String literal
+    const char* category = nullptr; // String literal
+    std::string detail;             // e.g. entry point name; may be empty
+    uint64_t startUs = 0;           // Since the first trace call in the process
+    uint64_t durationUs = 0;
+    uint32_t threadId = 0;          // Small per-thread index, stable for the process
+    std::array<TraceArg, kMaxArgs> args{};
+    size_t argCount = 0;
+};
+
+class TraceSink
+{
+public:
+    virtual ~TraceSink() = default;
+    // Both may be called concurrently from any thread
+    virtual void record(const TraceEvent& event) = 0;
+    virtual void counter(const char* name, int64_t value, uint64_t timestampUs, uint32_t threadId) = 0;
+};
+
+class CompileTrace
+{
+public:
+    // Installs the sink for the whole process; nullptr disables tracing
+    static void setSink(std::shared_ptr<TraceSink> sink);
+    static std::shared_ptr<TraceSink> sink();
+
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Adds value to a named counter
+    static void count(const char* name, int64_t value)
+    {
+        if (enabled())
+        {
+            emitCounter(name, value);
+        }
+    }
+
+    static uint64_t nowUs();
+    static uint32_t threadId();
+
+private:
+    static std::atomic<bool> s_enabled;
+    static void emitCounter(const char* name, int64_t value);
+};
+
+// Times the enclosing scope and reports it to the sink when it ends
+class ScopedTrace
+{
+public:
+    explicit ScopedTrace(const char* name, const char* category = "compile")
+    {
+        if (CompileTrace::enabled())
+        {
+            m_event.emplace();
+            m_event->name = name;
+            m_event->category = category;
+            m_event->startUs = CompileTrace::nowUs();
+        }
+    }
+    ~ScopedTrace()
+    {
+        if (m_event)
+        {
+            finish();
+        }
+    }
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+    void arg(const char* key, int64_t value)
+    {
+        if (m_event && m_event->argCount < TraceEvent::kMaxArgs)
+        {
+            m_event->args[m_event->argCount++] = { key, value };
+        }
+    }
+    void detail(std::string_view text)
+    {
+        if (m_event)
+        {
+            m_event->detail = text;
+        }
+    }
+    bool active() const { return m_event.has_value(); }
+
+    // Ends the timed span before the scope does
+    void end()
+    {
+        if (m_event)
+        {
+            finish();
+            m_event.reset();
+        }
+    }
+
+private:
+    std::optional<TraceEvent> m_event; // Engaged only while tracing
+
+    void finish();
+};
+
+// Buffers events and writes them in the Chrome trace-event JSON format
+class ChromeTraceSink : public TraceSink
+{
+public:
+    void record(const TraceEvent& event) override;
+    void counter(const char* name, int64_t value, uint64_t timestampUs, uint32_t threadId) override;
+
+    void write(std::ostream& stream) const;
+    // Returns false if the file cannot be written
+    bool writeFile(const std::string& path) const;
+    size_t eventCount() const;
+    void clear();
+
+private:
+    struct CounterSample
+    {
+        const char* name;
+        int64_t total; // Running total at this point
+        uint64_t timestampUs;
+        uint32_t threadId;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<TraceEvent> m_events;
+    std::vector<CounterSample> m_counters;
+    std::map<std::string_view, int64_t> m_counterTotals;
+};
+
+// Aggregates event durations per name into log2 histograms, and sums counters
+class HistogramSink : public TraceSink
+{
+public:
+    struct Histogram
+    {
+        static constexpr size_t kBuckets = 32; // Bucket i holds durations below 2^i us
+
+        uint64_t count = 0;
+        uint64_t totalUs = 0;
+        uint64_t minUs = UINT64_MAX;
+        uint64_t maxUs = 0;
+        std::array<uint64_t, kBuckets> buckets{};
+
+        // Upper bound of the bucket that holds the given fraction of samples
+        uint64_t percentileUs(double fraction) const;
+    };
+
+    void record(const TraceEvent& event) override;
+    void counter(const char* name, int64_t value, uint64_t timestampUs, uint32_t threadId) override;
+
+    std::map<std::string, Histogram> histograms() const;
+    std::map<std::string, int64_t> counters() const;
+    void writeJson(std::ostream& stream) const;
+    void clear();
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, Histogram, std::less<>> m_histograms;
+    std::map<std::string, int64_t, std::less<>> m_counters;
+};
+
+// Forwards to several sinks, e.g. a Chrome trace and histograms at once
+class TeeTraceSink : public TraceSink
+{
+public:
+    explicit TeeTraceSink(std::vector<std::shared_ptr<TraceSink>> sinks) : m_sinks(std::move(sinks)) {}
+
+    void record(const TraceEvent& event) override;
+    void counter(const char* name, int64_t value, uint64_t timestampUs, uint32_t threadId) override;
+
+private:
+    std::vector<std::shared_ptr<TraceSink>> m_sinks;
+};
@@ -0,0 +1,335 @@
+#include "CompilerPool.h"
+#include <algorithm>
+#include <latch>
+
+namespace
+{
+    constexpr const char* kShedMessage = "Compile shed: process memory is over the budget";
+
+    // Set while a worker runs a task, so calls back into its own pool can run inline
+    thread_local const CompilerPool* t_workerPool = nullptr;
+    thread_local SlangCompiler* t_workerCompiler = nullptr;
+}
+
+CompilerPool::CompilerPool(unsigned workerCount)
+{
+    if (workerCount == 0)
+    {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workerMemory.resize(workerCount);
+    m_workers.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; ++i)
+    {
+        m_workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+CompilerPool::~CompilerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_queueCondition.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+std::vector<CompileResult> CompilerPool::compileBatch(std::span<const CompileJob> jobs)
+{
+    std::vector<CompileResult> results(jobs.size());
+    auto compileOne = [&jobs, &results](SlangCompiler& compiler, size_t i)
+    {
+        try
+        {
+            results[i].outputs = compiler.compile(jobs[i]);
+        }
+        catch (const CompileCancelledError& e)
+        {
+            results[i].cancelled = true;
+            results[i].error = e.what();
+        }
+        catch (const std::exception& e)
+        {
+            results[i].error = e.what();
+        }
+        results[i].memory = compiler.lastJobMemory();
+    };
+
+    // From one of this pool's tasks the jobs could queue behind the very worker
+    // waiting for them, so they run on it instead
+    if (SlangCompiler* compiler = workerCompiler())
+    {
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            compileOne(*compiler, i);
+        }
+        return results;
+    }
+
+    std::latch done((std::ptrdiff_t)jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        submit([&compileOne, &done, i](SlangCompiler& compiler)
+        {
+            compileOne(compiler, i);
+            done.count_down();
+        }, 0, [&results, &done, i]
+        {
+            results[i].error = kShedMessage;
+            done.count_down();
+        });
+    }
+
+    done.wait();
+    return results;
+}
+
+CompileHandle CompilerPool::compileAsync(CompileJob job, int priority,
+    std::function<void(const CompileResult&)> onComplete)
+{
+    if (!job.cancel)
+    {
+        job.cancel = std::make_shared<std::atomic<bool>>(false);
+    }
+    std::shared_ptr<std::atomic<bool>> cancel = job.cancel;
+
+    auto promise = std::make_shared<std::promise<CompileResult>>();
+    CompileHandle handle(promise->get_future().share(), cancel);
+
+    // Publish first so a callback may safely wait on its own handle
+    auto complete = [promise, onComplete = std::move(onComplete)](const CompileResult& result)
+    {
+        promise->set_value(result);
+        if (onComplete)
+        {
+            try
+            {
+                onComplete(result);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Compile completion callback threw: " << e.what() << "\n";
+            }
+        }
+    };
+
+    submit([job = std::move(job), complete](SlangCompiler& compiler)
+    {
+        CompileResult result;
+        if (job.cancel->load(std::memory_order_relaxed))
+        {
+            // Dropped while still queued; never touches Slang
+            result.cancelled = true;
+            result.error = "Compile cancelled before start";
+        }
+        else
+        {
+            try
+            {
+                result.outputs = compiler.compile(job);
+            }
+            catch (const CompileCancelledError& e)
+            {
+                result.cancelled = true;
+                result.error = e.what();
+            }
+            catch (const std::exception& e)
+            {
+                result.error = e.what();
+            }
+            result.memory = compiler.lastJobMemory();
+        }
+        complete(result);
+    }, priority, [complete]
+    {
+        CompileResult result;
+        result.error = kShedMessage;
+        complete(result);
+    });
+
+    return handle;
+}
+
+std::future<void> CompilerPool::run(std::function<void(SlangCompiler&)> work, int priority)
+{
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> future = promise->get_future();
+    if (SlangCompiler* compiler = workerCompiler())
+    {
+        // Same reasoning as compileBatch: the caller may be about to wait on the future
+        try
+        {
+            work(*compiler);
+            promise->set_value();
+        }
+        catch (...)
+        {
+            promise->set_exception(std::current_exception());
+        }
+        return future;
+    }
+    submit([work = std::move(work), promise](SlangCompiler& compiler)
+    {
+        try
+        {
+            work(compiler);
+            promise->set_value();
+        }
+        catch (...)
+        {
+            promise->set_exception(std::current_exception());
+        }
+    }, priority, [promise]
+    {
+        promise->set_exception(std::make_exception_ptr(MemoryBudgetError(kShedMessage)));
+    });
+    return future;
+}
+
+void CompilerPool::setMemoryBudget(const MemoryBudget& budget)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_memoryBudget = budget;
+    }
+    // Throttled workers re-check against the new limit
+    m_queueCondition.notify_all();
+}
+
+CompilerPool::MemoryStats CompilerPool::memoryStats() const
+{
+    MemoryStats stats;
+    stats.rssBytes = currentRssBytes();
+    stats.peakRssBytes = peakRssBytes();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const WorkerMemory& worker : m_workerMemory)
+    {
+        stats.compilers.jobs += worker.compiler.jobs;
+        stats.compilers.outputBytes += worker.compiler.outputBytes;
+        stats.compilers.reflectionBytes += worker.compiler.reflectionBytes;
+        stats.compilers.peakRssDelta = std::max(stats.compilers.peakRssDelta, worker.compiler.peakRssDelta);
+        stats.compilers.retainedRssDelta += worker.compiler.retainedRssDelta;
+        stats.compilers.sessionSheds += worker.compiler.sessionSheds;
+        stats.compilers.sessionResidentBytes += worker.compiler.sessionResidentBytes;
+        stats.liveSessions += worker.liveSessions;
+    }
+    stats.queuedJobs = m_queue.size();
+    stats.runningJobs = m_runningJobs;
+    stats.throttledJobs = m_throttledJobs;
+    stats.shedJobs = m_shedJobs;
+    return stats;
+}
+
+void CompilerPool::setMemoryCache(std::shared_ptr<ShaderMemoryCache> cache)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memoryCache = std::move(cache);
+}
+
+void CompilerPool::setDiskCache(std::shared_ptr<ShaderDiskCache> cache)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_diskCache = std::move(cache);
+}
+
+void CompilerPool::setModuleCache(std::shared_ptr<ModuleCache> cache)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_moduleCache = std::move(cache);
+}
+
+void CompilerPool::setFileSystem(Slang::ComPtr<VirtualFileSystem> fileSystem)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_fileSystem = std::move(fileSystem);
+}
+
+SlangCompiler* CompilerPool::workerCompiler() const
+{
+    return t_workerPool == this ? t_workerCompiler : nullptr;
+}
+
+void CompilerPool::submit(Task task, int priority, Shed shed)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push(QueuedTask{ priority, m_nextSequence++, std::move(task), std::move(shed) });
+    }
+    m_queueCondition.notify_one();
+}
+
+void CompilerPool::workerLoop(size_t index)
+{
+    // Each worker pays for its own global session once, then stays warm
+    SlangCompiler compiler;
+
+    for (;;)
+    {
+        Task task;
+        bool budgeted = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            bool throttled = false;
+            for (;;)
+            {
+                m_queueCondition.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                if (m_queue.empty())
+                {
+                    return;
+                }
+                // A lone job always runs, so the pool keeps making progress over budget
+                bool overBudget = m_memoryBudget.queueRssBytes > 0 && m_runningJobs > 0 &&
+                    currentRssBytes() > m_memoryBudget.queueRssBytes;
+                if (!overBudget)
+                {
+                    break;
+                }
+                if (m_memoryBudget.shedQueuedJobs)
+                {
+                    Shed shed = std::move(const_cast<QueuedTask&>(m_queue.top()).shed);
+                    m_queue.pop();
+                    ++m_shedJobs;
+                    lock.unlock();
+                    if (shed)
+                    {
+                        shed();
+                    }
+                    lock.lock();
+                    continue;
+                }
+                // Woken when a running job finishes
+                throttled = true;
+                m_queueCondition.wait(lock);
+            }
+            // top() is const; the task is moved out just before it is popped
+            task = std::move(const_cast<QueuedTask&>(m_queue.top()).task);
+            m_queue.pop();
+            ++m_runningJobs;
+            m_throttledJobs += throttled ? 1 : 0;
+            budgeted = m_memoryBudget.queueRssBytes > 0;
+            compiler.setMemoryCache(m_memoryCache);
+            compiler.setDiskCache(m_diskCache);
+            compiler.setModuleCache(m_moduleCache);
+            compiler.setFileSystem(m_fileSystem);
+            compiler.setMemoryBudget(m_memoryBudget);
+        }
+        t_workerPool = this;
+        t_workerCompiler = &compiler;
+        task(compiler);
+        t_workerPool = nullptr;
+        t_workerCompiler = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_runningJobs;
+            m_workerMemory[index] = { compiler.memoryStats(), compiler.sessionPoolStats().liveSessions };
+        }
+        if (budgeted)
+        {
+            m_queueCondition.notify_all();
+        }
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+// CompilerPool.h
+// Runs compile jobs on a fixed set of worker threads. Slang sessions are not
+// thread-safe, so every worker owns its own SlangCompiler (and global session);
+// the memory, disk and module caches are shared between all of them.
+#include "ShaderCompiler.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <span>
+#include <thread>
+#include <vector>
+
+// Handle to an asynchronous compile. Copies share the same job.
+class CompileHandle
+{
+public:
+    CompileHandle() = default;
+    CompileHandle(std::shared_future<CompileResult> future, std::shared_ptr<std::atomic<bool>> cancel)
+        : m_future(std::move(future)), m_cancel(std::move(cancel)) {}
+
+    bool valid() const { return m_future.valid(); }
+    // Never blocks; safe to poll from frame-critical threads
+    bool ready() const { return m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+    // Blocks until the job has finished, failed or been cancelled
+    const CompileResult& get() const { return m_future.get(); }
+
+    // Queued jobs are dropped; running jobs stop at the next phase boundary
+    void cancel() { if (m_cancel) m_cancel->store(true, std::memory_order_relaxed); }
+
+private:
+    std::shared_future<CompileResult> m_future;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+
+class CompilerPool
+{
+public:
+    // workerCount 0 uses one worker per hardware thread
+    explicit CompilerPool(unsigned workerCount = 0);
+    ~CompilerPool();
+
+    CompilerPool(const CompilerPool&) = delete;
+    CompilerPool& operator=(const CompilerPool&) = delete;
+
+    // Compiles every job and blocks until all are done. results[i] belongs to
+    // jobs[i]; a failing job sets its error and never aborts the batch.
+    // Called from one of this pool's workers (inside run() work or a callback),
+    // the jobs run one after another on that worker instead of being queued.
+    std::vector<CompileResult> compileBatch(std::span<const CompileJob> jobs);
+
+    // Queues a job and returns immediately. Higher priority jobs are started
+    // first; equal priorities run in submission order. onComplete, if given,
+    // runs on the worker thread once the result is available. A worker must not
+    // block on a handle from its own pool: the job may be queued behind it.
+    CompileHandle compileAsync(CompileJob job, int priority = 0,
+        std::function<void(const CompileResult&)> onComplete = {});
+
+    // Runs arbitrary work with a worker's compiler, for front ends that drive the
+    // compiler directly (e.g. PermutationCompiler). Exceptions surface from the future.
+    // Called from one of this pool's workers, the work runs inline on that worker's
+    // compiler and the future is ready on return.
+    std::future<void> run(std::function<void(SlangCompiler&)> work, int priority = 0);
+
+    // Applied to every worker's compiler. Over queueRssBytes a worker starts a job
+    // only while no other job runs, or sheds queued jobs when the budget says so.
+    void setMemoryBudget(const MemoryBudget& budget);
+
+    struct MemoryStats
+    {
+        size_t rssBytes = 0;
+        size_t peakRssBytes = 0;
+        SlangCompiler::MemoryStats compilers; // Summed over workers as of their last job
+        size_t liveSessions = 0;
+        size_t queuedJobs = 0;
+        unsigned runningJobs = 0;
+        uint64_t throttledJobs = 0; // Started late because RSS was over queueRssBytes
+        uint64_t shedJobs = 0;      // Failed with MemoryBudgetError instead of running
+    };
+    // Safe to call from any thread at any time
+    MemoryStats memoryStats() const;
+
+    // Caches applied to every worker's compiler; set before submitting work
+    void setMemoryCache(std::shared_ptr<ShaderMemoryCache> cache);
+    void setDiskCache(std::shared_ptr<ShaderDiskCache> cache);
+    void setModuleCache(std::shared_ptr<ModuleCache> cache);
+    void setFileSystem(Slang::ComPtr<VirtualFileSystem> fileSystem);
+
+    unsigned workerCount() const { return (unsigned)m_workers.size(); }
+
+private:
+    using Task = std::function<void(SlangCompiler&)>;
+    // Completes a queued task without running it, when a memory budget sheds it
+    using Shed = std::function<void()>;
+
+    struct QueuedTask
+    {
+        int priority;
+        uint64_t sequence;
+        Task task;
+        Shed shed;
+
+        bool operator<(const QueuedTask& other) const
+        {
+            // std::priority_queue pops the largest; earlier submissions win ties
+            if (priority != other.priority) return priority < other.priority;
+            return sequence > other.sequence;
+        }
+    };
+
+    std::vector<std::thread> m_workers;
+    std::priority_queue<QueuedTask> m_queue;
+    uint64_t m_nextSequence = 0;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queueCondition;
+    bool m_stopping = false;
+
+    MemoryBudget m_memoryBudget;
+    unsigned m_runningJobs = 0;
+    uint64_t m_throttledJobs = 0;
+    uint64_t m_shedJobs = 0;
+    struct WorkerMemory
+    {
+        SlangCompiler::MemoryStats compiler;
+        size_t liveSessions = 0;
+    };
+    std::vector<WorkerMemory> m_workerMemory; // Indexed by worker
+
+    std::shared_ptr<ShaderMemoryCache> m_memoryCache;
+    std::shared_ptr<ShaderDiskCache> m_diskCache;
+    std::shared_ptr<ModuleCache> m_moduleCache;
+    Slang::ComPtr<VirtualFileSystem> m_fileSystem;
+
+    // The calling thread's compiler if it is one of this pool's workers running a task
+    SlangCompiler* workerCompiler() const;
+    void submit(Task task, int priority = 0, Shed shed = {});
+    void workerLoop(size_t index);
+};
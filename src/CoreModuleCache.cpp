@@ -0,0 +1,111 @@
+#include "CoreModuleCache.h"
+#include "AtomicFile.h"
+#include "BinaryStream.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include <string_view>
+
+namespace
+{
+    constexpr uint32_t kSnapshotMagic = 0x4d435353; // "SSCM"
+    constexpr uint32_t kSnapshotVersion = 1;
+
+    // Followed by the build tag, then the core module archive at an 8-byte boundary
+    struct SnapshotHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t buildTagSize;
+        uint32_t reserved;
+        uint64_t archiveSize;
+    };
+
+    bool loadSnapshot(const std::filesystem::path& path, slang::IGlobalSession* globalSession)
+    {
+        std::error_code error;
+        if (!std::filesystem::exists(path, error))
+        {
+            return false;
+        }
+        try
+        {
+            // Mapped rather than read, Slang copies what it needs while loading
+            MappedFile file(path);
+            BinaryReader reader(file.bytes());
+            SnapshotHeader header{};
+            if (!reader.read(header) || header.magic != kSnapshotMagic || header.version != kSnapshotVersion)
+            {
+                return false;
+            }
+            const uint8_t* buildTag = reader.take(header.buildTagSize);
+            if (!buildTag || std::string_view(reinterpret_cast<const char*>(buildTag), header.buildTagSize) != spGetBuildTagString())
+            {
+                return false;
+            }
+            const uint8_t* archive = reader.align(8) ? reader.take((size_t)header.archiveSize) : nullptr;
+            return archive && SLANG_SUCCEEDED(globalSession->loadCoreModule(archive, (size_t)header.archiveSize));
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+
+    void saveSnapshot(const std::filesystem::path& path, slang::IGlobalSession* globalSession)
+    {
+        Slang::ComPtr<slang::IBlob> archive;
+        if (SLANG_FAILED(globalSession->saveCoreModule(SLANG_ARCHIVE_TYPE_RIFF_LZ4, archive.writeRef())) || !archive)
+        {
+            return;
+        }
+
+        std::string_view buildTag = spGetBuildTagString();
+        std::vector<uint8_t> prefix;
+        BinaryWriter writer(prefix);
+        writer.write(SnapshotHeader{ kSnapshotMagic, kSnapshotVersion, (uint32_t)buildTag.size(), 0, archive->getBufferSize() });
+        writer.write(buildTag.data(), buildTag.size());
+        writer.align(8);
+
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+        writeFileAtomically(path, { prefix,
+            { static_cast<const uint8_t*>(archive->getBufferPointer()), archive->getBufferSize() } });
+    }
+}
+
+std::filesystem::path coreModuleSnapshotPath(const std::filesystem::path& directory)
+{
+    return directory / ("slang-core-" + toHex(fnv1a64(spGetBuildTagString())) + ".bin");
+}
+
+Slang::ComPtr<slang::IGlobalSession> createGlobalSessionWithSnapshot(const SlangGlobalSessionDesc& desc,
+    const std::filesystem::path& directory, CoreModuleSource* source)
+{
+    bool useSnapshot = !directory.empty() && !desc.enableGLSL;
+    std::filesystem::path path = useSnapshot ? coreModuleSnapshotPath(directory) : std::filesystem::path();
+
+    Slang::ComPtr<slang::IGlobalSession> globalSession;
+    if (useSnapshot)
+    {
+        if (SLANG_SUCCEEDED(slang_createGlobalSessionWithoutCoreModule(desc.apiVersion, globalSession.writeRef())) &&
+            globalSession && loadSnapshot(path, globalSession.get()))
+        {
+            if (source) *source = CoreModuleSource::LoadedSnapshot;
+            return globalSession;
+        }
+        // A session that failed to load a core module cannot be reused
+        globalSession = nullptr;
+    }
+
+    slang::createGlobalSession(&desc, globalSession.writeRef());
+    if (!globalSession)
+    {
+        throw std::runtime_error("Failed to create the Slang global session");
+    }
+    if (useSnapshot)
+    {
+        saveSnapshot(path, globalSession.get());
+    }
+    if (source) *source = CoreModuleSource::Built;
+    return globalSession;
+}
@@ -0,0 +1,25 @@
+#pragma once
+// CoreModuleCache.h
+// Global session creation that skips rebuilding the Slang core module. The
+// first run saves the compiled core module to a snapshot file named after the
+// Slang build tag; later runs create the session without a core module and
+// load the snapshot into it. Any mismatch or load failure falls back to a
+// normal build, which then rewrites the snapshot.
+#include <slang.h>
+#include <slang-com-ptr.h>
+#include <filesystem>
+
+enum class CoreModuleSource
+{
+    Built,          // No snapshot directory, or the snapshot did not match
+    LoadedSnapshot, // Loaded from the snapshot file
+};
+
+// One snapshot per Slang build, so upgrading Slang never loads a stale one
+std::filesystem::path coreModuleSnapshotPath(const std::filesystem::path& directory);
+
+// An empty directory always builds. GLSL-enabled descriptors always build too,
+// since sessions created without a core module cannot take the full descriptor.
+// Throws std::runtime_error if no global session can be created at all.
+Slang::ComPtr<slang::IGlobalSession> createGlobalSessionWithSnapshot(const SlangGlobalSessionDesc& desc,
+    const std::filesystem::path& directory, CoreModuleSource* source = nullptr);
@@ -0,0 +1,73 @@
+#pragma once
+// Hash.h
+// Hashing helpers: FNV-1a for in-memory keys, SHA-256 for persistent
+// content-addressed keys.
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+constexpr uint64_t kFnv1aOffset = 0xcbf29ce484222325ull;
+constexpr uint64_t kFnv1aPrime = 0x100000001b3ull;
+
+inline uint64_t fnv1a64(const void* data, size_t size, uint64_t seed = kFnv1aOffset)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= kFnv1aPrime;
+    }
+    return hash;
+}
+
+inline uint64_t fnv1a64(std::string_view text, uint64_t seed = kFnv1aOffset)
+{
+    return fnv1a64(text.data(), text.size(), seed);
+}
+
+// Two independent 64-bit hashes of the same fields; both must match for equality.
+// Used for in-memory keys where storing the hashed input itself is too costly.
+struct HashKey128
+{
+    uint64_t hash = 0;
+    uint64_t check = 0;
+};
+
+inline std::string toHex(uint64_t value)
+{
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return std::string(buffer, 16);
+}
+
+// Streaming SHA-256, used where a key must survive across processes and
+// collisions would silently return the wrong shader.
+class Sha256
+{
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Sha256();
+
+    void update(const void* data, size_t size);
+    void update(std::string_view text) { update(text.data(), text.size()); }
+
+    // Length-prefixed update, so ("ab","c") and ("a","bc") hash differently
+    void updateField(std::string_view text);
+    void updateU64(uint64_t value);
+
+    Digest finish();
+
+    static std::string toHex(const Digest& digest);
+
+private:
+    std::array<uint32_t, 8> m_state;
+    std::array<uint8_t, 64> m_block;
+    size_t m_blockSize = 0;
+    uint64_t m_totalSize = 0;
+
+    void transform(const uint8_t* block);
+};
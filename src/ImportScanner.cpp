@@ -0,0 +1,370 @@
+#include "ImportScanner.h"
+#include "VirtualFileSystem.h"
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+    bool isIdentifierChar(char c)
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    void skipSpaces(std::string_view source, size_t& pos)
+    {
+        while (pos < source.size() && std::isspace(static_cast<unsigned char>(source[pos])))
+        {
+            ++pos;
+        }
+    }
+
+    // Reads either a quoted path or a dotted module name starting at pos
+    std::string readImportName(std::string_view source, size_t& pos)
+    {
+        skipSpaces(source, pos);
+        if (pos >= source.size())
+        {
+            return {};
+        }
+        if (source[pos] == '"')
+        {
+            size_t end = source.find('"', pos + 1);
+            if (end == std::string_view::npos)
+            {
+                return {};
+            }
+            std::string name(source.substr(pos + 1, end - pos - 1));
+            pos = end + 1;
+            return name;
+        }
+        size_t start = pos;
+        while (pos < source.size() && (isIdentifierChar(source[pos]) || source[pos] == '.'))
+        {
+            ++pos;
+        }
+        return std::string(source.substr(start, pos - start));
+    }
+
+    std::filesystem::path normalise(const std::filesystem::path& path)
+    {
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        return error ? path.lexically_normal() : canonical;
+    }
+
+    // Digest and directives of every imported file seen by the process, so an
+    // unchanged import costs a stat rather than a read, a hash and a scan.
+    // Keyed by absolute path and revalidated by mtime and size.
+    class ImportDigestCache
+    {
+    public:
+        struct Stamp
+        {
+            std::filesystem::file_time_type modified;
+            uintmax_t size = 0;
+            bool operator==(const Stamp&) const = default;
+        };
+        struct Entry
+        {
+            Stamp stamp;
+            Sha256::Digest contentHash{};
+            std::vector<ImportDirective> imports;
+        };
+
+        static ImportDigestCache& instance()
+        {
+            static ImportDigestCache cache;
+            return cache;
+        }
+
+        // False if the file cannot be stat'ed, e.g. it is gone
+        static bool stamp(const std::filesystem::path& path, Stamp& stamp)
+        {
+            std::error_code error;
+            stamp.size = std::filesystem::file_size(path, error);
+            if (!error)
+            {
+                stamp.modified = std::filesystem::last_write_time(path, error);
+            }
+            return !error;
+        }
+
+        bool find(const std::string& key, const Stamp& stamp, Entry& entry) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto found = m_entries.find(key);
+            if (found == m_entries.end() || !(found->second.stamp == stamp))
+            {
+                return false;
+            }
+            entry = found->second;
+            return true;
+        }
+
+        void store(std::string key, Entry entry)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries[std::move(key)] = std::move(entry);
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, Entry> m_entries;
+    };
+
+    // Reads, hashes and scans one imported file, or takes all three from the
+    // digest cache when the file on disk is unchanged. Bundled files are not cached.
+    void digestImport(const std::filesystem::path& path, VirtualFileSystem* fileSystem,
+        Sha256::Digest& contentHash, std::vector<ImportDirective>& imports)
+    {
+        std::filesystem::path onDisk = fileSystem ? fileSystem->locate(path) : path;
+        std::string key;
+        ImportDigestCache::Entry entry;
+        // Stamped before reading, so an edit made during the read is caught next time
+        bool cacheable = !onDisk.empty() && ImportDigestCache::stamp(onDisk, entry.stamp);
+        if (cacheable)
+        {
+            std::error_code error;
+            std::filesystem::path absolute = std::filesystem::absolute(onDisk, error);
+            key = (error ? onDisk : absolute).lexically_normal().generic_string();
+            if (ImportDigestCache::instance().find(key, entry.stamp, entry))
+            {
+                contentHash = entry.contentHash;
+                imports = std::move(entry.imports);
+                return;
+            }
+        }
+
+        std::string content;
+        if (fileSystem)
+        {
+            fileSystem->readText(path, content);
+        }
+        else
+        {
+            std::ifstream stream(path, std::ios::in | std::ios::binary);
+            content.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        }
+        Sha256 hasher;
+        hasher.update(content);
+        contentHash = hasher.finish();
+        imports = scanImports(content);
+
+        if (cacheable)
+        {
+            entry.contentHash = contentHash;
+            entry.imports = imports;
+            ImportDigestCache::instance().store(std::move(key), std::move(entry));
+        }
+    }
+}
+
+std::vector<ImportDirective> scanImports(std::string_view source)
+{
+    std::vector<ImportDirective> imports;
+    bool atStatementStart = true;
+    size_t pos = 0;
+
+    while (pos < source.size())
+    {
+        char c = source[pos];
+
+        // Comments and string literals never contain directives
+        if (c == '/' && pos + 1 < source.size() && source[pos + 1] == '/')
+        {
+            pos = source.find('\n', pos);
+            if (pos == std::string_view::npos) break;
+            continue;
+        }
+        if (c == '/' && pos + 1 < source.size() && source[pos + 1] == '*')
+        {
+            pos = source.find("*/", pos + 2);
+            if (pos == std::string_view::npos) break;
+            pos += 2;
+            continue;
+        }
+        if (c == '"')
+        {
+            pos = source.find('"', pos + 1);
+            if (pos == std::string_view::npos) break;
+            ++pos;
+            atStatementStart = false;
+            continue;
+        }
+        if (c == '#')
+        {
+            size_t directive = pos + 1;
+            skipSpaces(source, directive);
+            if (source.substr(directive, 7) == "include")
+            {
+                size_t namePos = directive + 7;
+                std::string name = readImportName(source, namePos);
+                if (!name.empty())
+                {
+                    imports.push_back({ name, false });
+                }
+            }
+            pos = source.find('\n', pos);
+            if (pos == std::string_view::npos) break;
+            atStatementStart = true;
+            continue;
+        }
+        if (isIdentifierChar(c))
+        {
+            size_t start = pos;
+            while (pos < source.size() && isIdentifierChar(source[pos]))
+            {
+                ++pos;
+            }
+            std::string_view word = source.substr(start, pos - start);
+            if (atStatementStart && (word == "import" || word == "__include"))
+            {
+                std::string name = readImportName(source, pos);
+                if (!name.empty())
+                {
+                    // `import "file.slang"` names a file rather than a module
+                    bool quoted = source[pos - 1] == '"';
+                    imports.push_back({ name, word == "import" && !quoted });
+                }
+            }
+            atStatementStart = false;
+            continue;
+        }
+
+        if (c == ';' || c == '{' || c == '}')
+        {
+            atStatementStart = true;
+        }
+        else if (!std::isspace(static_cast<unsigned char>(c)))
+        {
+            atStatementStart = false;
+        }
+        ++pos;
+    }
+    return imports;
+}
+
+std::optional<std::filesystem::path> resolveImport(const std::string& import,
+    const std::filesystem::path& importingFile, const std::vector<std::string>& searchPaths,
+    VirtualFileSystem* fileSystem)
+{
+    std::vector<std::filesystem::path> candidates;
+    bool isPath = import.find('/') != std::string::npos || import.find('\\') != std::string::npos ||
+        std::filesystem::path(import).extension() == ".slang";
+    if (isPath)
+    {
+        candidates.emplace_back(import);
+    }
+    else
+    {
+        std::string relative = import;
+        for (char& c : relative)
+        {
+            if (c == '.') c = '/';
+        }
+        candidates.emplace_back(relative + ".slang");
+        std::string hyphenated = relative;
+        for (char& c : hyphenated)
+        {
+            if (c == '_') c = '-';
+        }
+        if (hyphenated != relative)
+        {
+            candidates.emplace_back(hyphenated + ".slang");
+        }
+    }
+
+    std::vector<std::filesystem::path> directories;
+    if (!importingFile.empty())
+    {
+        directories.push_back(importingFile.parent_path());
+    }
+    for (const auto& searchPath : searchPaths)
+    {
+        directories.emplace_back(searchPath);
+    }
+
+    std::error_code error;
+    for (const auto& directory : directories)
+    {
+        for (const auto& candidate : candidates)
+        {
+            std::filesystem::path full = directory / candidate;
+            if (fileSystem)
+            {
+                // Paths stay as the file system resolves them; canonicalising would stat the disk
+                if (fileSystem->exists(full))
+                {
+                    return full.lexically_normal();
+                }
+            }
+            else if (std::filesystem::is_regular_file(full, error))
+            {
+                return normalise(full);
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<ImportedFile> collectImportClosure(std::string_view source,
+    const std::filesystem::path& path, const std::vector<std::string>& searchPaths,
+    VirtualFileSystem* fileSystem)
+{
+    std::vector<ImportedFile> closure;
+    std::map<std::filesystem::path, size_t> indexByPath;
+    // (index into closure or npos for the root source, imports still to resolve)
+    std::vector<std::pair<size_t, std::vector<ImportDirective>>> pending;
+    constexpr size_t root = static_cast<size_t>(-1);
+
+    std::filesystem::path rootPath = path.empty() || fileSystem ? path.lexically_normal() : normalise(path);
+    pending.emplace_back(root, scanImports(source));
+
+    // Depth-first walk; each file is digested once and its imports queued
+    while (!pending.empty())
+    {
+        auto [importerIndex, imports] = std::move(pending.back());
+        pending.pop_back();
+        std::filesystem::path importingFile = importerIndex == root ? rootPath : closure[importerIndex].path;
+
+        for (const auto& import : imports)
+        {
+            std::optional<std::filesystem::path> resolved = resolveImport(import.name, importingFile, searchPaths, fileSystem);
+            if (!resolved || *resolved == rootPath)
+            {
+                continue;
+            }
+            if (importerIndex != root)
+            {
+                closure[importerIndex].imports.push_back(*resolved);
+            }
+            auto known = indexByPath.find(*resolved);
+            if (known != indexByPath.end())
+            {
+                if (import.isModule && closure[known->second].moduleName.empty())
+                {
+                    closure[known->second].moduleName = import.name;
+                }
+                continue;
+            }
+
+            ImportedFile file;
+            file.path = *resolved;
+            if (import.isModule)
+            {
+                file.moduleName = import.name;
+            }
+            std::vector<ImportDirective> directives;
+            digestImport(file.path, fileSystem, file.contentHash, directives);
+
+            indexByPath[file.path] = closure.size();
+            pending.emplace_back(closure.size(), std::move(directives));
+            closure.push_back(std::move(file));
+        }
+    }
+    return closure;
+}
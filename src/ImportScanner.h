@@ -0,0 +1,48 @@
+#pragma once
+// ImportScanner.h
+// Lightweight textual scan of `import`, `__include` and `#include` directives.
+// Finds the files a shader depends on without asking Slang to parse it.
+#include "Hash.h"
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class VirtualFileSystem;
+
+struct ImportDirective
+{
+    std::string name;      // Module name or quoted path, as written
+    bool isModule = false; // `import`, as opposed to a textual `__include` / `#include`
+};
+
+struct ImportedFile
+{
+    std::filesystem::path path;
+    // Name Slang gives the module when it is pulled in by `import name`;
+    // empty for files that are only ever included textually or by path
+    std::string moduleName;
+    Sha256::Digest contentHash{};
+    // Direct dependencies of this file, already resolved
+    std::vector<std::filesystem::path> imports;
+};
+
+// Returns the directives in the source, in order
+std::vector<ImportDirective> scanImports(std::string_view source);
+
+// Resolves an import the way Slang does: next to the importing file first,
+// then through the search paths. Dotted module names map to directories and
+// underscores may be spelled as hyphens in the file name.
+// With a fileSystem, files are looked up and read through it instead of the disk.
+std::optional<std::filesystem::path> resolveImport(const std::string& import,
+    const std::filesystem::path& importingFile, const std::vector<std::string>& searchPaths,
+    VirtualFileSystem* fileSystem = nullptr);
+
+// Transitive closure of files imported by source (not including source itself).
+// Unresolvable imports are skipped; Slang will report them when compiling.
+// Digests of files on disk are cached process-wide by path, mtime and size, so
+// unchanged imports are stat'ed rather than re-read and re-hashed.
+std::vector<ImportedFile> collectImportClosure(std::string_view source,
+    const std::filesystem::path& path, const std::vector<std::string>& searchPaths,
+    VirtualFileSystem* fileSystem = nullptr);
@@ -0,0 +1,173 @@
+#include "LazyProgram.h"
+#include "CompileTrace.h"
+#include <stdexcept>
+
+LazyProgram::LazyProgram(std::shared_ptr<PooledSession> session, Slang::ComPtr<slang::IComponentType> linkedProgram,
+    std::vector<std::string> entryPoints, std::vector<SlangCompileTarget> targets,
+    const CompileOptions& options, std::shared_ptr<std::mutex> slangMutex)
+    : m_slangMutex(std::move(slangMutex))
+    , m_session(std::move(session))
+    , m_linkedProgram(std::move(linkedProgram))
+    , m_entryPoints(std::move(entryPoints))
+    , m_targets(std::move(targets))
+    , m_outputs(new OutputSlot[m_entryPoints.size() * m_targets.size()])
+    , m_targetSlots(new TargetSlot[m_targets.size()])
+{
+    for (size_t targetIndex = 0; targetIndex < m_targets.size(); ++targetIndex)
+    {
+        m_targetSlots[targetIndex].wholeProgram = SlangCompiler::sharesTargetCode(options, m_targets[targetIndex]);
+    }
+}
+
+LazyProgram::LazyProgram(std::vector<std::string> entryPoints, std::vector<SlangCompileTarget> targets,
+    const std::vector<ShaderOutput>& outputs)
+    : m_entryPoints(std::move(entryPoints))
+    , m_targets(std::move(targets))
+    , m_outputs(new OutputSlot[m_entryPoints.size() * m_targets.size()])
+    , m_targetSlots(new TargetSlot[m_targets.size()])
+{
+    if (outputs.size() != m_entryPoints.size() * m_targets.size())
+    {
+        throw std::runtime_error("Output count does not match the program's entry points and targets");
+    }
+    for (size_t i = 0; i < outputs.size(); ++i)
+    {
+        // Marking the once flags as done keeps every later access on the fast path
+        std::call_once(m_outputs[i].once, [&] { m_outputs[i].output = outputs[i]; });
+        m_outputs[i].ready.store(true, std::memory_order_release);
+        size_t targetIndex = i % m_targets.size();
+        if (outputs[i].reflection)
+        {
+            TargetSlot& target = m_targetSlots[targetIndex];
+            std::call_once(target.reflectionOnce, [&] { target.reflection = outputs[i].reflection; });
+        }
+    }
+}
+
+LazyProgram::~LazyProgram()
+{
+    // Slang objects are released under the same lock as every other call on their global session
+    if (m_slangMutex)
+    {
+        std::lock_guard<std::mutex> lock(*m_slangMutex);
+        m_linkedProgram = nullptr;
+        m_session.reset();
+    }
+}
+
+const ShaderOutput& LazyProgram::output(size_t entryIndex, size_t targetIndex) const
+{
+    if (entryIndex >= m_entryPoints.size() || targetIndex >= m_targets.size())
+    {
+        throw std::out_of_range("LazyProgram output index out of range");
+    }
+    OutputSlot& slot = m_outputs[entryIndex * m_targets.size() + targetIndex];
+    if (slot.ready.load(std::memory_order_acquire))
+    {
+        return slot.output;
+    }
+
+    // A throwing generation leaves the flag unset, so the next access retries
+    std::call_once(slot.once, [&]
+    {
+        ShaderOutput output;
+        TargetSlot& target = m_targetSlots[targetIndex];
+        if (target.wholeProgram)
+        {
+            std::call_once(target.codeOnce, [&]
+            {
+                std::lock_guard<std::mutex> lock(*m_slangMutex);
+                target.code = SlangCompiler::generateTargetCode(m_linkedProgram.get(), targetIndex, m_targets[targetIndex]);
+            });
+            output.target = m_targets[targetIndex];
+            output.entryPointName = m_entryPoints[entryIndex];
+            output.codeBlob = target.code;
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(*m_slangMutex);
+            output = SlangCompiler::generateEntryPointCode(m_linkedProgram.get(),
+                entryIndex, m_entryPoints[entryIndex], targetIndex, m_targets[targetIndex]);
+        }
+        if (!output.empty())
+        {
+            output.reflection = reflection(targetIndex);
+        }
+        slot.output = std::move(output);
+        slot.ready.store(true, std::memory_order_release);
+    });
+    return slot.output;
+}
+
+const ShaderOutput& LazyProgram::output(std::string_view entryPoint, SlangCompileTarget target) const
+{
+    for (size_t entryIndex = 0; entryIndex < m_entryPoints.size(); ++entryIndex)
+    {
+        if (m_entryPoints[entryIndex] != entryPoint)
+        {
+            continue;
+        }
+        for (size_t targetIndex = 0; targetIndex < m_targets.size(); ++targetIndex)
+        {
+            if (m_targets[targetIndex] == target)
+            {
+                return output(entryIndex, targetIndex);
+            }
+        }
+    }
+    throw std::out_of_range("Entry point " + std::string(entryPoint) + " is not part of this program for the target");
+}
+
+std::shared_ptr<const ReflectionTable> LazyProgram::reflection(size_t targetIndex) const
+{
+    if (targetIndex >= m_targets.size())
+    {
+        throw std::out_of_range("LazyProgram target index out of range");
+    }
+    TargetSlot& slot = m_targetSlots[targetIndex];
+    std::call_once(slot.reflectionOnce, [&]
+    {
+        if (m_linkedProgram)
+        {
+            ScopedTrace reflectionTrace("reflection");
+            std::lock_guard<std::mutex> lock(*m_slangMutex);
+            slot.reflection = SlangCompiler::extractResourceBindings(m_linkedProgram.get(), (int)targetIndex);
+        }
+    });
+    return slot.reflection;
+}
+
+bool LazyProgram::generated(size_t entryIndex, size_t targetIndex) const
+{
+    if (entryIndex >= m_entryPoints.size() || targetIndex >= m_targets.size())
+    {
+        return false;
+    }
+    return m_outputs[entryIndex * m_targets.size() + targetIndex].ready.load(std::memory_order_acquire);
+}
+
+size_t LazyProgram::generatedCount() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < m_entryPoints.size() * m_targets.size(); ++i)
+    {
+        count += m_outputs[i].ready.load(std::memory_order_acquire) ? 1 : 0;
+    }
+    return count;
+}
+
+MultiTargetOutput LazyProgram::materialize() const
+{
+    MultiTargetOutput result;
+    result.entryPoints = m_entryPoints;
+    result.targets = m_targets;
+    result.outputs.reserve(m_entryPoints.size() * m_targets.size());
+    for (size_t entryIndex = 0; entryIndex < m_entryPoints.size(); ++entryIndex)
+    {
+        for (size_t targetIndex = 0; targetIndex < m_targets.size(); ++targetIndex)
+        {
+            result.outputs.push_back(output(entryIndex, targetIndex));
+        }
+    }
+    return result;
+}
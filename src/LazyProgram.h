@@ -0,0 +1,74 @@
+#pragma once
+// LazyProgram.h
+// A linked program that generates code per (entry point, target) on first
+// access rather than up front. Linking and reflection are shared, and stages
+// nobody asks for never reach Slang's back end. Thread-safe: concurrent first
+// accesses to one output generate it once, and every Slang call is serialised
+// with the SlangCompiler that produced the program. Created by
+// SlangCompiler::compileLazy; may outlive the compiler.
+#include "ShaderCompiler.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class LazyProgram
+{
+public:
+    // Wraps a linked program; slangMutex guards the global session it came from.
+    // With options.wholeProgram the first SPIR-V access generates the module for every entry point.
+    LazyProgram(std::shared_ptr<PooledSession> session, Slang::ComPtr<slang::IComponentType> linkedProgram,
+        std::vector<std::string> entryPoints, std::vector<SlangCompileTarget> targets,
+        const CompileOptions& options, std::shared_ptr<std::mutex> slangMutex);
+    // Outputs that already exist (e.g. a cache hit), entry-point major
+    LazyProgram(std::vector<std::string> entryPoints, std::vector<SlangCompileTarget> targets,
+        const std::vector<ShaderOutput>& outputs);
+    ~LazyProgram();
+
+    LazyProgram(const LazyProgram&) = delete;
+    LazyProgram& operator=(const LazyProgram&) = delete;
+
+    const std::vector<std::string>& entryPoints() const { return m_entryPoints; }
+    const std::vector<SlangCompileTarget>& targets() const { return m_targets; }
+
+    // Generates the code on the first call and returns the same output afterwards.
+    // empty() if Slang produced no code. Throws std::out_of_range on bad indices.
+    const ShaderOutput& output(size_t entryIndex, size_t targetIndex) const;
+    // Throws std::out_of_range if the pair is not part of the program
+    const ShaderOutput& output(std::string_view entryPoint, SlangCompileTarget target) const;
+
+    // Computed once per target, shared by its outputs
+    std::shared_ptr<const ReflectionTable> reflection(size_t targetIndex) const;
+
+    bool generated(size_t entryIndex, size_t targetIndex) const;
+    size_t generatedCount() const;
+
+    // Generates whatever is still missing
+    MultiTargetOutput materialize() const;
+
+private:
+    struct OutputSlot
+    {
+        std::once_flag once;
+        std::atomic<bool> ready{ false };
+        ShaderOutput output;
+    };
+    struct TargetSlot
+    {
+        std::once_flag reflectionOnce;
+        std::shared_ptr<const ReflectionTable> reflection;
+        bool wholeProgram = false;
+        std::once_flag codeOnce;
+        Slang::ComPtr<slang::IBlob> code; // Whole-program module
+    };
+
+    std::shared_ptr<std::mutex> m_slangMutex;
+    std::shared_ptr<PooledSession> m_session; // Keeps the program's modules alive
+    Slang::ComPtr<slang::IComponentType> m_linkedProgram;
+    std::vector<std::string> m_entryPoints;
+    std::vector<SlangCompileTarget> m_targets;
+    std::unique_ptr<OutputSlot[]> m_outputs;         // Entry-point major
+    std::unique_ptr<TargetSlot[]> m_targetSlots;
+};
@@ -0,0 +1,35 @@
+#pragma once
+// MappedFile.h
+// Read-only memory mapping of a whole file (mmap / MapViewOfFile).
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    // Throws std::runtime_error if the file cannot be opened or mapped
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    std::span<const uint8_t> bytes() const { return { m_data, m_size }; }
+    std::string_view text() const { return { reinterpret_cast<const char*>(m_data), m_size }; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_mapping = nullptr;
+#endif
+
+    void unmap();
+};
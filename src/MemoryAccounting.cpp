@@ -0,0 +1,83 @@
+#include "MemoryAccounting.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#else
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+#ifdef _WIN32
+
+size_t currentRssBytes()
+{
+    PROCESS_MEMORY_COUNTERS counters{};
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.WorkingSetSize : 0;
+}
+
+size_t peakRssBytes()
+{
+    PROCESS_MEMORY_COUNTERS counters{};
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+}
+
+#elif defined(__APPLE__)
+
+size_t currentRssBytes()
+{
+    mach_task_basic_info info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+    {
+        return 0;
+    }
+    return (size_t)info.resident_size;
+}
+
+size_t peakRssBytes()
+{
+    rusage usage{};
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? (size_t)usage.ru_maxrss : 0; // Bytes on macOS
+}
+
+#else
+
+size_t currentRssBytes()
+{
+    // Opened once and re-read with pread, so a probe is a single syscall
+    static const int file = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+    static const long pageSize = sysconf(_SC_PAGESIZE);
+    if (file < 0 || pageSize <= 0)
+    {
+        return 0;
+    }
+    char buffer[128];
+    ssize_t size = pread(file, buffer, sizeof(buffer) - 1, 0);
+    if (size <= 0)
+    {
+        return 0;
+    }
+    buffer[size] = '\0';
+    unsigned long long totalPages = 0, residentPages = 0;
+    if (std::sscanf(buffer, "%llu %llu", &totalPages, &residentPages) != 2)
+    {
+        return 0;
+    }
+    return (size_t)residentPages * (size_t)pageSize;
+}
+
+size_t peakRssBytes()
+{
+    rusage usage{};
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? (size_t)usage.ru_maxrss * 1024 : 0; // KiB on Linux
+}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+// MemoryAccounting.h
+// Process memory probes and the per-job accounting and budgets built on them.
+// Slang allocates through its own heap, so the resident set size is the only
+// measure that covers global sessions, sessions and their modules. RSS is
+// process-wide: with several jobs running in parallel the per-job deltas are
+// approximate and each job sees some of its neighbours' growth.
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+// Resident set size of this process in bytes; 0 where unsupported
+size_t currentRssBytes();
+// High-water mark of the resident set in bytes; 0 where unsupported
+size_t peakRssBytes();
+
+// Memory attributed to one SlangCompiler::compile(const CompileJob&) call
+struct JobMemoryStats
+{
+    size_t outputBytes = 0;       // Code blobs returned
+    size_t reflectionBytes = 0;   // Distinct reflection tables returned
+    size_t rssBefore = 0;
+    int64_t peakRssDelta = 0;     // Highest RSS seen at a phase boundary, minus rssBefore
+    int64_t retainedRssDelta = 0; // RSS after the job, minus rssBefore
+};
+
+// Limits compared against process RSS between jobs; 0 disables a limit
+struct MemoryBudget
+{
+    // Above this a compiler drops its warm sessions after the job that crossed it
+    size_t sessionRssBytes = 0;
+    // Above this pool workers only start a job when no other job is running
+    size_t queueRssBytes = 0;
+    // Above queueRssBytes, fail queued jobs with MemoryBudgetError instead of waiting
+    bool shedQueuedJobs = false;
+};
+
+// Reported for queued work dropped by a MemoryBudget
+class MemoryBudgetError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
@@ -0,0 +1,245 @@
+#include "ModuleCache.h"
+#include "AtomicFile.h"
+#include "MappedFile.h"
+#include "ShaderBlob.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+namespace
+{
+    constexpr const char* kModuleExtension = ".slang-module";
+
+    void printDiagnostics(slang::IBlob* diagnostics)
+    {
+        if (diagnostics && diagnostics->getBufferSize() > 0)
+        {
+            std::string diagStr((const char*)diagnostics->getBufferPointer(), diagnostics->getBufferSize());
+            std::cerr << "Slang module diagnostics:\n" << diagStr << "\n";
+        }
+    }
+
+    // Orders the closure dependencies-first and gives every file a key that
+    // covers its own content and, recursively, the keys of what it imports
+    class ClosureWalker
+    {
+    public:
+        ClosureWalker(const std::vector<ImportedFile>& imports, const CompileOptions& options)
+            : m_imports(imports), m_keys(imports.size()), m_state(imports.size(), State::Unvisited)
+        {
+            for (size_t i = 0; i < imports.size(); ++i)
+            {
+                m_indexByPath[imports[i].path] = i;
+            }
+
+            Sha256 hasher;
+            hasher.updateField("SlangShaderCompiler/module/1");
+            hasher.updateField(spGetBuildTagString());
+            hasher.updateField(options.profile);
+            std::vector<ShaderMacro> macros = options.macros;
+            std::sort(macros.begin(), macros.end(),
+                [](const ShaderMacro& a, const ShaderMacro& b) { return a.name < b.name; });
+            hasher.updateU64(macros.size());
+            for (const auto& macro : macros)
+            {
+                hasher.updateField(macro.name);
+                hasher.updateField(macro.value);
+            }
+            m_optionsDigest = hasher.finish();
+
+            for (size_t i = 0; i < imports.size(); ++i)
+            {
+                visit(i);
+            }
+        }
+
+        const std::vector<size_t>& order() const { return m_order; }
+        const Sha256::Digest& key(size_t index) const { return m_keys[index]; }
+
+    private:
+        enum class State { Unvisited, Visiting, Done };
+
+        const std::vector<ImportedFile>& m_imports;
+        std::map<std::filesystem::path, size_t> m_indexByPath;
+        std::vector<Sha256::Digest> m_keys;
+        std::vector<State> m_state;
+        std::vector<size_t> m_order;
+        Sha256::Digest m_optionsDigest{};
+
+        void visit(size_t index)
+        {
+            // Slang rejects import cycles; just don't recurse forever on one
+            if (m_state[index] != State::Unvisited)
+            {
+                return;
+            }
+            m_state[index] = State::Visiting;
+
+            const ImportedFile& file = m_imports[index];
+            Sha256 hasher;
+            hasher.update(m_optionsDigest.data(), m_optionsDigest.size());
+            hasher.updateField(file.moduleName);
+            hasher.update(file.contentHash.data(), file.contentHash.size());
+            hasher.updateU64(file.imports.size());
+            for (const auto& dependency : file.imports)
+            {
+                auto found = m_indexByPath.find(dependency);
+                if (found == m_indexByPath.end())
+                {
+                    continue;
+                }
+                visit(found->second);
+                hasher.update(m_keys[found->second].data(), m_keys[found->second].size());
+            }
+            m_keys[index] = hasher.finish();
+
+            m_state[index] = State::Done;
+            m_order.push_back(index);
+        }
+    };
+}
+
+ModuleCache::ModuleCache(std::filesystem::path directory)
+    : m_directory(std::move(directory))
+{
+    if (m_directory.empty())
+    {
+        return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error)
+    {
+        throw std::runtime_error("Failed to create module cache directory: " + m_directory.string());
+    }
+}
+
+bool ModuleCache::preload(PooledSession& session, const std::vector<ImportedFile>& imports, const CompileOptions& options)
+{
+    ClosureWalker walker(imports, options);
+
+    for (size_t index : walker.order())
+    {
+        const ImportedFile& file = imports[index];
+        // Textual includes are compiled as part of the module that includes them
+        if (file.moduleName.empty())
+        {
+            continue;
+        }
+
+        std::string key = Sha256::toHex(walker.key(index));
+        auto loaded = session.importedModules.find(file.moduleName);
+        if (loaded != session.importedModules.end())
+        {
+            if (loaded->second != key)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        std::string path = file.path.string();
+        Slang::ComPtr<slang::IBlob> diagnostics;
+        slang::IModule* module = nullptr;
+        if (Slang::ComPtr<slang::IBlob> blob = find(key, file.moduleName))
+        {
+            module = session.session->loadModuleFromIRBlob(file.moduleName.c_str(), path.c_str(), blob, diagnostics.writeRef());
+        }
+
+        if (module)
+        {
+            ++m_hits;
+        }
+        else
+        {
+            // Missing or unreadable IR: compile from source and keep the result
+            ++m_misses;
+            module = session.session->loadModule(file.moduleName.c_str(), diagnostics.writeRef());
+            printDiagnostics(diagnostics);
+            if (!module)
+            {
+                return true;
+            }
+
+            Slang::ComPtr<slang::IBlob> serialized;
+            if (SLANG_SUCCEEDED(module->serialize(serialized.writeRef())) && serialized)
+            {
+                store(key, file.moduleName, serialized);
+            }
+        }
+        session.importedModules[file.moduleName] = key;
+    }
+    return true;
+}
+
+ModuleCache::Stats ModuleCache::stats() const
+{
+    Stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.writes = m_writes;
+    return stats;
+}
+
+Slang::ComPtr<slang::IBlob> ModuleCache::find(const std::string& key, const std::string& moduleName)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_blobs.find(key);
+        if (found != m_blobs.end())
+        {
+            return found->second;
+        }
+    }
+    if (m_directory.empty())
+    {
+        return nullptr;
+    }
+
+    std::filesystem::path path = modulePath(key, moduleName);
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error))
+    {
+        return nullptr;
+    }
+
+    Slang::ComPtr<slang::IBlob> blob;
+    try
+    {
+        auto file = std::make_shared<MappedFile>(path);
+        blob = createBlobView(file, file->data(), file->size());
+    }
+    catch (const std::exception&)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_blobs.emplace(key, blob);
+    return blob;
+}
+
+void ModuleCache::store(const std::string& key, const std::string& moduleName, slang::IBlob* blob)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_blobs.emplace(key, Slang::ComPtr<slang::IBlob>(blob));
+    }
+    if (m_directory.empty())
+    {
+        return;
+    }
+
+    std::filesystem::path path = modulePath(key, moduleName);
+    if (!writeFileAtomically(path, { { static_cast<const uint8_t*>(blob->getBufferPointer()), blob->getBufferSize() } }))
+    {
+        return;
+    }
+    ++m_writes;
+}
+
+std::filesystem::path ModuleCache::modulePath(const std::string& key, const std::string& moduleName) const
+{
+    // The module name is only there to make the directory readable
+    return m_directory / (moduleName + "-" + key.substr(0, 32) + kModuleExtension);
+}
@@ -0,0 +1,55 @@
+#pragma once
+// ModuleCache.h
+// Serialized Slang IR (.slang-module) of imported modules. Shared code such as
+// common.slang is parsed and checked once, then loaded into every new session
+// from IR. Entries are keyed by the content of the module and everything it
+// imports, the profile, the macros and the Slang build tag, so an edit or a
+// compiler upgrade simply produces a new entry. Safe to share between threads
+// and processes: files are written to a temporary name and renamed.
+#include "CompileOptions.h"
+#include "ImportScanner.h"
+#include "SessionPool.h"
+#include <slang.h>
+#include <slang-com-ptr.h>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ModuleCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;   // Modules loaded from IR
+        uint64_t misses = 0; // Modules compiled from source
+        uint64_t writes = 0;
+    };
+
+    // An empty directory keeps the IR in memory only
+    explicit ModuleCache(std::filesystem::path directory = {});
+
+    // Loads every module in imports (see collectImportClosure) into the session,
+    // dependencies first, from IR where possible. Returns false if the session
+    // already holds a different version of one of them; it must then be replaced.
+    // Modules that fail to load are left for the compile to report.
+    bool preload(PooledSession& session, const std::vector<ImportedFile>& imports, const CompileOptions& options);
+
+    Stats stats() const;
+    const std::filesystem::path& directory() const { return m_directory; }
+
+private:
+    std::filesystem::path m_directory;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Slang::ComPtr<slang::IBlob>> m_blobs; // By key
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_misses{ 0 };
+    std::atomic<uint64_t> m_writes{ 0 };
+
+    Slang::ComPtr<slang::IBlob> find(const std::string& key, const std::string& moduleName);
+    void store(const std::string& key, const std::string& moduleName, slang::IBlob* blob);
+    std::filesystem::path modulePath(const std::string& key, const std::string& moduleName) const;
+};
@@ -0,0 +1,227 @@
+#include "PermutationCompiler.h"
+#include "CompileTrace.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+    // Variants that share macro values, and so one parse
+    struct MacroGroup
+    {
+        CompileJob job;
+        std::vector<std::vector<std::string>> typeArgumentSets;
+        std::map<std::vector<uint32_t>, size_t> specializationIndex; // Type argument choices -> set
+        std::vector<CompileResult> results;
+        std::string error;
+    };
+
+    std::vector<uint32_t> choicesOfKind(const PermutationRequest& request, const PermutationVariant& variant,
+        PermutationAxis::Kind kind)
+    {
+        std::vector<uint32_t> choices;
+        for (size_t axis = 0; axis < request.axes.size(); ++axis)
+        {
+            if (request.axes[axis].kind == kind)
+            {
+                choices.push_back(variant.choice[axis]);
+            }
+        }
+        return choices;
+    }
+}
+
+const PermutationVariant* PermutationResult::find(uint64_t hash) const
+{
+    for (const auto& variant : variants)
+    {
+        if (variant.hash == hash)
+        {
+            return &variant;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<PermutationVariant> PermutationCompiler::enumerate(const PermutationRequest& request)
+{
+    constexpr size_t kMaxVariants = size_t(1) << 20;
+
+    size_t variantCount = 1;
+    for (const auto& axis : request.axes)
+    {
+        if (axis.values.empty())
+        {
+            throw std::runtime_error("Permutation axis has no values: " + axis.name);
+        }
+        variantCount *= axis.values.size();
+        if (variantCount > kMaxVariants)
+        {
+            throw std::runtime_error("Too many permutations");
+        }
+    }
+
+    std::vector<PermutationVariant> variants(variantCount);
+    for (size_t index = 0; index < variantCount; ++index)
+    {
+        PermutationVariant& variant = variants[index];
+        variant.choice.resize(request.axes.size());
+        size_t remainder = index;
+        for (size_t axis = request.axes.size(); axis-- > 0;)
+        {
+            variant.choice[axis] = (uint32_t)(remainder % request.axes[axis].values.size());
+            remainder /= request.axes[axis].values.size();
+        }
+
+        uint64_t hash = kFnv1aOffset;
+        for (size_t axis = 0; axis < request.axes.size(); ++axis)
+        {
+            const PermutationAxis& definition = request.axes[axis];
+            const std::string& value = definition.values[variant.choice[axis]];
+            uint8_t kind = (uint8_t)definition.kind;
+            hash = fnv1a64(&kind, 1, hash);
+            hash = fnv1a64(definition.name, hash);
+            hash = fnv1a64("=", 1, hash);
+            hash = fnv1a64(value, hash);
+            hash = fnv1a64(";", 1, hash);
+
+            switch (definition.kind)
+            {
+            case PermutationAxis::Kind::Macro:
+                variant.macros.push_back({ definition.name, value });
+                break;
+            case PermutationAxis::Kind::SpecializationConstant:
+                variant.specializationConstants.push_back({ definition.name, value });
+                break;
+            case PermutationAxis::Kind::TypeArgument:
+                variant.typeArguments.push_back(value);
+                break;
+            }
+        }
+        variant.hash = hash;
+    }
+    return variants;
+}
+
+PermutationResult PermutationCompiler::compile(const PermutationRequest& request)
+{
+    ScopedTrace trace("compilePermutations");
+    trace.detail(request.path);
+
+    PermutationResult result;
+    result.variants = enumerate(request);
+    trace.arg("variants", (int64_t)result.variants.size());
+
+    // Group by macro values; within a group, one link per distinct type argument set
+    std::vector<MacroGroup> groups;
+    std::map<std::vector<uint32_t>, size_t> groupIndex;
+    std::vector<std::pair<size_t, size_t>> variantSlots; // (group, type argument set) per variant
+    variantSlots.reserve(result.variants.size());
+    for (const auto& variant : result.variants)
+    {
+        auto [groupIt, newGroup] = groupIndex.emplace(
+            choicesOfKind(request, variant, PermutationAxis::Kind::Macro), groups.size());
+        if (newGroup)
+        {
+            MacroGroup group;
+            group.job.source = request.source;
+            group.job.path = request.path;
+            group.job.entryPoints = request.entryPoints;
+            group.job.targets = request.targets;
+            group.job.options = request.options;
+            for (const auto& macro : variant.macros)
+            {
+                std::erase_if(group.job.options.macros,
+                    [&](const ShaderMacro& existing) { return existing.name == macro.name; });
+                group.job.options.macros.push_back(macro);
+            }
+            groups.push_back(std::move(group));
+        }
+        MacroGroup& group = groups[groupIt->second];
+
+        auto [setIt, newSet] = group.specializationIndex.emplace(
+            choicesOfKind(request, variant, PermutationAxis::Kind::TypeArgument), group.typeArgumentSets.size());
+        if (newSet)
+        {
+            group.typeArgumentSets.push_back(variant.typeArguments);
+        }
+        variantSlots.emplace_back(groupIt->second, setIt->second);
+    }
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(groups.size());
+    for (MacroGroup& group : groups)
+    {
+        pending.push_back(m_pool.run([&group](SlangCompiler& compiler)
+        {
+            group.results = compiler.compileSpecializations(group.job, group.typeArgumentSets);
+        }));
+        result.links += group.typeArgumentSets.size();
+    }
+    result.parses = groups.size();
+    for (size_t i = 0; i < pending.size(); ++i)
+    {
+        try
+        {
+            pending[i].get();
+        }
+        catch (const std::exception& e)
+        {
+            groups[i].error = e.what();
+        }
+    }
+
+    // Store each distinct blob once; outputs of one link are compared by pointer first
+    std::unordered_map<const slang::IBlob*, uint32_t> blobByPointer;
+    std::map<Sha256::Digest, uint32_t> blobByContent;
+    for (size_t v = 0; v < result.variants.size(); ++v)
+    {
+        PermutationVariant& variant = result.variants[v];
+        const MacroGroup& group = groups[variantSlots[v].first];
+        if (!group.error.empty())
+        {
+            variant.error = group.error;
+            ++result.failedVariants;
+            continue;
+        }
+        const CompileResult& compiled = group.results[variantSlots[v].second];
+        if (!compiled.succeeded())
+        {
+            variant.error = compiled.error;
+            ++result.failedVariants;
+            continue;
+        }
+
+        variant.outputs = compiled.outputs;
+        variant.blobIndices.reserve(variant.outputs.size());
+        for (ShaderOutput& output : variant.outputs)
+        {
+            if (output.empty())
+            {
+                variant.blobIndices.push_back(PermutationVariant::kNoBlob);
+                continue;
+            }
+            result.totalBytes += output.bytes().size();
+
+            auto known = blobByPointer.find(output.codeBlob.get());
+            if (known == blobByPointer.end())
+            {
+                Sha256 hasher;
+                hasher.update(output.bytes().data(), output.bytes().size());
+                auto [contentIt, isNew] = blobByContent.emplace(hasher.finish(), (uint32_t)result.blobs.size());
+                if (isNew)
+                {
+                    result.blobs.push_back(output.codeBlob);
+                    result.uniqueBytes += output.bytes().size();
+                }
+                known = blobByPointer.emplace(output.codeBlob.get(), contentIt->second).first;
+            }
+            output.codeBlob = result.blobs[known->second];
+            variant.blobIndices.push_back(known->second);
+        }
+    }
+
+    trace.arg("parses", (int64_t)result.parses);
+    trace.arg("links", (int64_t)result.links);
+    trace.arg("uniqueBlobs", (int64_t)result.blobs.size());
+    return result;
+}
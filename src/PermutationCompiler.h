@@ -0,0 +1,97 @@
+#pragma once
+// PermutationCompiler.h
+// Builds every variant of a shader over a set of axes. Macro axes need their own
+// parse, so variants are grouped by macro values and the groups run in parallel
+// on a CompilerPool; within a group the module is parsed once and each type
+// argument combination is specialize()d and linked from it. Specialization
+// constants are set at pipeline creation, so they are recorded per variant but
+// never cause a compile. Identical output blobs are stored once.
+#include "CompilerPool.h"
+#include "Hash.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct PermutationAxis
+{
+    enum class Kind
+    {
+        Macro,                  // Preprocessor define, name=value
+        SpecializationConstant, // [SpecializationConstant] / [vk::constant_id] value, recorded only
+        TypeArgument,           // Generic type argument passed to specialize()
+    };
+
+    Kind kind = Kind::Macro;
+    // Macro or constant name; for type arguments it only names the axis
+    std::string name;
+    std::vector<std::string> values;
+};
+
+struct PermutationRequest
+{
+    std::string source;
+    std::string path;
+    std::vector<std::string> entryPoints;
+    std::vector<SlangCompileTarget> targets;
+    CompileOptions options;
+    // TypeArgument axes are passed to specialize() in the order they appear here,
+    // which must match the program's specialization parameters
+    std::vector<PermutationAxis> axes;
+};
+
+struct SpecializationConstantValue
+{
+    std::string name;
+    std::string value;
+};
+
+struct PermutationVariant
+{
+    static constexpr uint32_t kNoBlob = UINT32_MAX;
+
+    std::vector<uint32_t> choice; // Value index per axis
+    uint64_t hash = 0;            // Of the axis names and chosen values; stable across runs
+    std::vector<ShaderMacro> macros;
+    std::vector<std::string> typeArguments;
+    std::vector<SpecializationConstantValue> specializationConstants;
+
+    // Entry-point major as in CompileResult; code blobs are shared with every
+    // variant that produced identical bytes
+    std::vector<ShaderOutput> outputs;
+    // Per output, index into PermutationResult::blobs or kNoBlob when empty
+    std::vector<uint32_t> blobIndices;
+    std::string error;
+
+    bool succeeded() const { return error.empty(); }
+};
+
+struct PermutationResult
+{
+    std::vector<PermutationVariant> variants; // Last axis varies fastest
+    std::vector<Slang::ComPtr<slang::IBlob>> blobs; // Unique by content
+    size_t parses = 0; // One per distinct macro combination
+    size_t links = 0;  // One per distinct macro and type argument combination
+    size_t totalBytes = 0;  // Sum over every variant's outputs
+    size_t uniqueBytes = 0; // Sum over blobs
+    size_t failedVariants = 0;
+
+    bool succeeded() const { return failedVariants == 0; }
+    const PermutationVariant* find(uint64_t hash) const;
+};
+
+class PermutationCompiler
+{
+public:
+    explicit PermutationCompiler(CompilerPool& pool) : m_pool(pool) {}
+
+    // Compiles every variant; failures are reported per variant, never thrown.
+    // Throws if an axis has no values.
+    PermutationResult compile(const PermutationRequest& request);
+
+    // Variants with their axis values filled in but nothing compiled
+    static std::vector<PermutationVariant> enumerate(const PermutationRequest& request);
+
+private:
+    CompilerPool& m_pool;
+};
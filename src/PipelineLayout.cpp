@@ -0,0 +1,453 @@
+#include "PipelineLayout.h"
+#include "Hash.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace
+{
+    using ResourceType = ShaderResourceBinding::ResourceType;
+
+    uint64_t hashValue(uint64_t hash, uint32_t value)
+    {
+        return fnv1a64(&value, sizeof(value), hash);
+    }
+
+    DescriptorType toDescriptorType(const ShaderResourceBinding& binding)
+    {
+        switch (binding.resourceType)
+        {
+        case ResourceType::ConstantBuffer: return DescriptorType::UniformBuffer;
+        case ResourceType::StructuredBuffer: return DescriptorType::StorageBuffer;
+        case ResourceType::TypedBuffer: return DescriptorType::UniformTexelBuffer;
+        case ResourceType::Texture: return DescriptorType::SampledImage;
+        case ResourceType::Sampler: return DescriptorType::Sampler;
+        case ResourceType::CombinedTextureSampler: return DescriptorType::CombinedImageSampler;
+        case ResourceType::AccelerationStructure: return DescriptorType::AccelerationStructure;
+        case ResourceType::UAV:
+            switch (binding.shape & SLANG_RESOURCE_BASE_SHAPE_MASK)
+            {
+            case SLANG_TEXTURE_BUFFER: return DescriptorType::StorageTexelBuffer;
+            case SLANG_TEXTURE_1D:
+            case SLANG_TEXTURE_2D:
+            case SLANG_TEXTURE_3D:
+            case SLANG_TEXTURE_CUBE: return DescriptorType::StorageImage;
+            default: return DescriptorType::StorageBuffer;
+            }
+        default:
+            return DescriptorType::UniformBuffer;
+        }
+    }
+
+    ShaderVisibility toVisibility(uint32_t slangStageMask)
+    {
+        switch (slangStageMask)
+        {
+        case 1u << SLANG_STAGE_VERTEX: return ShaderVisibility::Vertex;
+        case 1u << SLANG_STAGE_HULL: return ShaderVisibility::Hull;
+        case 1u << SLANG_STAGE_DOMAIN: return ShaderVisibility::Domain;
+        case 1u << SLANG_STAGE_GEOMETRY: return ShaderVisibility::Geometry;
+        case 1u << SLANG_STAGE_FRAGMENT: return ShaderVisibility::Pixel;
+        case 1u << SLANG_STAGE_AMPLIFICATION: return ShaderVisibility::Amplification;
+        case 1u << SLANG_STAGE_MESH: return ShaderVisibility::Mesh;
+        default: return ShaderVisibility::All;
+        }
+    }
+
+    // Both tables of one register space, plus the stages that see them
+    struct SpaceTables
+    {
+        std::vector<DescriptorRangeDesc> resources;
+        std::vector<DescriptorRangeDesc> samplers;
+        uint32_t resourceStages = 0;
+        uint32_t samplerStages = 0;
+    };
+
+    void addRange(std::vector<DescriptorRangeDesc>& ranges, DescriptorRangeType type,
+        const ShaderResourceBinding& binding)
+    {
+        // The same register can come from several entry points
+        uint32_t numDescriptors = binding.count == 0 ? DescriptorRangeDesc::kUnbounded : binding.count;
+        for (const DescriptorRangeDesc& range : ranges)
+        {
+            if (range.rangeType == type && range.baseShaderRegister == binding.binding)
+            {
+                if (range.numDescriptors != numDescriptors)
+                {
+                    throw std::runtime_error("Conflicting descriptor counts at space " + std::to_string(binding.set) +
+                        " register " + std::to_string(binding.binding) + " (" + std::string(binding.name) + ")");
+                }
+                return;
+            }
+        }
+        DescriptorRangeDesc range;
+        range.rangeType = type;
+        range.numDescriptors = numDescriptors;
+        range.baseShaderRegister = binding.binding;
+        range.registerSpace = binding.set;
+        ranges.push_back(range);
+    }
+
+    RootParameterDesc makeTable(std::vector<DescriptorRangeDesc> ranges, uint32_t stageMask)
+    {
+        // Unbounded ranges must come last so every other range has a fixed offset
+        std::stable_sort(ranges.begin(), ranges.end(), [](const DescriptorRangeDesc& a, const DescriptorRangeDesc& b)
+            {
+                bool unboundedA = a.numDescriptors == DescriptorRangeDesc::kUnbounded;
+                bool unboundedB = b.numDescriptors == DescriptorRangeDesc::kUnbounded;
+                return std::tie(unboundedA, a.rangeType, a.baseShaderRegister) <
+                    std::tie(unboundedB, b.rangeType, b.baseShaderRegister);
+            });
+        uint32_t offset = 0;
+        for (DescriptorRangeDesc& range : ranges)
+        {
+            range.offsetInDescriptorsFromTableStart = offset;
+            if (range.numDescriptors != DescriptorRangeDesc::kUnbounded)
+            {
+                offset += range.numDescriptors;
+            }
+        }
+
+        RootParameterDesc parameter;
+        parameter.parameterType = RootParameterType::DescriptorTable;
+        parameter.visibility = toVisibility(stageMask);
+        parameter.ranges = std::move(ranges);
+        return parameter;
+    }
+}
+
+uint32_t ToVulkanStageFlags(uint32_t slangStageMask)
+{
+    static const std::pair<SlangStage, uint32_t> kStages[] = {
+        { SLANG_STAGE_VERTEX, StageVertex },
+        { SLANG_STAGE_HULL, StageTessellationControl },
+        { SLANG_STAGE_DOMAIN, StageTessellationEvaluation },
+        { SLANG_STAGE_GEOMETRY, StageGeometry },
+        { SLANG_STAGE_FRAGMENT, StageFragment },
+        { SLANG_STAGE_COMPUTE, StageCompute },
+        { SLANG_STAGE_RAY_GENERATION, StageRayGen },
+        { SLANG_STAGE_INTERSECTION, StageIntersection },
+        { SLANG_STAGE_ANY_HIT, StageAnyHit },
+        { SLANG_STAGE_CLOSEST_HIT, StageClosestHit },
+        { SLANG_STAGE_MISS, StageMiss },
+        { SLANG_STAGE_CALLABLE, StageCallable },
+        { SLANG_STAGE_MESH, StageMesh },
+        { SLANG_STAGE_AMPLIFICATION, StageTask },
+    };
+    uint32_t flags = 0;
+    for (const auto& [stage, flag] : kStages)
+    {
+        if (slangStageMask & (1u << stage))
+        {
+            flags |= flag;
+        }
+    }
+    return flags;
+}
+
+VulkanPipelineLayoutDesc ToVulkanDescriptorSetLayout(const ReflectionTable& reflection)
+{
+    VulkanPipelineLayoutDesc layout;
+
+    for (const ShaderResourceBinding& binding : reflection.bindings())
+    {
+        uint32_t stageFlags = ToVulkanStageFlags(binding.stageMask);
+        if (binding.resourceType == ResourceType::PushConstant)
+        {
+            layout.pushConstants.push_back({ stageFlags, 0, binding.sizeInBytes });
+            continue;
+        }
+
+        if (binding.set >= layout.sets.size())
+        {
+            layout.sets.resize(binding.set + 1);
+        }
+        DescriptorBindingDesc desc;
+        desc.binding = binding.binding;
+        desc.descriptorType = toDescriptorType(binding);
+        desc.descriptorCount = binding.count;
+        desc.stageFlags = stageFlags;
+        desc.variableCount = binding.count == 0;
+
+        // A slot seen from several entry points merges only if it is the same descriptor
+        std::vector<DescriptorBindingDesc>& bindings = layout.sets[binding.set].bindings;
+        auto existing = std::find_if(bindings.begin(), bindings.end(),
+            [&binding](const DescriptorBindingDesc& other) { return other.binding == binding.binding; });
+        if (existing != bindings.end())
+        {
+            if (existing->descriptorType != desc.descriptorType || existing->descriptorCount != desc.descriptorCount)
+            {
+                throw std::runtime_error("Conflicting descriptors at set " + std::to_string(binding.set) + " binding " +
+                    std::to_string(binding.binding) + " (" + std::string(binding.name) +
+                    "); Vulkan layouts need SPIR-V or GLSL reflection");
+            }
+            existing->stageFlags |= stageFlags;
+            continue;
+        }
+        bindings.push_back(desc);
+    }
+
+    for (DescriptorSetLayoutDesc& set : layout.sets)
+    {
+        std::sort(set.bindings.begin(), set.bindings.end(),
+            [](const DescriptorBindingDesc& a, const DescriptorBindingDesc& b) { return a.binding < b.binding; });
+    }
+    std::sort(layout.pushConstants.begin(), layout.pushConstants.end(),
+        [](const PushConstantRangeDesc& a, const PushConstantRangeDesc& b)
+        {
+            return std::tie(a.offset, a.size, a.stageFlags) < std::tie(b.offset, b.size, b.stageFlags);
+        });
+    return layout;
+}
+
+RootSignatureDesc ToD3D12RootSignature(const ReflectionTable& reflection)
+{
+    RootSignatureDesc rootSignature;
+    std::map<uint32_t, SpaceTables> spaces;
+
+    for (const ShaderResourceBinding& binding : reflection.bindings())
+    {
+        if (binding.resourceType == ResourceType::PushConstant)
+        {
+            RootParameterDesc constants;
+            constants.parameterType = RootParameterType::Constants32Bit;
+            constants.visibility = toVisibility(binding.stageMask);
+            constants.shaderRegister = binding.binding;
+            constants.registerSpace = binding.set;
+            constants.num32BitValues = (binding.sizeInBytes + 3) / 4;
+            rootSignature.parameters.push_back(std::move(constants));
+            continue;
+        }
+
+        SpaceTables& tables = spaces[binding.set];
+        switch (binding.resourceType)
+        {
+        case ResourceType::ConstantBuffer:
+            addRange(tables.resources, DescriptorRangeType::CBV, binding);
+            tables.resourceStages |= binding.stageMask;
+            break;
+        case ResourceType::UAV:
+            addRange(tables.resources, DescriptorRangeType::UAV, binding);
+            tables.resourceStages |= binding.stageMask;
+            break;
+        case ResourceType::Sampler:
+            addRange(tables.samplers, DescriptorRangeType::Sampler, binding);
+            tables.samplerStages |= binding.stageMask;
+            break;
+        case ResourceType::CombinedTextureSampler:
+            addRange(tables.resources, DescriptorRangeType::SRV, binding);
+            addRange(tables.samplers, DescriptorRangeType::Sampler, binding);
+            tables.resourceStages |= binding.stageMask;
+            tables.samplerStages |= binding.stageMask;
+            break;
+        default:
+            addRange(tables.resources, DescriptorRangeType::SRV, binding);
+            tables.resourceStages |= binding.stageMask;
+            break;
+        }
+    }
+
+    std::sort(rootSignature.parameters.begin(), rootSignature.parameters.end(),
+        [](const RootParameterDesc& a, const RootParameterDesc& b)
+        {
+            return std::tie(a.registerSpace, a.shaderRegister) < std::tie(b.registerSpace, b.shaderRegister);
+        });
+
+    // Samplers live in their own descriptor heap, so they get separate tables
+    for (auto& [space, tables] : spaces)
+    {
+        if (!tables.resources.empty())
+        {
+            rootSignature.parameters.push_back(makeTable(std::move(tables.resources), tables.resourceStages));
+        }
+        if (!tables.samplers.empty())
+        {
+            rootSignature.parameters.push_back(makeTable(std::move(tables.samplers), tables.samplerStages));
+        }
+    }
+    return rootSignature;
+}
+
+uint64_t DescriptorSetLayoutDesc::hash() const
+{
+    uint64_t hash = hashValue(kFnv1aOffset, (uint32_t)bindings.size());
+    for (const DescriptorBindingDesc& binding : bindings)
+    {
+        hash = hashValue(hash, binding.binding);
+        hash = hashValue(hash, static_cast<uint32_t>(binding.descriptorType));
+        hash = hashValue(hash, binding.descriptorCount);
+        hash = hashValue(hash, binding.stageFlags);
+        hash = hashValue(hash, (uint32_t)binding.variableCount);
+    }
+    return hash;
+}
+
+uint64_t VulkanPipelineLayoutDesc::hash() const
+{
+    uint64_t hash = hashValue(kFnv1aOffset, (uint32_t)sets.size());
+    for (const DescriptorSetLayoutDesc& set : sets)
+    {
+        uint64_t setHash = set.hash();
+        hash = fnv1a64(&setHash, sizeof(setHash), hash);
+    }
+    hash = hashValue(hash, (uint32_t)pushConstants.size());
+    for (const PushConstantRangeDesc& range : pushConstants)
+    {
+        hash = hashValue(hash, range.stageFlags);
+        hash = hashValue(hash, range.offset);
+        hash = hashValue(hash, range.size);
+    }
+    return hash;
+}
+
+uint64_t RootSignatureDesc::hash() const
+{
+    uint64_t hash = hashValue(kFnv1aOffset, (uint32_t)parameters.size());
+    for (const RootParameterDesc& parameter : parameters)
+    {
+        hash = hashValue(hash, static_cast<uint32_t>(parameter.parameterType));
+        hash = hashValue(hash, static_cast<uint32_t>(parameter.visibility));
+        hash = hashValue(hash, parameter.shaderRegister);
+        hash = hashValue(hash, parameter.registerSpace);
+        hash = hashValue(hash, parameter.num32BitValues);
+        hash = hashValue(hash, (uint32_t)parameter.ranges.size());
+        for (const DescriptorRangeDesc& range : parameter.ranges)
+        {
+            hash = hashValue(hash, static_cast<uint32_t>(range.rangeType));
+            hash = hashValue(hash, range.numDescriptors);
+            hash = hashValue(hash, range.baseShaderRegister);
+            hash = hashValue(hash, range.registerSpace);
+            hash = hashValue(hash, range.offsetInDescriptorsFromTableStart);
+        }
+    }
+    return hash;
+}
+
+void VulkanPipelineLayoutDesc::serialize(BinaryWriter& writer) const
+{
+    writer.write((uint32_t)sets.size());
+    for (const DescriptorSetLayoutDesc& set : sets)
+    {
+        writer.write((uint32_t)set.bindings.size());
+        for (const DescriptorBindingDesc& binding : set.bindings)
+        {
+            writer.write(binding.binding);
+            writer.write(static_cast<uint32_t>(binding.descriptorType));
+            writer.write(binding.descriptorCount);
+            writer.write(binding.stageFlags);
+            writer.write((uint32_t)binding.variableCount);
+        }
+    }
+    writer.write((uint32_t)pushConstants.size());
+    for (const PushConstantRangeDesc& range : pushConstants)
+    {
+        writer.write(range.stageFlags);
+        writer.write(range.offset);
+        writer.write(range.size);
+    }
+}
+
+bool VulkanPipelineLayoutDesc::deserialize(BinaryReader& reader, VulkanPipelineLayoutDesc& layout)
+{
+    layout = {};
+    uint32_t setCount = 0;
+    if (!reader.read(setCount) || setCount > reader.remaining())
+    {
+        return false;
+    }
+    layout.sets.resize(setCount);
+    for (DescriptorSetLayoutDesc& set : layout.sets)
+    {
+        uint32_t bindingCount = 0;
+        if (!reader.read(bindingCount) || bindingCount > reader.remaining())
+        {
+            return false;
+        }
+        set.bindings.resize(bindingCount);
+        for (DescriptorBindingDesc& binding : set.bindings)
+        {
+            uint32_t descriptorType = 0, variableCount = 0;
+            if (!reader.read(binding.binding) || !reader.read(descriptorType) ||
+                !reader.read(binding.descriptorCount) || !reader.read(binding.stageFlags) || !reader.read(variableCount))
+            {
+                return false;
+            }
+            binding.descriptorType = static_cast<DescriptorType>(descriptorType);
+            binding.variableCount = variableCount != 0;
+        }
+    }
+
+    uint32_t rangeCount = 0;
+    if (!reader.read(rangeCount) || rangeCount > reader.remaining())
+    {
+        return false;
+    }
+    layout.pushConstants.resize(rangeCount);
+    for (PushConstantRangeDesc& range : layout.pushConstants)
+    {
+        if (!reader.read(range.stageFlags) || !reader.read(range.offset) || !reader.read(range.size))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RootSignatureDesc::serialize(BinaryWriter& writer) const
+{
+    writer.write((uint32_t)parameters.size());
+    for (const RootParameterDesc& parameter : parameters)
+    {
+        writer.write(static_cast<uint32_t>(parameter.parameterType));
+        writer.write(static_cast<uint32_t>(parameter.visibility));
+        writer.write(parameter.shaderRegister);
+        writer.write(parameter.registerSpace);
+        writer.write(parameter.num32BitValues);
+        writer.write((uint32_t)parameter.ranges.size());
+        for (const DescriptorRangeDesc& range : parameter.ranges)
+        {
+            writer.write(static_cast<uint32_t>(range.rangeType));
+            writer.write(range.numDescriptors);
+            writer.write(range.baseShaderRegister);
+            writer.write(range.registerSpace);
+            writer.write(range.offsetInDescriptorsFromTableStart);
+        }
+    }
+}
+
+bool RootSignatureDesc::deserialize(BinaryReader& reader, RootSignatureDesc& rootSignature)
+{
+    rootSignature = {};
+    uint32_t parameterCount = 0;
+    if (!reader.read(parameterCount) || parameterCount > reader.remaining())
+    {
+        return false;
+    }
+    rootSignature.parameters.resize(parameterCount);
+    for (RootParameterDesc& parameter : rootSignature.parameters)
+    {
+        uint32_t parameterType = 0, visibility = 0, rangeCount = 0;
+        if (!reader.read(parameterType) || !reader.read(visibility) || !reader.read(parameter.shaderRegister) ||
+            !reader.read(parameter.registerSpace) || !reader.read(parameter.num32BitValues) ||
+            !reader.read(rangeCount) || rangeCount > reader.remaining())
+        {
+            return false;
+        }
+        parameter.parameterType = static_cast<RootParameterType>(parameterType);
+        parameter.visibility = static_cast<ShaderVisibility>(visibility);
+        parameter.ranges.resize(rangeCount);
+        for (DescriptorRangeDesc& range : parameter.ranges)
+        {
+            uint32_t rangeType = 0;
+            if (!reader.read(rangeType) || !reader.read(range.numDescriptors) || !reader.read(range.baseShaderRegister) ||
+                !reader.read(range.registerSpace) || !reader.read(range.offsetInDescriptorsFromTableStart))
+            {
+                return false;
+            }
+            range.rangeType = static_cast<DescriptorRangeType>(rangeType);
+        }
+    }
+    return true;
+}
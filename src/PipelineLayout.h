@@ -0,0 +1,168 @@
+#pragma once
+// PipelineLayout.h
+// Ready-to-use pipeline layout descriptions derived from a ReflectionTable.
+// Enum values match the Vulkan and D3D12 headers so fields can be copied
+// straight into VkDescriptorSetLayoutBinding / D3D12_ROOT_PARAMETER1 without
+// either API being a dependency of the compiler.
+// Layouts are canonical: the same bindings produce the same description, and
+// so the same hash(), whatever order the shader declares them in.
+#include "BinaryStream.h"
+#include "ShaderReflection.h"
+#include <cstdint>
+#include <vector>
+
+// ----- Vulkan -----
+
+enum class DescriptorType : uint32_t // VkDescriptorType
+{
+    Sampler = 0,
+    CombinedImageSampler = 1,
+    SampledImage = 2,
+    StorageImage = 3,
+    UniformTexelBuffer = 4,
+    StorageTexelBuffer = 5,
+    UniformBuffer = 6,
+    StorageBuffer = 7,
+    AccelerationStructure = 1000150000,
+};
+
+enum ShaderStageFlagBits : uint32_t // VkShaderStageFlagBits
+{
+    StageVertex = 0x1,
+    StageTessellationControl = 0x2,
+    StageTessellationEvaluation = 0x4,
+    StageGeometry = 0x8,
+    StageFragment = 0x10,
+    StageCompute = 0x20,
+    StageTask = 0x40,
+    StageMesh = 0x80,
+    StageRayGen = 0x100,
+    StageAnyHit = 0x200,
+    StageClosestHit = 0x400,
+    StageMiss = 0x800,
+    StageIntersection = 0x1000,
+    StageCallable = 0x2000,
+};
+
+// Converts a (1 << SlangStage) mask as stored in the reflection table
+uint32_t ToVulkanStageFlags(uint32_t slangStageMask);
+
+struct DescriptorBindingDesc
+{
+    uint32_t binding = 0;
+    DescriptorType descriptorType = DescriptorType::UniformBuffer;
+    uint32_t descriptorCount = 1;
+    uint32_t stageFlags = 0;
+    bool variableCount = false; // Unbounded array: needs VARIABLE_DESCRIPTOR_COUNT
+
+    bool operator==(const DescriptorBindingDesc&) const = default;
+};
+
+struct DescriptorSetLayoutDesc
+{
+    std::vector<DescriptorBindingDesc> bindings; // Sorted by binding
+
+    // Over every field a VkDescriptorSetLayout is created from
+    uint64_t hash() const;
+    bool operator==(const DescriptorSetLayoutDesc&) const = default;
+};
+
+struct PushConstantRangeDesc
+{
+    uint32_t stageFlags = 0;
+    uint32_t offset = 0;
+    uint32_t size = 0;
+
+    bool operator==(const PushConstantRangeDesc&) const = default;
+};
+
+struct VulkanPipelineLayoutDesc
+{
+    // Indexed by set number; sets nothing binds to are left empty
+    std::vector<DescriptorSetLayoutDesc> sets;
+    std::vector<PushConstantRangeDesc> pushConstants; // Sorted by offset
+
+    uint64_t hash() const;
+    bool operator==(const VulkanPipelineLayoutDesc&) const = default;
+
+    void serialize(BinaryWriter& writer) const;
+    static bool deserialize(BinaryReader& reader, VulkanPipelineLayoutDesc& layout);
+};
+
+// Throws std::runtime_error if two different descriptors share a (set, binding),
+// as HLSL register classes do (b0, t0 and s0 are all binding 0)
+VulkanPipelineLayoutDesc ToVulkanDescriptorSetLayout(const ReflectionTable& reflection);
+
+// ----- D3D12 -----
+
+enum class DescriptorRangeType : uint32_t // D3D12_DESCRIPTOR_RANGE_TYPE
+{
+    SRV = 0,
+    UAV = 1,
+    CBV = 2,
+    Sampler = 3,
+};
+
+enum class RootParameterType : uint32_t // D3D12_ROOT_PARAMETER_TYPE
+{
+    DescriptorTable = 0,
+    Constants32Bit = 1,
+    CBV = 2,
+    SRV = 3,
+    UAV = 4,
+};
+
+enum class ShaderVisibility : uint32_t // D3D12_SHADER_VISIBILITY
+{
+    All = 0,
+    Vertex = 1,
+    Hull = 2,
+    Domain = 3,
+    Geometry = 4,
+    Pixel = 5,
+    Amplification = 6,
+    Mesh = 7,
+};
+
+struct DescriptorRangeDesc
+{
+    static constexpr uint32_t kUnbounded = 0xffffffffu;
+
+    DescriptorRangeType rangeType = DescriptorRangeType::SRV;
+    uint32_t numDescriptors = 1; // kUnbounded for unbounded arrays
+    uint32_t baseShaderRegister = 0;
+    uint32_t registerSpace = 0;
+    uint32_t offsetInDescriptorsFromTableStart = 0;
+
+    bool operator==(const DescriptorRangeDesc&) const = default;
+};
+
+struct RootParameterDesc
+{
+    RootParameterType parameterType = RootParameterType::DescriptorTable;
+    ShaderVisibility visibility = ShaderVisibility::All;
+    std::vector<DescriptorRangeDesc> ranges; // Descriptor tables only
+
+    // Root constants only
+    uint32_t shaderRegister = 0;
+    uint32_t registerSpace = 0;
+    uint32_t num32BitValues = 0;
+
+    bool operator==(const RootParameterDesc&) const = default;
+};
+
+struct RootSignatureDesc
+{
+    // Root constants first (by space and register), then one CBV/SRV/UAV table
+    // and one sampler table per space
+    std::vector<RootParameterDesc> parameters;
+
+    uint64_t hash() const;
+    bool operator==(const RootSignatureDesc&) const = default;
+
+    void serialize(BinaryWriter& writer) const;
+    static bool deserialize(BinaryReader& reader, RootSignatureDesc& rootSignature);
+};
+
+// Throws std::runtime_error if one register is declared with different array sizes
+RootSignatureDesc ToD3D12RootSignature(const ReflectionTable& reflection);
@@ -0,0 +1,147 @@
+#include "PipelineLayoutRegistry.h"
+#include "Hash.h"
+#include <mutex>
+#include <stdexcept>
+
+template <typename Desc>
+std::shared_ptr<const Desc> PipelineLayoutRegistry::internIn(Table<Desc>& table, uint64_t hash, Desc desc, bool& existed)
+{
+    // Almost every lookup is for a layout that already exists
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto found = table.find(hash);
+        if (found != table.end())
+        {
+            if (!(*found->second == desc))
+            {
+                throw std::runtime_error("Pipeline layout hash collision on " + toHex(hash));
+            }
+            existed = true;
+            return found->second;
+        }
+    }
+
+    auto interned = std::make_shared<const Desc>(std::move(desc));
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto [found, inserted] = table.emplace(hash, interned);
+    if (!inserted && !(*found->second == *interned))
+    {
+        throw std::runtime_error("Pipeline layout hash collision on " + toHex(hash));
+    }
+    existed = !inserted;
+    return found->second;
+}
+
+template <typename Desc>
+std::shared_ptr<const Desc> PipelineLayoutRegistry::findIn(const Table<Desc>& table, uint64_t hash) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto found = table.find(hash);
+    return found != table.end() ? found->second : nullptr;
+}
+
+bool PipelineLayoutRegistry::usesRootSignature(SlangCompileTarget target)
+{
+    switch (target)
+    {
+    case SLANG_HLSL:
+    case SLANG_DXBC:
+    case SLANG_DXBC_ASM:
+    case SLANG_DXIL:
+    case SLANG_DXIL_ASM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+PipelineLayoutHandle PipelineLayoutRegistry::intern(const ReflectionTable& reflection, SlangCompileTarget target)
+{
+    // HLSL register classes overlap in slot numbers, so each API only gets the reflection made for it
+    PipelineLayoutHandle handle;
+    bool existed = false;
+    if (usesRootSignature(target))
+    {
+        RootSignatureDesc rootSignature = ToD3D12RootSignature(reflection);
+        handle.rootSignatureHash = rootSignature.hash();
+        handle.rootSignature = internIn(m_rootSignatures, handle.rootSignatureHash, std::move(rootSignature), existed);
+    }
+    else
+    {
+        VulkanPipelineLayoutDesc vulkan = ToVulkanDescriptorSetLayout(reflection);
+        handle.sets.reserve(vulkan.sets.size());
+        handle.setHashes.reserve(vulkan.sets.size());
+        for (const DescriptorSetLayoutDesc& set : vulkan.sets)
+        {
+            uint64_t hash = set.hash();
+            bool setExisted = false;
+            handle.sets.push_back(internIn(m_sets, hash, set, setExisted));
+            handle.setHashes.push_back(hash);
+        }
+        handle.vulkanHash = vulkan.hash();
+        handle.vulkan = internIn(m_vulkan, handle.vulkanHash, std::move(vulkan), existed);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    ++m_lookups;
+    m_hits += existed ? 1 : 0;
+    return handle;
+}
+
+std::shared_ptr<const VulkanPipelineLayoutDesc> PipelineLayoutRegistry::internVulkan(VulkanPipelineLayoutDesc layout)
+{
+    bool existed = false;
+    uint64_t hash = layout.hash();
+    return internIn(m_vulkan, hash, std::move(layout), existed);
+}
+
+std::shared_ptr<const DescriptorSetLayoutDesc> PipelineLayoutRegistry::internSet(DescriptorSetLayoutDesc set)
+{
+    bool existed = false;
+    uint64_t hash = set.hash();
+    return internIn(m_sets, hash, std::move(set), existed);
+}
+
+std::shared_ptr<const RootSignatureDesc> PipelineLayoutRegistry::internRootSignature(RootSignatureDesc rootSignature)
+{
+    bool existed = false;
+    uint64_t hash = rootSignature.hash();
+    return internIn(m_rootSignatures, hash, std::move(rootSignature), existed);
+}
+
+std::shared_ptr<const VulkanPipelineLayoutDesc> PipelineLayoutRegistry::findVulkan(uint64_t hash) const
+{
+    return findIn(m_vulkan, hash);
+}
+
+std::shared_ptr<const DescriptorSetLayoutDesc> PipelineLayoutRegistry::findSet(uint64_t hash) const
+{
+    return findIn(m_sets, hash);
+}
+
+std::shared_ptr<const RootSignatureDesc> PipelineLayoutRegistry::findRootSignature(uint64_t hash) const
+{
+    return findIn(m_rootSignatures, hash);
+}
+
+void PipelineLayoutRegistry::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_vulkan.clear();
+    m_sets.clear();
+    m_rootSignatures.clear();
+    m_lookups = 0;
+    m_hits = 0;
+}
+
+PipelineLayoutRegistry::Stats PipelineLayoutRegistry::stats() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    Stats stats;
+    stats.lookups = m_lookups;
+    stats.hits = m_hits;
+    stats.vulkanLayouts = m_vulkan.size();
+    stats.setLayouts = m_sets.size();
+    stats.rootSignatures = m_rootSignatures.size();
+    return stats;
+}
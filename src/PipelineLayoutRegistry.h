@@ -0,0 +1,77 @@
+#pragma once
+// PipelineLayoutRegistry.h
+// Interns pipeline layouts by hash so shaders with the same bindings share one
+// immutable description. A renderer can key its VkDescriptorSetLayout,
+// VkPipelineLayout and ID3D12RootSignature caches on the hashes and create each
+// object once, however many shaders use it. Every method is thread-safe.
+#include "PipelineLayout.h"
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+// The interned layout of one shader: the Vulkan side for SPIR-V and GLSL targets,
+// the root signature for D3D targets; the other side is left empty.
+// Pointers compare equal exactly when the layouts do.
+struct PipelineLayoutHandle
+{
+    std::shared_ptr<const VulkanPipelineLayoutDesc> vulkan;
+    uint64_t vulkanHash = 0;
+    // Interned per set, so a set shared by otherwise different layouts is one object.
+    // Indexed like vulkan->sets.
+    std::vector<std::shared_ptr<const DescriptorSetLayoutDesc>> sets;
+    std::vector<uint64_t> setHashes;
+
+    std::shared_ptr<const RootSignatureDesc> rootSignature;
+    uint64_t rootSignatureHash = 0;
+};
+
+class PipelineLayoutRegistry
+{
+public:
+    struct Stats
+    {
+        uint64_t lookups = 0;
+        uint64_t hits = 0;    // Lookups whose layout was already interned
+        size_t vulkanLayouts = 0;
+        size_t setLayouts = 0;
+        size_t rootSignatures = 0;
+    };
+
+    // Builds the target's layout from its reflection and returns the interned copy.
+    // Throws std::runtime_error if the reflection does not fit the target's API (see
+    // PipelineLayout.h) or if two different layouts hash the same, since callers
+    // rely on the hash alone to identify a layout.
+    PipelineLayoutHandle intern(const ReflectionTable& reflection, SlangCompileTarget target);
+
+    static bool usesRootSignature(SlangCompileTarget target);
+
+    std::shared_ptr<const VulkanPipelineLayoutDesc> internVulkan(VulkanPipelineLayoutDesc layout);
+    std::shared_ptr<const DescriptorSetLayoutDesc> internSet(DescriptorSetLayoutDesc set);
+    std::shared_ptr<const RootSignatureDesc> internRootSignature(RootSignatureDesc rootSignature);
+
+    // nullptr if nothing with the hash was interned
+    std::shared_ptr<const VulkanPipelineLayoutDesc> findVulkan(uint64_t hash) const;
+    std::shared_ptr<const DescriptorSetLayoutDesc> findSet(uint64_t hash) const;
+    std::shared_ptr<const RootSignatureDesc> findRootSignature(uint64_t hash) const;
+
+    void clear();
+    Stats stats() const;
+
+private:
+    template <typename Desc>
+    using Table = std::unordered_map<uint64_t, std::shared_ptr<const Desc>>;
+
+    mutable std::shared_mutex m_mutex;
+    Table<VulkanPipelineLayoutDesc> m_vulkan;
+    Table<DescriptorSetLayoutDesc> m_sets;
+    Table<RootSignatureDesc> m_rootSignatures;
+    uint64_t m_lookups = 0;
+    uint64_t m_hits = 0;
+
+    template <typename Desc>
+    std::shared_ptr<const Desc> internIn(Table<Desc>& table, uint64_t hash, Desc desc, bool& existed);
+    template <typename Desc>
+    std::shared_ptr<const Desc> findIn(const Table<Desc>& table, uint64_t hash) const;
+};
@@ -0,0 +1,171 @@
+#include "SessionPool.h"
+#include <algorithm>
+#include <stdexcept>
+
+SessionPool::SessionPool(size_t maxSessions, size_t maxCompilesPerSession)
+    : m_maxSessions(maxSessions), m_maxCompilesPerSession(maxCompilesPerSession)
+{
+}
+
+std::shared_ptr<PooledSession> SessionPool::acquire(slang::IGlobalSession* globalSession,
+    const std::vector<SlangCompileTarget>& targets, const CompileOptions& options)
+{
+    std::string key = makeKey(targets, options);
+
+    auto found = m_index.find(key);
+    if (found != m_index.end())
+    {
+        auto entryIt = found->second;
+        // Recycle sessions that have accumulated too many loaded modules
+        if (entryIt->session->compileCount < m_maxCompilesPerSession)
+        {
+            ++m_stats.hits;
+            m_lru.splice(m_lru.begin(), m_lru, entryIt);
+            ++entryIt->session->compileCount;
+            return entryIt->session;
+        }
+        m_lru.erase(entryIt);
+        m_index.erase(found);
+        ++m_stats.evictions;
+    }
+
+    ++m_stats.misses;
+    std::shared_ptr<PooledSession> pooled = createSession(globalSession, targets, options);
+    ++pooled->compileCount;
+    m_lru.push_front(Entry{ key, pooled });
+    m_index[key] = m_lru.begin();
+    evictOverflow();
+    return pooled;
+}
+
+void SessionPool::setLimits(size_t maxSessions, size_t maxCompilesPerSession)
+{
+    m_maxSessions = maxSessions;
+    m_maxCompilesPerSession = maxCompilesPerSession;
+    evictOverflow();
+}
+
+void SessionPool::setFileSystem(Slang::ComPtr<ISlangFileSystem> fileSystem)
+{
+    if (fileSystem.get() != m_fileSystem.get())
+    {
+        clear();
+        m_fileSystem = std::move(fileSystem);
+    }
+}
+
+void SessionPool::discard(const std::shared_ptr<PooledSession>& session)
+{
+    auto it = std::find_if(m_lru.begin(), m_lru.end(),
+        [&session](const Entry& entry) { return entry.session == session; });
+    if (it != m_lru.end())
+    {
+        m_index.erase(it->key);
+        m_lru.erase(it);
+        ++m_stats.evictions;
+    }
+}
+
+void SessionPool::clear()
+{
+    m_stats.evictions += m_lru.size();
+    m_lru.clear();
+    m_index.clear();
+}
+
+SessionPool::Stats SessionPool::stats() const
+{
+    Stats stats = m_stats;
+    stats.liveSessions = m_lru.size();
+    for (const Entry& entry : m_lru)
+    {
+        stats.residentBytes += entry.session->residentBytes;
+    }
+    return stats;
+}
+
+std::string SessionPool::makeKey(const std::vector<SlangCompileTarget>& targets, const CompileOptions& options)
+{
+    // Fields are separated by '\0' so no two distinct configurations collide.
+    // Target order is part of the key since callers index outputs by target.
+    std::string key;
+    for (SlangCompileTarget target : targets)
+    {
+        key += std::to_string(static_cast<int>(target));
+        key += ',';
+    }
+    key += '\0';
+    key += options.profile;
+    key += '\0';
+    for (const auto& searchPath : options.searchPaths)
+    {
+        key += searchPath;
+        key += '\0';
+    }
+    key += '\0';
+
+    // Macro order does not change the configuration, except for repeated names
+    std::vector<ShaderMacro> macros = options.macros;
+    std::stable_sort(macros.begin(), macros.end(),
+        [](const ShaderMacro& a, const ShaderMacro& b) { return a.name < b.name; });
+    for (const auto& macro : macros)
+    {
+        key += macro.name;
+        key += '=';
+        key += macro.value;
+        key += '\0';
+    }
+    return key;
+}
+
+std::shared_ptr<PooledSession> SessionPool::createSession(slang::IGlobalSession* globalSession,
+    const std::vector<SlangCompileTarget>& targets, const CompileOptions& options)
+{
+    slang::SessionDesc sessionDesc{};
+    std::vector<slang::TargetDesc> targetDescs(targets.size());
+
+    SlangProfileID profile = globalSession->findProfile(options.profile.c_str());
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        targetDescs[i].format = targets[i];
+        targetDescs[i].profile = profile;
+    }
+
+    sessionDesc.targets = targetDescs.data();
+    sessionDesc.targetCount = (SlangInt)targetDescs.size();
+
+    std::vector<const char*> searchPaths;
+    for (const auto& searchPath : options.searchPaths)
+    {
+        searchPaths.push_back(searchPath.c_str());
+    }
+    sessionDesc.searchPaths = searchPaths.data();
+    sessionDesc.searchPathCount = (SlangInt)searchPaths.size();
+
+    std::vector<slang::PreprocessorMacroDesc> macros;
+    for (const auto& macro : options.macros)
+    {
+        macros.push_back({ macro.name.c_str(), macro.value.c_str() });
+    }
+    sessionDesc.preprocessorMacros = macros.data();
+    sessionDesc.preprocessorMacroCount = (SlangInt)macros.size();
+    sessionDesc.fileSystem = m_fileSystem.get();
+
+    auto pooled = std::make_shared<PooledSession>();
+    SlangResult result = globalSession->createSession(sessionDesc, pooled->session.writeRef());
+    if (SLANG_FAILED(result) || !pooled->session)
+    {
+        throw std::runtime_error("Failed to create Slang session");
+    }
+    return pooled;
+}
+
+void SessionPool::evictOverflow()
+{
+    while (m_lru.size() > m_maxSessions)
+    {
+        m_index.erase(m_lru.back().key);
+        m_lru.pop_back();
+        ++m_stats.evictions;
+    }
+}
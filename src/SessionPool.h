@@ -0,0 +1,89 @@
+#pragma once
+// SessionPool.h
+// Keeps warm slang::ISession objects alive between compiles, so modules that
+// were imported once (e.g. common.slang) are not parsed and checked again.
+// Not thread-safe: every SlangCompiler owns its own pool.
+#include "CompileOptions.h"
+#include "Hash.h"
+#include <slang.h>
+#include <slang-com-ptr.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct PooledSession
+{
+    Slang::ComPtr<slang::ISession> session;
+    // Modules loaded from source through this session, keyed by content name.
+    // The session owns the modules, so raw pointers stay valid while it lives.
+    std::unordered_map<std::string, slang::IModule*> modules;
+    // Imported modules preloaded by a ModuleCache: module name -> cache key
+    std::unordered_map<std::string, std::string> importedModules;
+    // Content of each imported file when the session last compiled against it, by
+    // path. Slang never reloads an import, so an edited one needs a fresh session.
+    std::unordered_map<std::string, Sha256::Digest> importHashes;
+    size_t compileCount = 0;
+    // RSS retained by the jobs that ran on this session; an estimate of its footprint
+    size_t residentBytes = 0;
+
+    slang::IModule* findModule(const std::string& name) const
+    {
+        auto it = modules.find(name);
+        return it != modules.end() ? it->second : nullptr;
+    }
+};
+
+class SessionPool
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t liveSessions = 0;
+        size_t residentBytes = 0; // Sum over live sessions
+    };
+
+    // maxSessions bounds the number of distinct warm configurations (LRU evicted).
+    // maxCompilesPerSession recycles a session after that many compiles, since
+    // every module loaded into it stays resident until the session dies.
+    explicit SessionPool(size_t maxSessions = 8, size_t maxCompilesPerSession = 256);
+
+    // Returns a warm session for (targets, profile, search paths, macros),
+    // creating one on a miss. Throws if Slang refuses to create the session.
+    std::shared_ptr<PooledSession> acquire(slang::IGlobalSession* globalSession,
+        const std::vector<SlangCompileTarget>& targets, const CompileOptions& options);
+
+    void setLimits(size_t maxSessions, size_t maxCompilesPerSession);
+    // File system new sessions read source through; null uses Slang's default.
+    // Changing it drops the warm sessions, which resolved imports through the old one.
+    void setFileSystem(Slang::ComPtr<ISlangFileSystem> fileSystem);
+    // Drops one session so the next acquire for its configuration starts fresh
+    void discard(const std::shared_ptr<PooledSession>& session);
+    void clear();
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        std::string key;
+        std::shared_ptr<PooledSession> session;
+    };
+
+    size_t m_maxSessions;
+    size_t m_maxCompilesPerSession;
+    Slang::ComPtr<ISlangFileSystem> m_fileSystem;
+    // Front is most recently used.
+    std::list<Entry> m_lru;
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+    Stats m_stats;
+
+    static std::string makeKey(const std::vector<SlangCompileTarget>& targets, const CompileOptions& options);
+    std::shared_ptr<PooledSession> createSession(slang::IGlobalSession* globalSession,
+        const std::vector<SlangCompileTarget>& targets, const CompileOptions& options);
+    void evictOverflow();
+};
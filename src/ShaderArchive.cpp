@@ -0,0 +1,521 @@
+#include "ShaderArchive.h"
+#include "AtomicFile.h"
+#include "Hash.h"
+#include "PermutationCompiler.h"
+#include "ShaderBlob.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <numeric>
+#include <tuple>
+
+namespace
+{
+    constexpr uint32_t kEndianTag = 0x01020304;
+
+    static_assert(sizeof(ArchiveHeader) == 56);
+    static_assert(sizeof(ArchiveEntry) == 80);
+    static_assert(sizeof(ArchiveReflectionHeader) == 16);
+
+    auto hashKey(const ArchiveEntry& entry)
+    {
+        return std::make_tuple(entry.moduleHash, entry.entryPointHash, entry.target, entry.permutationHash);
+    }
+
+    bool inRange(uint64_t offset, uint64_t size, uint64_t limit)
+    {
+        return offset <= limit && size <= limit - offset;
+    }
+
+    // Appends a name to the pool; returns (offset, size)
+    std::pair<uint32_t, uint32_t> appendName(std::vector<char>& names, std::string_view name)
+    {
+        uint32_t offset = (uint32_t)names.size();
+        names.insert(names.end(), name.begin(), name.end());
+        return { offset, (uint32_t)name.size() };
+    }
+
+    size_t tableSize(const ArchiveReflectionHeader& header)
+    {
+        return sizeof(ArchiveReflectionHeader)
+            + (size_t)header.bindingCount * (sizeof(ArchiveBinding) + sizeof(uint32_t))
+            + (size_t)header.vertexInputCount * sizeof(ArchiveVertexInput)
+            + (size_t)header.entryPointCount * sizeof(ArchiveEntryPoint)
+            + header.namesSize;
+    }
+}
+
+// ----- ArchiveReflectionView -----
+
+ArchiveReflectionView::ArchiveReflectionView(const uint8_t* table)
+{
+    m_header = reinterpret_cast<const ArchiveReflectionHeader*>(table);
+    const uint8_t* cursor = table + sizeof(ArchiveReflectionHeader);
+    m_bindings = reinterpret_cast<const ArchiveBinding*>(cursor);
+    cursor += m_header->bindingCount * sizeof(ArchiveBinding);
+    m_byName = reinterpret_cast<const uint32_t*>(cursor);
+    cursor += m_header->bindingCount * sizeof(uint32_t);
+    m_vertexInputs = reinterpret_cast<const ArchiveVertexInput*>(cursor);
+    cursor += m_header->vertexInputCount * sizeof(ArchiveVertexInput);
+    m_entryPoints = reinterpret_cast<const ArchiveEntryPoint*>(cursor);
+    cursor += m_header->entryPointCount * sizeof(ArchiveEntryPoint);
+    m_names = reinterpret_cast<const char*>(cursor);
+}
+
+std::span<const ArchiveVertexInput> ArchiveReflectionView::vertexInputs() const
+{
+    if (!m_header) return {};
+    return { m_vertexInputs, m_header->vertexInputCount };
+}
+
+std::span<const ArchiveEntryPoint> ArchiveReflectionView::entryPoints() const
+{
+    if (!m_header) return {};
+    return { m_entryPoints, m_header->entryPointCount };
+}
+
+const ArchiveBinding* ArchiveReflectionView::findByName(std::string_view name) const
+{
+    const uint32_t* begin = m_byName;
+    const uint32_t* end = m_byName + bindingCount();
+    const uint32_t* found = std::lower_bound(begin, end, name, [this](uint32_t index, std::string_view key)
+    {
+        const ArchiveBinding& binding = m_bindings[index];
+        return this->name(binding.nameOffset, binding.nameSize) < key;
+    });
+    if (found == end) return nullptr;
+    const ArchiveBinding& binding = m_bindings[*found];
+    return this->name(binding.nameOffset, binding.nameSize) == name ? &binding : nullptr;
+}
+
+std::shared_ptr<const ReflectionTable> ArchiveReflectionView::toTable() const
+{
+    if (!m_header) return nullptr;
+
+    ReflectionTable::Builder builder;
+    for (const ArchiveBinding& flat : bindings())
+    {
+        ShaderResourceBinding binding{};
+        binding.resourceType = static_cast<ShaderResourceBinding::ResourceType>(flat.resourceType);
+        binding.binding = flat.binding;
+        binding.set = flat.set;
+        binding.count = flat.count;
+        binding.name = name(flat.nameOffset, flat.nameSize);
+        binding.shape = static_cast<SlangResourceShape>(flat.shape);
+        binding.access = static_cast<SlangResourceAccess>(flat.access);
+        binding.sizeInBytes = flat.sizeInBytes;
+        binding.stageMask = flat.stageMask;
+        builder.add(binding);
+    }
+    for (const ArchiveVertexInput& flat : vertexInputs())
+    {
+        VertexInputAttribute attribute;
+        attribute.name = name(flat.nameOffset, flat.nameSize);
+        attribute.semanticName = name(flat.semanticNameOffset, flat.semanticNameSize);
+        attribute.semanticIndex = flat.semanticIndex;
+        attribute.location = flat.location;
+        attribute.scalarType = flat.scalarType;
+        attribute.componentCount = flat.componentCount;
+        builder.addVertexInput(attribute);
+    }
+    for (const ArchiveEntryPoint& flat : entryPoints())
+    {
+        EntryPointInfo entryPoint;
+        entryPoint.name = name(flat.nameOffset, flat.nameSize);
+        entryPoint.stage = static_cast<SlangStage>(flat.stage);
+        std::copy(std::begin(flat.threadGroupSize), std::end(flat.threadGroupSize), entryPoint.threadGroupSize);
+        builder.addEntryPoint(entryPoint);
+    }
+    return builder.build();
+}
+
+size_t ArchiveReflectionView::flatSize(const ReflectionTable& table)
+{
+    ArchiveReflectionHeader header{};
+    header.bindingCount = (uint32_t)table.bindings().size();
+    header.vertexInputCount = (uint32_t)table.vertexInputs().size();
+    header.entryPointCount = (uint32_t)table.entryPoints().size();
+    for (const auto& binding : table.bindings())
+    {
+        header.namesSize += (uint32_t)binding.name.size();
+    }
+    for (const auto& attribute : table.vertexInputs())
+    {
+        header.namesSize += (uint32_t)(attribute.name.size() + attribute.semanticName.size());
+    }
+    for (const auto& entryPoint : table.entryPoints())
+    {
+        header.namesSize += (uint32_t)entryPoint.name.size();
+    }
+    return tableSize(header);
+}
+
+void ArchiveReflectionView::write(const ReflectionTable& table, BinaryWriter& writer)
+{
+    std::span<const ShaderResourceBinding> bindings = table.bindings();
+    std::vector<char> names;
+
+    std::vector<ArchiveBinding> flatBindings;
+    flatBindings.reserve(bindings.size());
+    for (const auto& binding : bindings)
+    {
+        auto [nameOffset, nameSize] = appendName(names, binding.name);
+        flatBindings.push_back({ (uint32_t)binding.resourceType, binding.binding, binding.set, binding.count,
+            (uint32_t)binding.shape, (uint32_t)binding.access, binding.sizeInBytes, binding.stageMask,
+            nameOffset, nameSize });
+    }
+    std::vector<uint32_t> byName(bindings.size());
+    std::iota(byName.begin(), byName.end(), 0u);
+    std::stable_sort(byName.begin(), byName.end(),
+        [&](uint32_t a, uint32_t b) { return bindings[a].name < bindings[b].name; });
+
+    std::vector<ArchiveVertexInput> flatInputs;
+    for (const auto& attribute : table.vertexInputs())
+    {
+        auto [nameOffset, nameSize] = appendName(names, attribute.name);
+        auto [semanticOffset, semanticSize] = appendName(names, attribute.semanticName);
+        flatInputs.push_back({ nameOffset, nameSize, semanticOffset, semanticSize,
+            attribute.semanticIndex, attribute.location, attribute.scalarType, attribute.componentCount });
+    }
+
+    std::vector<ArchiveEntryPoint> flatEntryPoints;
+    for (const auto& entryPoint : table.entryPoints())
+    {
+        auto [nameOffset, nameSize] = appendName(names, entryPoint.name);
+        flatEntryPoints.push_back({ nameOffset, nameSize, (uint32_t)entryPoint.stage,
+            { entryPoint.threadGroupSize[0], entryPoint.threadGroupSize[1], entryPoint.threadGroupSize[2] } });
+    }
+
+    writer.write(ArchiveReflectionHeader{ (uint32_t)flatBindings.size(), (uint32_t)flatInputs.size(),
+        (uint32_t)flatEntryPoints.size(), (uint32_t)names.size() });
+    writer.write(flatBindings.data(), flatBindings.size() * sizeof(ArchiveBinding));
+    writer.write(byName.data(), byName.size() * sizeof(uint32_t));
+    writer.write(flatInputs.data(), flatInputs.size() * sizeof(ArchiveVertexInput));
+    writer.write(flatEntryPoints.data(), flatEntryPoints.size() * sizeof(ArchiveEntryPoint));
+    writer.write(names.data(), names.size());
+}
+
+bool ArchiveReflectionView::validate(std::span<const uint8_t> table)
+{
+    if (table.size() < sizeof(ArchiveReflectionHeader)) return false;
+    ArchiveReflectionHeader header;
+    std::memcpy(&header, table.data(), sizeof(header));
+    if (tableSize(header) != table.size()) return false;
+
+    ArchiveReflectionView view(table.data());
+    auto nameFits = [&](uint32_t offset, uint32_t size) { return inRange(offset, size, header.namesSize); };
+    for (const ArchiveBinding& binding : view.bindings())
+    {
+        if (!nameFits(binding.nameOffset, binding.nameSize)) return false;
+    }
+    for (uint32_t i = 0; i < header.bindingCount; ++i)
+    {
+        if (view.m_byName[i] >= header.bindingCount) return false;
+    }
+    for (const ArchiveVertexInput& attribute : view.vertexInputs())
+    {
+        if (!nameFits(attribute.nameOffset, attribute.nameSize) ||
+            !nameFits(attribute.semanticNameOffset, attribute.semanticNameSize)) return false;
+    }
+    for (const ArchiveEntryPoint& entryPoint : view.entryPoints())
+    {
+        if (!nameFits(entryPoint.nameOffset, entryPoint.nameSize)) return false;
+    }
+    return true;
+}
+
+// ----- ShaderArchive -----
+
+std::shared_ptr<const ShaderArchive> ShaderArchive::open(const std::filesystem::path& path)
+{
+    auto file = std::make_shared<MappedFile>(path);
+    std::span<const uint8_t> bytes = file->bytes();
+    return std::shared_ptr<const ShaderArchive>(new ShaderArchive(std::move(file), bytes));
+}
+
+std::shared_ptr<const ShaderArchive> ShaderArchive::fromBytes(std::vector<uint8_t> bytes)
+{
+    auto owned = std::make_shared<std::vector<uint8_t>>(std::move(bytes));
+    std::span<const uint8_t> view = *owned;
+    return std::shared_ptr<const ShaderArchive>(new ShaderArchive(std::move(owned), view));
+}
+
+ShaderArchive::ShaderArchive(std::shared_ptr<const void> owner, std::span<const uint8_t> bytes)
+    : m_owner(std::move(owner)), m_bytes(bytes)
+{
+    ArchiveHeader header{};
+    if (bytes.size() < sizeof(header))
+    {
+        throw std::runtime_error("Shader archive is truncated");
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, kShaderArchiveMagic, sizeof(header.magic)) != 0)
+    {
+        throw std::runtime_error("Not a shader archive");
+    }
+    if (header.version != kShaderArchiveVersion || header.endianTag != kEndianTag)
+    {
+        throw std::runtime_error("Shader archive was written by an incompatible version or platform");
+    }
+    uint64_t limit = bytes.size();
+    if (header.fileSize != limit ||
+        header.indexOffset % alignof(ArchiveEntry) != 0 ||
+        !inRange(header.indexOffset, (uint64_t)header.entryCount * sizeof(ArchiveEntry), limit) ||
+        !inRange(header.stringsOffset, header.stringsSize, limit))
+    {
+        throw std::runtime_error("Shader archive is truncated or corrupt");
+    }
+
+    m_entries = { reinterpret_cast<const ArchiveEntry*>(bytes.data() + header.indexOffset), header.entryCount };
+    m_strings = reinterpret_cast<const char*>(bytes.data() + header.stringsOffset);
+
+    // Checked once here so lookups never need to
+    for (const ArchiveEntry& entry : m_entries)
+    {
+        bool valid = inRange(entry.moduleNameOffset, entry.moduleNameSize, header.stringsSize) &&
+            inRange(entry.entryPointNameOffset, entry.entryPointNameSize, header.stringsSize) &&
+            entry.codeOffset % kShaderArchiveCodeAlignment == 0 &&
+            inRange(entry.codeOffset, entry.codeSize, limit);
+        if (valid && entry.codeEncoding == (uint32_t)ArchiveCodeEncoding::EncodedSpirv)
+        {
+            valid = decodedSpirvSize(bytes.subspan(entry.codeOffset, entry.codeSize)) == entry.decodedSize;
+        }
+        else if (valid)
+        {
+            valid = entry.codeEncoding == (uint32_t)ArchiveCodeEncoding::None && entry.decodedSize == entry.codeSize;
+        }
+        if (valid && entry.reflectionSize > 0)
+        {
+            valid = entry.reflectionOffset % alignof(ArchiveBinding) == 0 &&
+                inRange(entry.reflectionOffset, entry.reflectionSize, limit) &&
+                ArchiveReflectionView::validate(bytes.subspan(entry.reflectionOffset, entry.reflectionSize));
+        }
+        if (!valid)
+        {
+            throw std::runtime_error("Shader archive is truncated or corrupt");
+        }
+    }
+}
+
+std::optional<ArchiveShader> ShaderArchive::find(const ArchiveKey& key) const
+{
+    auto wanted = std::make_tuple(fnv1a64(key.module), fnv1a64(key.entryPoint),
+        (uint32_t)key.target, key.permutationHash);
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), wanted,
+        [](const ArchiveEntry& entry, const auto& value) { return hashKey(entry) < value; });
+
+    // Hash collisions sort next to each other; the names decide
+    for (; it != m_entries.end() && hashKey(*it) == wanted; ++it)
+    {
+        ArchiveShader candidate = shader((size_t)(it - m_entries.begin()));
+        if (candidate.module == key.module && candidate.entryPoint == key.entryPoint)
+        {
+            return candidate;
+        }
+    }
+    return std::nullopt;
+}
+
+ArchiveShader ShaderArchive::shader(size_t index) const
+{
+    const ArchiveEntry& entry = m_entries[index];
+    ArchiveShader shader;
+    shader.module = { m_strings + entry.moduleNameOffset, entry.moduleNameSize };
+    shader.entryPoint = { m_strings + entry.entryPointNameOffset, entry.entryPointNameSize };
+    shader.target = static_cast<SlangCompileTarget>(entry.target);
+    shader.permutationHash = entry.permutationHash;
+    shader.code = m_bytes.subspan(entry.codeOffset, entry.codeSize);
+    shader.encoding = static_cast<ArchiveCodeEncoding>(entry.codeEncoding);
+    shader.decodedSize = entry.decodedSize;
+    if (entry.reflectionSize > 0)
+    {
+        shader.reflection = ArchiveReflectionView(m_bytes.data() + entry.reflectionOffset);
+    }
+    return shader;
+}
+
+ShaderOutput ShaderArchive::toOutput(const ArchiveShader& shader) const
+{
+    ShaderOutput output;
+    output.target = shader.target;
+    output.entryPointName = std::string(shader.entryPoint);
+    if (shader.encoding == ArchiveCodeEncoding::EncodedSpirv)
+    {
+        std::vector<uint8_t> code(shader.decodedSize);
+        decodeSpirv(shader.code, { reinterpret_cast<uint32_t*>(code.data()), code.size() / 4 });
+        output.codeBlob = createBlob(std::move(code));
+    }
+    else
+    {
+        output.codeBlob = createBlobView(m_owner, shader.code.data(), shader.code.size());
+    }
+    output.reflection = shader.reflection.toTable();
+    return output;
+}
+
+// ----- ShaderArchiveWriter -----
+
+void ShaderArchiveWriter::add(std::string_view module, const ShaderOutput& output, uint64_t permutationHash)
+{
+    if (output.empty())
+    {
+        return;
+    }
+    m_shaders.push_back({ std::string(module), output.entryPointName, output.target, permutationHash,
+        output.codeBlob, output.reflection });
+}
+
+void ShaderArchiveWriter::add(std::string_view module, const std::vector<ShaderOutput>& outputs, uint64_t permutationHash)
+{
+    for (const auto& output : outputs)
+    {
+        add(module, output, permutationHash);
+    }
+}
+
+void ShaderArchiveWriter::add(std::string_view module, const PermutationResult& permutations)
+{
+    for (const auto& variant : permutations.variants)
+    {
+        if (variant.succeeded())
+        {
+            add(module, variant.outputs, variant.hash);
+        }
+    }
+}
+
+std::vector<uint8_t> ShaderArchiveWriter::build() const
+{
+    // Index entries with everything but the section offsets filled in
+    std::vector<char> strings;
+    std::map<std::string_view, std::pair<uint32_t, uint32_t>> interned;
+    auto intern = [&](std::string_view name)
+    {
+        auto [it, isNew] = interned.try_emplace(name);
+        if (isNew)
+        {
+            it->second = appendName(strings, name);
+        }
+        return it->second;
+    };
+    std::vector<ArchiveEntry> entries(m_shaders.size());
+    for (size_t i = 0; i < m_shaders.size(); ++i)
+    {
+        const Pending& shader = m_shaders[i];
+        ArchiveEntry& entry = entries[i];
+        entry.moduleHash = fnv1a64(shader.module);
+        entry.entryPointHash = fnv1a64(shader.entryPoint);
+        entry.permutationHash = shader.permutationHash;
+        entry.target = (uint32_t)shader.target;
+        std::tie(entry.moduleNameOffset, entry.moduleNameSize) = intern(shader.module);
+        std::tie(entry.entryPointNameOffset, entry.entryPointNameSize) = intern(shader.entryPoint);
+    }
+
+    std::vector<uint32_t> order(m_shaders.size());
+    std::iota(order.begin(), order.end(), 0u);
+    auto fullKey = [&](uint32_t i)
+    {
+        return std::make_tuple(hashKey(entries[i]), std::string_view(m_shaders[i].module),
+            std::string_view(m_shaders[i].entryPoint));
+    };
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return fullKey(a) < fullKey(b); });
+    for (size_t i = 1; i < order.size(); ++i)
+    {
+        if (fullKey(order[i - 1]) == fullKey(order[i]))
+        {
+            const Pending& shader = m_shaders[order[i]];
+            throw std::runtime_error("Duplicate shader archive entry: " + shader.module + "/" + shader.entryPoint);
+        }
+    }
+
+    std::vector<uint8_t> buffer;
+    BinaryWriter writer(buffer);
+    ArchiveHeader header{};
+    std::memcpy(header.magic, kShaderArchiveMagic, sizeof(header.magic));
+    header.version = kShaderArchiveVersion;
+    header.endianTag = kEndianTag;
+    header.entryCount = (uint32_t)entries.size();
+    writer.write(header);
+
+    header.stringsOffset = writer.size();
+    header.stringsSize = strings.size();
+    writer.write(strings.data(), strings.size());
+
+    writer.align(alignof(ArchiveEntry));
+    header.indexOffset = writer.size();
+    writer.write(entries.data(), entries.size() * sizeof(ArchiveEntry)); // Rewritten below
+
+    // Shared reflection tables and identical code are written once
+    std::map<const ReflectionTable*, std::pair<uint64_t, uint32_t>> tableOffsets;
+    // Keyed by the code as added; values are (offset, stored size, encoding, decoded size)
+    std::map<std::pair<Sha256::Digest, bool>, std::tuple<uint64_t, uint64_t, uint32_t, uint32_t>> codeOffsets;
+    for (size_t i = 0; i < m_shaders.size(); ++i)
+    {
+        const Pending& shader = m_shaders[i];
+        ArchiveEntry& entry = entries[i];
+        if (shader.reflection)
+        {
+            auto [table, isNew] = tableOffsets.try_emplace(shader.reflection.get());
+            if (isNew)
+            {
+                writer.align(alignof(ArchiveBinding));
+                table->second = { writer.size(), (uint32_t)ArchiveReflectionView::flatSize(*shader.reflection) };
+                ArchiveReflectionView::write(*shader.reflection, writer);
+            }
+            std::tie(entry.reflectionOffset, entry.reflectionSize) = table->second;
+        }
+
+        const uint8_t* code = static_cast<const uint8_t*>(shader.code->getBufferPointer());
+        size_t codeSize = shader.code->getBufferSize();
+        bool encode = m_encodeSpirv && shader.target == SLANG_SPIRV;
+        Sha256 hasher;
+        hasher.update(code, codeSize);
+        auto [codeIt, isNew] = codeOffsets.try_emplace(std::make_pair(hasher.finish(), encode));
+        if (isNew)
+        {
+            std::vector<uint8_t> encoded;
+            ArchiveCodeEncoding encoding = ArchiveCodeEncoding::None;
+            if (encode)
+            {
+                // Anything that is not valid SPIR-V is stored as is
+                try
+                {
+                    encoded = encodeSpirv({ code, codeSize }, m_spirvOptions);
+                    encoding = ArchiveCodeEncoding::EncodedSpirv;
+                }
+                catch (const std::exception&)
+                {
+                }
+            }
+            size_t decodedSize = encoding == ArchiveCodeEncoding::EncodedSpirv ? decodedSpirvSize(encoded) : codeSize;
+            if (encoding == ArchiveCodeEncoding::EncodedSpirv)
+            {
+                code = encoded.data();
+                codeSize = encoded.size();
+            }
+            writer.align(kShaderArchiveCodeAlignment);
+            codeIt->second = { writer.size(), codeSize, (uint32_t)encoding, (uint32_t)decodedSize };
+            writer.write(code, codeSize);
+        }
+        std::tie(entry.codeOffset, entry.codeSize, entry.codeEncoding, entry.decodedSize) = codeIt->second;
+    }
+    writer.align(kShaderArchiveCodeAlignment);
+    header.fileSize = buffer.size();
+
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    uint8_t* index = buffer.data() + header.indexOffset;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        std::memcpy(index + i * sizeof(ArchiveEntry), &entries[order[i]], sizeof(ArchiveEntry));
+    }
+    return buffer;
+}
+
+void ShaderArchiveWriter::write(const std::filesystem::path& path) const
+{
+    std::vector<uint8_t> archive = build();
+    if (!writeFileAtomically(path, { archive }))
+    {
+        throw std::runtime_error("Failed to write shader archive: " + path.string());
+    }
+}
@@ -0,0 +1,229 @@
+#pragma once
+// ShaderArchive.h
+// Single-file package of compiled shaders for runtime startup. The index is
+// sorted by (module, entry point, target, permutation hash) hashes and binary
+// searched; code and reflection are aligned and read in place from the mapped
+// file, so a lookup is pointer arithmetic with no parsing or copying.
+// Identical code blobs and shared reflection tables are stored once.
+#include "MappedFile.h"
+#include "ShaderCompiler.h"
+#include "SpirvCodec.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PermutationResult;
+
+constexpr char kShaderArchiveMagic[8] = { 'S', 'L', 'A', 'N', 'G', 'A', 'R', 'C' };
+constexpr uint32_t kShaderArchiveVersion = 2;
+constexpr size_t kShaderArchiveCodeAlignment = 16;
+
+enum class ArchiveCodeEncoding : uint32_t
+{
+    None = 0,
+    EncodedSpirv = 1, // See SpirvCodec.h
+};
+
+// On-disk structures, host byte order. Offsets are from the start of the file.
+struct ArchiveHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag; // 0x01020304 as written by the producer
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t indexOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t fileSize;
+};
+
+struct ArchiveEntry
+{
+    uint64_t moduleHash;     // fnv1a64 of the module name
+    uint64_t entryPointHash; // fnv1a64 of the entry point name
+    uint64_t permutationHash;
+    uint32_t target;         // SlangCompileTarget
+    uint32_t reflectionSize; // 0 when the output has no reflection
+    uint32_t moduleNameOffset; // Into the string section
+    uint32_t moduleNameSize;
+    uint32_t entryPointNameOffset;
+    uint32_t entryPointNameSize;
+    uint64_t codeOffset;
+    uint64_t codeSize;       // As stored
+    uint64_t reflectionOffset;
+    uint32_t codeEncoding;   // ArchiveCodeEncoding
+    uint32_t decodedSize;    // codeSize when not encoded
+};
+
+// Flat reflection table: header, bindings, binding indices sorted by name,
+// vertex inputs, entry points, then the name pool. Names are offsets into the pool.
+struct ArchiveReflectionHeader
+{
+    uint32_t bindingCount;
+    uint32_t vertexInputCount;
+    uint32_t entryPointCount;
+    uint32_t namesSize;
+};
+
+struct ArchiveBinding
+{
+    uint32_t resourceType; // ShaderResourceBinding::ResourceType
+    uint32_t binding;
+    uint32_t set;
+    uint32_t count;
+    uint32_t shape;
+    uint32_t access;
+    uint32_t sizeInBytes;
+    uint32_t stageMask;
+    uint32_t nameOffset;
+    uint32_t nameSize;
+};
+
+struct ArchiveVertexInput
+{
+    uint32_t nameOffset;
+    uint32_t nameSize;
+    uint32_t semanticNameOffset;
+    uint32_t semanticNameSize;
+    uint32_t semanticIndex;
+    uint32_t location;
+    uint32_t scalarType;
+    uint32_t componentCount;
+};
+
+struct ArchiveEntryPoint
+{
+    uint32_t nameOffset;
+    uint32_t nameSize;
+    uint32_t stage; // SlangStage
+    uint32_t threadGroupSize[3];
+};
+
+// View of a flat reflection table inside an archive; valid while the archive lives
+class ArchiveReflectionView
+{
+public:
+    ArchiveReflectionView() = default;
+    explicit ArchiveReflectionView(const uint8_t* table);
+
+    bool empty() const { return m_header == nullptr; }
+
+    std::span<const ArchiveBinding> bindings() const { return { m_bindings, bindingCount() }; }
+    std::span<const ArchiveVertexInput> vertexInputs() const;
+    std::span<const ArchiveEntryPoint> entryPoints() const;
+    std::string_view name(uint32_t offset, uint32_t size) const { return { m_names + offset, size }; }
+
+    // Binary search over the sorted name index
+    const ArchiveBinding* findByName(std::string_view name) const;
+
+    // Owning copy, for code that works with ShaderOutput
+    std::shared_ptr<const ReflectionTable> toTable() const;
+
+    // Bytes needed for table, and the writer for it
+    static size_t flatSize(const ReflectionTable& table);
+    static void write(const ReflectionTable& table, BinaryWriter& writer);
+    // Bounds checks a whole table before it is viewed
+    static bool validate(std::span<const uint8_t> table);
+
+private:
+    const ArchiveReflectionHeader* m_header = nullptr;
+    const ArchiveBinding* m_bindings = nullptr;
+    const uint32_t* m_byName = nullptr;
+    const ArchiveVertexInput* m_vertexInputs = nullptr;
+    const ArchiveEntryPoint* m_entryPoints = nullptr;
+    const char* m_names = nullptr;
+
+    size_t bindingCount() const { return m_header ? m_header->bindingCount : 0; }
+};
+
+struct ArchiveKey
+{
+    std::string_view module;
+    std::string_view entryPoint;
+    SlangCompileTarget target = SLANG_SPIRV;
+    uint64_t permutationHash = 0;
+};
+
+struct ArchiveShader
+{
+    std::string_view module;
+    std::string_view entryPoint;
+    SlangCompileTarget target = SLANG_TARGET_UNKNOWN;
+    uint64_t permutationHash = 0;
+    std::span<const uint8_t> code; // Aligned to kShaderArchiveCodeAlignment
+    ArchiveReflectionView reflection;
+    // Encoded code is decoded with decodeSpirv() into a buffer of decodedSize bytes
+    ArchiveCodeEncoding encoding = ArchiveCodeEncoding::None;
+    size_t decodedSize = 0;
+};
+
+class ShaderArchive
+{
+public:
+    // Maps the file and checks the header and index bounds. Throws std::runtime_error
+    // if the file cannot be mapped, is truncated or is from another version.
+    static std::shared_ptr<const ShaderArchive> open(const std::filesystem::path& path);
+    // Same checks over archive bytes already in memory; keeps them alive
+    static std::shared_ptr<const ShaderArchive> fromBytes(std::vector<uint8_t> bytes);
+
+    std::optional<ArchiveShader> find(const ArchiveKey& key) const;
+
+    size_t size() const { return m_entries.size(); }
+    ArchiveShader shader(size_t index) const;
+
+    // Code blob is a view into the archive, or decoded when encoded; the reflection is copied
+    ShaderOutput toOutput(const ArchiveShader& shader) const;
+
+    std::span<const uint8_t> bytes() const { return m_bytes; }
+
+private:
+    std::shared_ptr<const void> m_owner; // MappedFile or byte vector
+    std::span<const uint8_t> m_bytes;
+    std::span<const ArchiveEntry> m_entries;
+    const char* m_strings = nullptr;
+
+    ShaderArchive(std::shared_ptr<const void> owner, std::span<const uint8_t> bytes);
+};
+
+class ShaderArchiveWriter
+{
+public:
+    // Outputs without code are skipped. A repeated key throws when the archive is built.
+    void add(std::string_view module, const ShaderOutput& output, uint64_t permutationHash = 0);
+    void add(std::string_view module, const std::vector<ShaderOutput>& outputs, uint64_t permutationHash = 0);
+    // Every successful variant, keyed by its permutation hash
+    void add(std::string_view module, const PermutationResult& permutations);
+
+    size_t size() const { return m_shaders.size(); }
+
+    // Stores SPIR-V outputs with encodeSpirv(); off by default
+    void setSpirvEncoding(bool enabled, const SpirvEncodeOptions& options = {})
+    {
+        m_encodeSpirv = enabled;
+        m_spirvOptions = options;
+    }
+
+    std::vector<uint8_t> build() const;
+    // Writes through a temporary file and an atomic rename. Throws on failure.
+    void write(const std::filesystem::path& path) const;
+
+private:
+    struct Pending
+    {
+        std::string module;
+        std::string entryPoint;
+        SlangCompileTarget target;
+        uint64_t permutationHash;
+        Slang::ComPtr<slang::IBlob> code;
+        std::shared_ptr<const ReflectionTable> reflection;
+    };
+    std::vector<Pending> m_shaders;
+    bool m_encodeSpirv = false;
+    SpirvEncodeOptions m_spirvOptions;
+};
@@ -0,0 +1,39 @@
+#include "ShaderBlob.h"
+
+SlangResult SharedBlob::queryInterface(SlangUUID const& uuid, void** outObject)
+{
+    if (uuid == ISlangUnknown::getTypeGuid() || uuid == ISlangBlob::getTypeGuid())
+    {
+        addRef();
+        *outObject = static_cast<ISlangBlob*>(this);
+        return SLANG_OK;
+    }
+    *outObject = nullptr;
+    return SLANG_E_NO_INTERFACE;
+}
+
+uint32_t SharedBlob::addRef()
+{
+    return m_refCount.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+uint32_t SharedBlob::release()
+{
+    uint32_t remaining = m_refCount.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    if (remaining == 0)
+    {
+        delete this;
+    }
+    return remaining;
+}
+
+Slang::ComPtr<slang::IBlob> createBlob(std::vector<uint8_t> data)
+{
+    auto owner = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+    return createBlobView(owner, owner->data(), owner->size());
+}
+
+Slang::ComPtr<slang::IBlob> createBlobView(std::shared_ptr<const void> owner, const void* data, size_t size)
+{
+    return Slang::ComPtr<slang::IBlob>(new SharedBlob(std::move(owner), data, size));
+}
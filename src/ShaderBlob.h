@@ -0,0 +1,37 @@
+#pragma once
+// ShaderBlob.h
+// ISlangBlob implementations for memory we own, so cached and mapped data can
+// travel through ShaderOutput exactly like code blobs returned by Slang.
+#include <slang.h>
+#include <slang-com-ptr.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class SharedBlob final : public ISlangBlob
+{
+public:
+    // owner keeps [data, data + size) alive for as long as the blob lives
+    SharedBlob(std::shared_ptr<const void> owner, const void* data, size_t size)
+        : m_owner(std::move(owner)), m_data(data), m_size(size) {}
+
+    SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const& uuid, void** outObject) override;
+    SLANG_NO_THROW uint32_t SLANG_MCALL addRef() override;
+    SLANG_NO_THROW uint32_t SLANG_MCALL release() override;
+
+    SLANG_NO_THROW void const* SLANG_MCALL getBufferPointer() override { return m_data; }
+    SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() override { return m_size; }
+
+private:
+    std::atomic<uint32_t> m_refCount{ 0 };
+    std::shared_ptr<const void> m_owner;
+    const void* m_data;
+    size_t m_size;
+};
+
+// Takes ownership of data without copying it
+Slang::ComPtr<slang::IBlob> createBlob(std::vector<uint8_t> data);
+
+// Wraps memory owned by someone else (e.g. a MappedFile) without copying it
+Slang::ComPtr<slang::IBlob> createBlobView(std::shared_ptr<const void> owner, const void* data, size_t size);
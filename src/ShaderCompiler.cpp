@@ -1,13 +1,51 @@
 #include "ShaderCompiler.h"
+#include "CompileTrace.h"
+#include "Hash.h"
+#include "ImportScanner.h"
+#include "LazyProgram.h"
+#include "ModuleCache.h"
+#include "ShaderBlob.h"
+#include "ShaderDiskCache.h"
+#include "ShaderMemoryCache.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+
+namespace
+{
+    std::mutex g_coreModuleCacheMutex;
+    std::filesystem::path g_coreModuleCache;
+}
+
+void SlangCompiler::setCoreModuleCache(const std::filesystem::path& directory)
+{
+    std::lock_guard<std::mutex> lock(g_coreModuleCacheMutex);
+    g_coreModuleCache = directory;
+}
+
+std::filesystem::path SlangCompiler::coreModuleCache()
+{
+    std::lock_guard<std::mutex> lock(g_coreModuleCacheMutex);
+    return g_coreModuleCache;
+}
 
 SlangCompiler::SlangCompiler()
 {
-    // Create a global session that can be reused.
-    slang::createGlobalSession(&desc, m_globalSession.writeRef());
+    // Create a global session that can be reused, from the core module snapshot when one is set
+    ScopedTrace trace("createGlobalSession", "init");
+    auto start = std::chrono::steady_clock::now();
+    m_globalSession = createGlobalSessionWithSnapshot(desc, coreModuleCache(), &m_coreModuleSource);
+    m_constructionTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    trace.arg("snapshot", m_coreModuleSource == CoreModuleSource::LoadedSnapshot ? 1 : 0);
 }
 
 SlangCompiler::~SlangCompiler()
 {
+    // Lazy programs handed out may still be generating code on other threads
+    std::lock_guard<std::mutex> lock(*m_slangMutex);
+    m_sessionPool.clear();
+    m_globalSession = nullptr;
     /*
     if (m_globalSession)
     {
@@ -98,115 +136,648 @@ std::string GLSLShader::ConvertSPIRVToGLSL(
 }
 #endif
 // Compile to GLSL text - returns all entry points
-std::vector<ShaderOutput> SlangCompiler::compileToGLSL(const std::string& source,
+std::vector<ShaderOutput> SlangCompiler::compileToGLSL(std::string_view source,
     const std::vector<std::string>& entryPoints, const std::string& path)
 {
     return compile(source, entryPoints, SLANG_GLSL, path);
 }
 
 // Compile to HLSL text - returns all entry points
-std::vector<ShaderOutput> SlangCompiler::compileToHLSL(const std::string& source,
+std::vector<ShaderOutput> SlangCompiler::compileToHLSL(std::string_view source,
     const std::vector<std::string>& entryPoints, const std::string& path)
 {
     return compile(source, entryPoints, SLANG_HLSL, path);
 }
 
 // Compile to SPIR-V binary - returns all entry points
-std::vector<ShaderOutput> SlangCompiler::compileToSPIRV(const std::string& source,
+std::vector<ShaderOutput> SlangCompiler::compileToSPIRV(std::string_view source,
     const std::vector<std::string>& entryPoints, const std::string& path)
 {
     return compile(source, entryPoints, SLANG_SPIRV, path);
 }
 
+// Compile to several targets at once - one parse/link, outputs indexed by (entry point, target)
+MultiTargetOutput SlangCompiler::compileToTargets(std::string_view source,
+    const std::vector<std::string>& entryPoints,
+    const std::vector<SlangCompileTarget>& targets, const std::string& path)
+{
+    MultiTargetOutput result;
+    result.outputs = compile(ShaderSource{ source, nullptr }, entryPoints, targets, path, m_options);
+    result.entryPoints = entryPoints;
+    result.targets = targets;
+    return result;
+}
+
+MultiTargetOutput SlangCompiler::compileFileToTargets(const std::filesystem::path& file,
+    const std::vector<std::string>& entryPoints,
+    const std::vector<SlangCompileTarget>& targets)
+{
+    MultiTargetOutput result;
+    result.outputs = compile(ShaderSource::readFile(file, m_fileSystem.get()), entryPoints, targets, file.string(), m_options);
+    result.entryPoints = entryPoints;
+    result.targets = targets;
+    return result;
+}
+
+// Compile a self-contained job with its own options
+std::vector<ShaderOutput> SlangCompiler::compile(const CompileJob& job)
+{
+    return compile(job, importClosure(job.sourceText().text, job.path, job.options));
+}
+
+std::vector<ShaderOutput> SlangCompiler::compile(const CompileJob& job, const std::vector<ImportedFile>& imports)
+{
+    beginJobAccounting();
+    std::vector<ShaderOutput> outputs;
+    try
+    {
+        outputs = compile(job.sourceText(), job.entryPoints, job.targets, job.path, job.options, job.cancel.get(), &imports);
+    }
+    catch (...)
+    {
+        // Failed jobs can leave sessions and diagnostics behind too
+        endJobAccounting(outputs);
+        throw;
+    }
+    endJobAccounting(outputs);
+    return outputs;
+}
+
+std::shared_ptr<const LazyProgram> SlangCompiler::compileLazy(const CompileJob& job)
+{
+    if (job.entryPoints.empty())
+    {
+        throw std::runtime_error("No entry points specified");
+    }
+    if (job.targets.empty())
+    {
+        throw std::runtime_error("No targets specified");
+    }
+
+    ScopedTrace trace("compileLazy");
+    trace.detail(job.path);
+    std::vector<ImportedFile> imports = importClosure(job.sourceText().text, job.path, job.options);
+    if (m_memoryCache)
+    {
+        ScopedTrace lookup("memoryCacheLookup", "cache");
+        HashKey128 key = memoryCacheKey(job.sourceText().text, job.entryPoints, job.targets, job.path, job.options, imports);
+        if (ShaderMemoryCache::Result cached = m_memoryCache->find(key))
+        {
+            lookup.arg("hit", 1);
+            return std::make_shared<const LazyProgram>(job.entryPoints, job.targets, *cached);
+        }
+    }
+
+    // Code generation, the bulk of the back end cost, is left to the first access
+    std::lock_guard<std::mutex> lock(*m_slangMutex);
+    LoadedModule loaded = loadModule(job.sourceText(), job.targets, job.path, job.options, imports, job.cancel.get());
+    Slang::ComPtr<slang::IComponentType> program = composeProgram(loaded, job.entryPoints);
+    Slang::ComPtr<slang::IComponentType> linkedProgram = linkProgram(program.get(), job.cancel.get());
+    return std::make_shared<const LazyProgram>(std::move(loaded.pooled), std::move(linkedProgram),
+        job.entryPoints, job.targets, job.options, m_slangMutex);
+}
+
+void SlangCompiler::setFileSystem(Slang::ComPtr<VirtualFileSystem> fileSystem)
+{
+    if (fileSystem.get() == m_fileSystem.get())
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(*m_slangMutex);
+    m_fileSystem = std::move(fileSystem);
+    m_sessionPool.setFileSystem(Slang::ComPtr<ISlangFileSystem>(m_fileSystem.get()));
+}
+
+SlangCompiler::MemoryStats SlangCompiler::memoryStats() const
+{
+    MemoryStats stats = m_memoryStats;
+    stats.sessionResidentBytes = m_sessionPool.stats().residentBytes;
+    return stats;
+}
+
+void SlangCompiler::beginJobAccounting()
+{
+    m_lastJobMemory = JobMemoryStats{};
+    m_lastJobMemory.rssBefore = currentRssBytes();
+    m_jobPeakRss = m_lastJobMemory.rssBefore;
+    m_jobSession.reset();
+    m_trackingJob = true;
+}
+
+void SlangCompiler::sampleJobMemory()
+{
+    if (m_trackingJob)
+    {
+        m_jobPeakRss = std::max(m_jobPeakRss, currentRssBytes());
+    }
+}
+
+void SlangCompiler::endJobAccounting(const std::vector<ShaderOutput>& outputs)
+{
+    m_trackingJob = false;
+    size_t rss = currentRssBytes();
+    JobMemoryStats& job = m_lastJobMemory;
+    job.outputBytes = uniqueCodeBytes(outputs);
+    std::vector<const ReflectionTable*> tables;
+    for (const auto& output : outputs)
+    {
+        if (output.reflection && std::find(tables.begin(), tables.end(), output.reflection.get()) == tables.end())
+        {
+            tables.push_back(output.reflection.get());
+            job.reflectionBytes += output.reflection->footprint();
+        }
+    }
+    job.peakRssDelta = (int64_t)std::max(m_jobPeakRss, rss) - (int64_t)job.rssBefore;
+    job.retainedRssDelta = (int64_t)rss - (int64_t)job.rssBefore;
+
+    ++m_memoryStats.jobs;
+    m_memoryStats.outputBytes += job.outputBytes;
+    m_memoryStats.reflectionBytes += job.reflectionBytes;
+    m_memoryStats.peakRssDelta = std::max(m_memoryStats.peakRssDelta, job.peakRssDelta);
+    m_memoryStats.retainedRssDelta += job.retainedRssDelta;
+
+    // Growth that outlives the job stays with the session it was compiled in
+    if (std::shared_ptr<PooledSession> session = m_jobSession.lock())
+    {
+        session->residentBytes += (size_t)std::max<int64_t>(job.retainedRssDelta, 0);
+    }
+    m_jobSession.reset();
+
+    if (m_memoryBudget.sessionRssBytes > 0 && rss > m_memoryBudget.sessionRssBytes &&
+        m_sessionPool.stats().liveSessions > 0)
+    {
+        std::lock_guard<std::mutex> lock(*m_slangMutex);
+        m_sessionPool.clear();
+        ++m_memoryStats.sessionSheds;
+    }
+}
+
+size_t uniqueCodeBytes(const std::vector<ShaderOutput>& outputs)
+{
+    std::vector<const slang::IBlob*> blobs;
+    size_t bytes = 0;
+    for (const auto& output : outputs)
+    {
+        if (output.codeBlob && std::find(blobs.begin(), blobs.end(), output.codeBlob.get()) == blobs.end())
+        {
+            blobs.push_back(output.codeBlob.get());
+            bytes += output.bytes().size();
+        }
+    }
+    return bytes;
+}
+
+ShaderSource ShaderSource::readFile(const std::filesystem::path& path, VirtualFileSystem* fileSystem)
+{
+    // Not mapped: a mapping follows later writes to the file and faults if it is truncated
+    Slang::ComPtr<slang::IBlob> blob;
+    if (fileSystem)
+    {
+        blob = fileSystem->read(path);
+    }
+    else
+    {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        if (stream)
+        {
+            std::vector<uint8_t> bytes{ std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+            blob = createBlob(std::move(bytes));
+        }
+    }
+    if (!blob)
+    {
+        throw std::runtime_error("Failed to read shader source: " + path.string());
+    }
+    std::string_view text(static_cast<const char*>(blob->getBufferPointer()), blob->getBufferSize());
+    return { text, std::make_shared<const Slang::ComPtr<slang::IBlob>>(std::move(blob)) };
+}
+
 // Convenience overloads for single entry point
-std::string SlangCompiler::compileToGLSLSingle(const std::string& source,
+std::string SlangCompiler::compileToGLSLSingle(std::string_view source,
     const std::string& entryPoint, const std::string& path)
 {
     std::vector<ShaderOutput> outputs = compileToGLSL(source, { entryPoint }, path);
     if (outputs.empty()) return "";
-    return outputs[0].asText();
+    return std::string(outputs[0].text());
 }
 
-std::string SlangCompiler::compileToHLSLSingle(const std::string& source,
+std::string SlangCompiler::compileToHLSLSingle(std::string_view source,
     const std::string& entryPoint, const std::string& path)
 {
     std::vector<ShaderOutput> outputs = compileToHLSL(source, { entryPoint }, path);
     if (outputs.empty()) return "";
-    return outputs[0].asText();
+    return std::string(outputs[0].text());
 }
 
-std::vector<uint8_t> SlangCompiler::compileToSPIRVSingle(const std::string& source,
+std::vector<uint8_t> SlangCompiler::compileToSPIRVSingle(std::string_view source,
     const std::string& entryPoint, const std::string& path)
 {
     std::vector<ShaderOutput> outputs = compileToSPIRV(source, { entryPoint }, path);
     if (outputs.empty()) return std::vector<uint8_t>();
-    return outputs[0].binaryData;
+    std::span<const uint8_t> code = outputs[0].bytes();
+    return std::vector<uint8_t>(code.begin(), code.end());
 }
 
-std::vector<ShaderOutput> SlangCompiler::compile(const std::string& source,
+std::vector<ShaderOutput> SlangCompiler::compile(std::string_view source,
     const std::vector<std::string>& entryPoints,
     SlangCompileTarget target, const std::string& path)
 {
-    std::vector<ShaderOutput> outputs;
+    std::vector<ShaderOutput> outputs = compile(ShaderSource{ source, nullptr }, entryPoints, std::vector<SlangCompileTarget>{ target }, path, m_options);
 
+    // Single-target callers only get the entry points that produced code
+    outputs.erase(std::remove_if(outputs.begin(), outputs.end(),
+        [](const ShaderOutput& output) { return output.empty(); }), outputs.end());
+    return outputs;
+}
+
+std::vector<ShaderOutput> SlangCompiler::compile(const ShaderSource& source,
+    const std::vector<std::string>& entryPoints,
+    const std::vector<SlangCompileTarget>& targets, const std::string& path,
+    const CompileOptions& options, const std::atomic<bool>* cancel, const std::vector<ImportedFile>* imports)
+{
     if (entryPoints.empty())
     {
         throw std::runtime_error("No entry points specified");
     }
+    if (targets.empty())
+    {
+        throw std::runtime_error("No targets specified");
+    }
 
-    // Setup session descriptor
-    slang::SessionDesc sessionDesc{};
-    slang::TargetDesc targetDesc{};
-    Slang::ComPtr<slang::ISession> session;
+    ScopedTrace trace("compile");
+    trace.detail(path);
+    trace.arg("entryPoints", (int64_t)entryPoints.size());
+    trace.arg("targets", (int64_t)targets.size());
+    trace.arg("bytesIn", (int64_t)source.text.size());
+    CompileTrace::count("compile.bytesIn", (int64_t)source.text.size());
 
-    targetDesc.format = target;
-    targetDesc.profile = m_globalSession->findProfile("sm_6_0");
+    // A repeated request is a hash lookup in the memory cache, once its imports are known unchanged
+    std::vector<ImportedFile> scanned;
+    if (!imports)
+    {
+        scanned = importClosure(source.text, path, options);
+        imports = &scanned;
+    }
+    HashKey128 memoryKey;
+    if (m_memoryCache)
+    {
+        ScopedTrace lookup("memoryCacheLookup", "cache");
+        memoryKey = memoryCacheKey(source.text, entryPoints, targets, path, options, *imports);
+        if (ShaderMemoryCache::Result cached = m_memoryCache->find(memoryKey))
+        {
+            lookup.arg("hit", 1);
+            trace.arg("memoryCacheHit", 1);
+            CompileTrace::count("cache.memoryHits", 1);
+            return *cached;
+        }
+    }
 
-    sessionDesc.targets = &targetDesc;
-    sessionDesc.targetCount = 1;
+    std::vector<ShaderOutput> outputs;
+    std::string cacheKey;
+    bool fromDisk = false;
+    if (m_diskCache)
+    {
+        ScopedTrace lookup("diskCacheLoad", "cache");
+        cacheKey = diskCacheKey(source.text, entryPoints, targets, path, options, *imports);
+        fromDisk = m_diskCache->load(cacheKey, outputs);
+        lookup.arg("hit", fromDisk);
+        if (fromDisk)
+        {
+            trace.arg("diskCacheHit", 1);
+            CompileTrace::count("cache.diskHits", 1);
+        }
+    }
 
-    const char* searchPaths[] = { "./", "../shaders/", "../../shaders/" };
-    sessionDesc.searchPaths = searchPaths;
-    sessionDesc.searchPathCount = 3;
+    if (!fromDisk)
+    {
+        CompileTrace::count("cache.misses", 1);
+        std::lock_guard<std::mutex> lock(*m_slangMutex);
+        outputs = compileWithSlang(source, entryPoints, targets, path, options, *imports, cancel);
+    }
 
-    // Create session
-    SlangResult result = m_globalSession->createSession(sessionDesc, session.writeRef());
-    if (SLANG_FAILED(result) || !session)
+    if (trace.active())
     {
-        throw std::runtime_error("Failed to create Slang session");
+        int64_t bytesOut = (int64_t)uniqueCodeBytes(outputs);
+        trace.arg("bytesOut", bytesOut);
+        CompileTrace::count("compile.bytesOut", bytesOut);
     }
 
-    // Load module from source string
-    Slang::ComPtr<slang::IBlob> diagnostics;
+    // Partial results are not cached so a failed entry point is retried next time
+    bool complete = std::none_of(outputs.begin(), outputs.end(),
+        [](const ShaderOutput& output) { return output.empty(); });
+    if (complete)
+    {
+        if (m_diskCache && !fromDisk)
+        {
+            m_diskCache->store(cacheKey, outputs);
+        }
+        if (m_memoryCache)
+        {
+            m_memoryCache->insert(memoryKey, std::make_shared<const std::vector<ShaderOutput>>(outputs));
+        }
+    }
+    return outputs;
+}
 
-	std::cout << "Path is: " << path << std::endl;
-    slang::IModule* loadedModule = session->loadModuleFromSourceString(
-        "shader",
-        path.c_str(),
-        source.c_str(),
-        diagnostics.writeRef());
+HashKey128 SlangCompiler::memoryCacheKey(std::string_view source,
+    const std::vector<std::string>& entryPoints,
+    const std::vector<SlangCompileTarget>& targets,
+    const std::string& path,
+    const CompileOptions& options,
+    const std::vector<ImportedFile>& imports) const
+{
+    // Two FNV-1a streams with different seeds; each field is length-prefixed
+    HashKey128 key{ kFnv1aOffset, 0x84222325cbf29ce4ull };
+    auto mix = [&key](std::string_view field)
+    {
+        uint64_t size = field.size();
+        key.hash = fnv1a64(field, fnv1a64(&size, sizeof(size), key.hash));
+        key.check = fnv1a64(field, fnv1a64(&size, sizeof(size), key.check));
+    };
 
-    if (diagnostics && diagnostics->getBufferSize() > 0)
+    mix(source);
+    mix(path);
+    // An edited import changes the key, so no stale result is ever returned
+    for (const auto& import : imports)
     {
-        std::string diagStr((const char*)diagnostics->getBufferPointer(),
-            diagnostics->getBufferSize());
-        if (!diagStr.empty())
+        mix({ reinterpret_cast<const char*>(import.contentHash.data()), import.contentHash.size() });
+    }
+    mix({});
+    for (const auto& entryPoint : entryPoints)
+    {
+        mix(entryPoint);
+    }
+    mix({});
+    for (SlangCompileTarget target : targets)
+    {
+        mix(std::to_string(static_cast<int>(target)));
+    }
+    mix({});
+    mix(options.profile);
+    for (const auto& searchPath : options.searchPaths)
+    {
+        mix(searchPath);
+    }
+    mix({});
+    for (const auto& macro : options.macros)
+    {
+        mix(macro.name);
+        mix(macro.value);
+    }
+    mix(options.wholeProgram ? "whole" : "entry");
+    return key;
+}
+
+std::string SlangCompiler::diskCacheKey(std::string_view source,
+    const std::vector<std::string>& entryPoints,
+    const std::vector<SlangCompileTarget>& targets,
+    const std::string& path,
+    const CompileOptions& options)
+{
+    return diskCacheKey(source, entryPoints, targets, path, options, importClosure(source, path, options));
+}
+
+std::string SlangCompiler::diskCacheKey(std::string_view source,
+    const std::vector<std::string>& entryPoints,
+    const std::vector<SlangCompileTarget>& targets,
+    const std::string& path,
+    const CompileOptions& options,
+    const std::vector<ImportedFile>& imports)
+{
+    Sha256 hasher;
+    hasher.updateField("SlangShaderCompiler/1");
+    hasher.updateField(m_globalSession->getBuildTagString());
+    hasher.updateField(path);
+    hasher.updateField(source);
+
+    // Imported files are identified by content; their location is covered by the search paths
+    hasher.updateU64(imports.size());
+    for (const auto& import : imports)
+    {
+        hasher.update(import.contentHash.data(), import.contentHash.size());
+    }
+
+    hasher.updateU64(targets.size());
+    for (SlangCompileTarget target : targets)
+    {
+        hasher.updateU64(static_cast<uint64_t>(target));
+    }
+    hasher.updateField(options.profile);
+    hasher.updateU64(options.searchPaths.size());
+    for (const auto& searchPath : options.searchPaths)
+    {
+        hasher.updateField(searchPath);
+    }
+    hasher.updateU64(options.macros.size());
+    for (const auto& macro : options.macros)
+    {
+        hasher.updateField(macro.name);
+        hasher.updateField(macro.value);
+    }
+    hasher.updateU64(options.wholeProgram);
+    hasher.updateU64(entryPoints.size());
+    for (const auto& entryPoint : entryPoints)
+    {
+        hasher.updateField(entryPoint);
+    }
+    return Sha256::toHex(hasher.finish());
+}
+
+std::vector<ImportedFile> SlangCompiler::importClosure(std::string_view source, const std::string& path,
+    const CompileOptions& options) const
+{
+    ScopedTrace trace("scanImports");
+    std::vector<ImportedFile> imports = collectImportClosure(source, path, options.searchPaths, m_fileSystem.get());
+    trace.arg("imports", (int64_t)imports.size());
+    return imports;
+}
+
+// Stops a compile at a phase boundary once its job has been cancelled
+static void throwIfCancelled(const std::atomic<bool>* cancel, const char* phase)
+{
+    if (cancel && cancel->load(std::memory_order_relaxed))
+    {
+        throw CompileCancelledError(std::string("Compile cancelled before ") + phase);
+    }
+}
+
+std::vector<ShaderOutput> SlangCompiler::compileWithSlang(const ShaderSource& source,
+    const std::vector<std::string>& entryPoints,
+    const std::vector<SlangCompileTarget>& targets, const std::string& path,
+    const CompileOptions& options, const std::vector<ImportedFile>& imports, const std::atomic<bool>* cancel)
+{
+    LoadedModule loaded = loadModule(source, targets, path, options, imports, cancel);
+    m_jobSession = loaded.pooled;
+    sampleJobMemory();
+    Slang::ComPtr<slang::IComponentType> program = composeProgram(loaded, entryPoints);
+    Slang::ComPtr<slang::IComponentType> linkedProgram = linkProgram(program.get(), cancel);
+    sampleJobMemory();
+    std::vector<ShaderOutput> outputs = generateCode(linkedProgram.get(), entryPoints, targets, options, cancel);
+    sampleJobMemory();
+    return outputs;
+}
+
+std::vector<CompileResult> SlangCompiler::compileSpecializations(const CompileJob& job,
+    const std::vector<std::vector<std::string>>& typeArgumentSets)
+{
+    if (job.entryPoints.empty())
+    {
+        throw std::runtime_error("No entry points specified");
+    }
+    if (job.targets.empty())
+    {
+        throw std::runtime_error("No targets specified");
+    }
+
+    ScopedTrace trace("compileSpecializations");
+    trace.detail(job.path);
+    trace.arg("specializations", (int64_t)typeArgumentSets.size());
+
+    // Parse and compose once; only specialize, link and codegen run per argument set
+    std::vector<ImportedFile> imports = importClosure(job.sourceText().text, job.path, job.options);
+    std::lock_guard<std::mutex> lock(*m_slangMutex);
+    const std::atomic<bool>* cancel = job.cancel.get();
+    LoadedModule loaded = loadModule(job.sourceText(), job.targets, job.path, job.options, imports, cancel);
+    Slang::ComPtr<slang::IComponentType> program = composeProgram(loaded, job.entryPoints);
+    slang::ProgramLayout* moduleLayout = loaded.module->getLayout();
+
+    std::vector<CompileResult> results(typeArgumentSets.size());
+    for (size_t i = 0; i < typeArgumentSets.size(); ++i)
+    {
+        const std::vector<std::string>& typeArguments = typeArgumentSets[i];
+        try
+        {
+            Slang::ComPtr<slang::IComponentType> specialized = program;
+            if (!typeArguments.empty())
+            {
+                ScopedTrace specializeTrace("specialize");
+                std::vector<slang::SpecializationArg> args;
+                args.reserve(typeArguments.size());
+                for (const auto& typeName : typeArguments)
+                {
+                    slang::TypeReflection* type = moduleLayout ? moduleLayout->findTypeByName(typeName.c_str()) : nullptr;
+                    if (!type)
+                    {
+                        throw std::runtime_error("Unknown specialization type: " + typeName);
+                    }
+                    args.push_back(slang::SpecializationArg::fromType(type));
+                }
+
+                Slang::ComPtr<slang::IBlob> diagnostics;
+                specialized = nullptr;
+                program->specialize(args.data(), (SlangInt)args.size(), specialized.writeRef(), diagnostics.writeRef());
+                if (!specialized)
+                {
+                    std::string message = diagnostics
+                        ? std::string((const char*)diagnostics->getBufferPointer(), diagnostics->getBufferSize()) : "";
+                    throw std::runtime_error("Failed to specialize program: " + message);
+                }
+            }
+            Slang::ComPtr<slang::IComponentType> linkedProgram = linkProgram(specialized.get(), cancel);
+            results[i].outputs = generateCode(linkedProgram.get(), job.entryPoints, job.targets, job.options, cancel);
+        }
+        catch (const CompileCancelledError& e)
+        {
+            results[i].cancelled = true;
+            results[i].error = e.what();
+        }
+        catch (const std::exception& e)
         {
-            std::cerr << "Slang diagnostics:\n" << diagStr << "\n";
+            results[i].error = e.what();
         }
     }
+    return results;
+}
+
+SlangCompiler::LoadedModule SlangCompiler::loadModule(const ShaderSource& source,
+    const std::vector<SlangCompileTarget>& targets, const std::string& path,
+    const CompileOptions& options, const std::vector<ImportedFile>& imports, const std::atomic<bool>* cancel)
+{
+    // Reuse a warm session for this configuration if we have one
+    ScopedTrace acquireTrace("acquireSession");
+    std::shared_ptr<PooledSession> pooled = m_sessionPool.acquire(m_globalSession.get(), targets, options);
+    bool stale = std::any_of(imports.begin(), imports.end(), [&pooled](const ImportedFile& import)
+        {
+            auto seen = pooled->importHashes.find(import.path.generic_string());
+            return seen != pooled->importHashes.end() && seen->second != import.contentHash;
+        });
+    if (stale)
+    {
+        // The warm session holds an older build of an imported module (and of every module importing it)
+        m_sessionPool.discard(pooled);
+        pooled = m_sessionPool.acquire(m_globalSession.get(), targets, options);
+        acquireTrace.arg("staleImports", 1);
+    }
+    acquireTrace.arg("compileCount", (int64_t)pooled->compileCount);
+    acquireTrace.end();
+
+    // Load shared imports from serialized IR instead of parsing them again
+    if (m_moduleCache)
+    {
+        ScopedTrace preloadTrace("preloadModules");
+        if (!m_moduleCache->preload(*pooled, imports, options))
+        {
+            // The warm session holds an older build of an imported module
+            m_sessionPool.discard(pooled);
+            pooled = m_sessionPool.acquire(m_globalSession.get(), targets, options);
+            m_moduleCache->preload(*pooled, imports, options);
+        }
+    }
+    slang::ISession* session = pooled->session.get();
 
+    // Name the module after its content so a warm session never confuses two sources,
+    // and identical source compiled again skips parsing entirely
+    std::string moduleName = "shader_" + toHex(fnv1a64(source.text, fnv1a64(path)));
+    Slang::ComPtr<slang::IBlob> diagnostics;
+
+    throwIfCancelled(cancel, "loading module");
+    slang::IModule* loadedModule = pooled->findModule(moduleName);
     if (!loadedModule)
     {
-        throw std::runtime_error("Failed to load Slang module from source");
+        ScopedTrace loadTrace("loadModule");
+        loadTrace.arg("bytes", (int64_t)source.text.size());
+        // Slang keeps the source for diagnostics; owned text is handed over without a copy
+        Slang::ComPtr<slang::IBlob> sourceBlob = source.owner
+            ? createBlobView(source.owner, source.text.data(), source.text.size())
+            : createBlob(std::vector<uint8_t>(source.text.begin(), source.text.end()));
+        loadedModule = session->loadModuleFromSource(
+            moduleName.c_str(),
+            path.c_str(),
+            sourceBlob,
+            diagnostics.writeRef());
+
+        if (diagnostics && diagnostics->getBufferSize() > 0)
+        {
+            std::string diagStr((const char*)diagnostics->getBufferPointer(),
+                diagnostics->getBufferSize());
+            if (!diagStr.empty())
+            {
+                std::cerr << "Slang diagnostics:\n" << diagStr << "\n";
+            }
+        }
+
+        if (!loadedModule)
+        {
+            throw std::runtime_error("Failed to load Slang module from source");
+        }
+        pooled->modules[moduleName] = loadedModule;
+    }
+    for (const ImportedFile& import : imports)
+    {
+        pooled->importHashes[import.path.generic_string()] = import.contentHash;
     }
+    return { std::move(pooled), loadedModule };
+}
 
+Slang::ComPtr<slang::IComponentType> SlangCompiler::composeProgram(const LoadedModule& loaded,
+    const std::vector<std::string>& entryPoints)
+{
     // Find all entry points
     std::vector<Slang::ComPtr<slang::IEntryPoint>> entryPointObjs;
     for (const auto& entryPointName : entryPoints)
     {
         Slang::ComPtr<slang::IEntryPoint> entryPointObj;
-        loadedModule->findEntryPointByName(entryPointName.c_str(), entryPointObj.writeRef());
+        loaded.module->findEntryPointByName(entryPointName.c_str(), entryPointObj.writeRef());
 
         if (!entryPointObj)
         {
@@ -218,14 +789,15 @@ std::vector<ShaderOutput> SlangCompiler::compile(const std::string& source,
 
     // Create composite component type (module + all entry points)
     std::vector<slang::IComponentType*> components;
-    components.push_back(loadedModule);
+    components.push_back(loaded.module);
     for (auto& ep : entryPointObjs)
     {
         components.push_back(ep.get());
     }
 
+    Slang::ComPtr<slang::IBlob> diagnostics;
     Slang::ComPtr<slang::IComponentType> program;
-    session->createCompositeComponentType(
+    loaded.pooled->session->createCompositeComponentType(
         components.data(),
         (SlangInt)components.size(),
         program.writeRef(),
@@ -235,10 +807,19 @@ std::vector<ShaderOutput> SlangCompiler::compile(const std::string& source,
     {
         throw std::runtime_error("Failed to create composite component type");
     }
+    return program;
+}
 
+Slang::ComPtr<slang::IComponentType> SlangCompiler::linkProgram(slang::IComponentType* program,
+    const std::atomic<bool>* cancel)
+{
     // Link the program once for all entry points
+    throwIfCancelled(cancel, "linking");
+    ScopedTrace linkTrace("link");
+    Slang::ComPtr<slang::IBlob> diagnostics;
     Slang::ComPtr<slang::IComponentType> linkedProgram;
     program->link(linkedProgram.writeRef(), diagnostics.writeRef());
+    linkTrace.end();
 
     if (diagnostics)
     {
@@ -254,128 +835,427 @@ std::vector<ShaderOutput> SlangCompiler::compile(const std::string& source,
     {
         throw std::runtime_error("Failed to link program");
     }
+    return linkedProgram;
+}
 
-    // Get compiled code for each entry point
-    int targetIndex = 0;
-    for (size_t i = 0; i < entryPoints.size(); ++i)
+ShaderOutput SlangCompiler::generateEntryPointCode(slang::IComponentType* linkedProgram,
+    size_t entryIndex, const std::string& entryPoint, size_t targetIndex, SlangCompileTarget target)
+{
+    Slang::ComPtr<slang::IBlob> codeBlob;
+    Slang::ComPtr<slang::IBlob> diagnostics;
+
+    ScopedTrace codegenTrace("getEntryPointCode");
+    codegenTrace.detail(entryPoint);
+    codegenTrace.arg("target", (int64_t)target);
+    linkedProgram->getEntryPointCode(
+        (int)entryIndex,
+        (int)targetIndex,
+        codeBlob.writeRef(),
+        diagnostics.writeRef());
+    codegenTrace.arg("bytesOut", codeBlob ? (int64_t)codeBlob->getBufferSize() : 0);
+    codegenTrace.end();
+
+    ShaderOutput output;
+    output.target = target;
+    output.entryPointName = entryPoint;
+    if (!codeBlob)
     {
-        Slang::ComPtr<slang::IBlob> codeBlob;
+        std::cerr << "Failed to get code for entry point: " << entryPoint << "\n";
+        return output;
+    }
+    output.codeBlob = std::move(codeBlob);
+    return output;
+}
 
-        linkedProgram->getEntryPointCode(
-            (int)i,
-            targetIndex,
-            codeBlob.writeRef(),
-            diagnostics.writeRef());
+Slang::ComPtr<slang::IBlob> SlangCompiler::generateTargetCode(slang::IComponentType* linkedProgram,
+    size_t targetIndex, SlangCompileTarget target)
+{
+    Slang::ComPtr<slang::IBlob> codeBlob;
+    Slang::ComPtr<slang::IBlob> diagnostics;
+
+    ScopedTrace codegenTrace("getTargetCode");
+    codegenTrace.arg("target", (int64_t)target);
+    linkedProgram->getTargetCode((SlangInt)targetIndex, codeBlob.writeRef(), diagnostics.writeRef());
+    codegenTrace.arg("bytesOut", codeBlob ? (int64_t)codeBlob->getBufferSize() : 0);
+    codegenTrace.end();
 
-        if (!codeBlob)
+    if (!codeBlob)
+    {
+        std::cerr << "Failed to get whole-program code for target " << (int)target << "\n";
+        if (diagnostics && diagnostics->getBufferSize() > 0)
         {
-            std::cerr << "Failed to get code for entry point: " << entryPoints[i] << "\n";
-            continue;
+            std::cerr << std::string_view((const char*)diagnostics->getBufferPointer(), diagnostics->getBufferSize()) << "\n";
         }
+    }
+    return codeBlob;
+}
 
-        // Store output
-        ShaderOutput output;
-        // only store resource bindings on first output
-		output.resourceBindings = extractResourceBindings(linkedProgram.get());
-        output.target = target;
-        output.entryPointName = entryPoints[i];
-        const uint8_t* data = static_cast<const uint8_t*>(codeBlob->getBufferPointer());
-        uint64_t size = codeBlob->getBufferSize();
-        output.binaryData.assign(data, data + size);
+std::vector<ShaderOutput> SlangCompiler::generateCode(slang::IComponentType* linkedProgram,
+    const std::vector<std::string>& entryPoints,
+    const std::vector<SlangCompileTarget>& targets, const CompileOptions& options,
+    const std::atomic<bool>* cancel)
+{
+    std::vector<ShaderOutput> outputs;
 
-        outputs.push_back(output);
+    // Reflection is per target, computed on first use and shared by every entry point
+    std::vector<std::shared_ptr<const ReflectionTable>> reflections(targets.size());
+
+    // Whole-program targets are generated once and referenced by each entry point's output
+    std::vector<Slang::ComPtr<slang::IBlob>> targetCode(targets.size());
+    for (size_t targetIndex = 0; targetIndex < targets.size(); ++targetIndex)
+    {
+        if (sharesTargetCode(options, targets[targetIndex]))
+        {
+            throwIfCancelled(cancel, "code generation");
+            targetCode[targetIndex] = generateTargetCode(linkedProgram, targetIndex, targets[targetIndex]);
+        }
+    }
+
+    // Get compiled code for each entry point and target
+    outputs.reserve(entryPoints.size() * targets.size());
+    for (size_t i = 0; i < entryPoints.size(); ++i)
+    {
+        for (size_t targetIndex = 0; targetIndex < targets.size(); ++targetIndex)
+        {
+            throwIfCancelled(cancel, "code generation");
+            // Left empty on failure so (entry, target) indexing still holds
+            ShaderOutput output;
+            if (sharesTargetCode(options, targets[targetIndex]))
+            {
+                output.target = targets[targetIndex];
+                output.entryPointName = entryPoints[i];
+                output.codeBlob = targetCode[targetIndex];
+            }
+            else
+            {
+                output = generateEntryPointCode(linkedProgram, i, entryPoints[i], targetIndex, targets[targetIndex]);
+            }
+            if (!output.empty())
+            {
+                if (!reflections[targetIndex])
+                {
+                    ScopedTrace reflectionTrace("reflection");
+                    reflections[targetIndex] = extractResourceBindings(linkedProgram, (int)targetIndex);
+                }
+                output.reflection = reflections[targetIndex];
+            }
+            outputs.push_back(std::move(output));
+        }
     }
 
     return outputs;
 }
-std::vector<ShaderResourceBinding> SlangCompiler::extractResourceBindings(slang::IComponentType* program) {
-    std::vector<ShaderResourceBinding> bindings;
-
-	if (!program) {
-        throw std::runtime_error("Invalid program for resource binding extraction");
-    }
-    slang::ProgramLayout* programLayout{ program->getLayout() };
-    if (!programLayout) {
-        throw std::runtime_error("Failed to get program layout for resource binding extraction");
-    }
-    slang::TypeLayoutReflection* globalParams{ programLayout->getGlobalParamsTypeLayout() };
+namespace
+{
+    constexpr size_t kCategoryCount = slang::ParameterCategory::InputAttachmentIndex + 1;
 
-    uint32_t fieldCount = globalParams->getFieldCount();
+    // Register offsets and spaces accumulated from the root of the parameter tree
+    struct ReflectionScope
+    {
+        std::string path;
+        size_t offsets[kCategoryCount] = {};
+        size_t spaces[kCategoryCount] = {};
+        uint32_t count = 1;     // Product of enclosing array sizes, 0 once any is unbounded
+        uint32_t stageMask = 0;
+        const char* defaultBlockName = "$Globals"; // Implicit buffer of loose uniforms
+    };
 
-    for (uint32_t i{ 0 }; i < fieldCount; ++i) {
-        slang::VariableLayoutReflection* field{ globalParams->getFieldByIndex(i) };
-        slang::TypeLayoutReflection* typeLayout{ field->getTypeLayout() };
-        slang::TypeReflection* type{ typeLayout->getType() };
-        ShaderResourceBinding binding;
-        binding.name = field->getName();
+    bool usesCategory(slang::TypeLayoutReflection* typeLayout, slang::ParameterCategory category)
+    {
+        for (unsigned int i = 0; i < typeLayout->getCategoryCount(); ++i)
+        {
+            if (typeLayout->getCategoryByIndex(i) == category)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
 
-        // Get binding information
-        slang::TypeReflection::Kind kind = type->getKind();
-        switch (kind)
+    ReflectionScope enterVariable(const ReflectionScope& parent, slang::VariableLayoutReflection* var,
+        const char* name)
+    {
+        ReflectionScope scope = parent;
+        if (name && *name)
         {
-        case slang::TypeReflection::Kind::ConstantBuffer:
+            scope.path = parent.path.empty() ? name : parent.path + "." + name;
+        }
+        for (unsigned int i = 0; i < var->getCategoryCount(); ++i)
         {
-            binding.resourceType = ShaderResourceBinding::ResourceType::ConstantBuffer;
-            binding.binding = static_cast<uint32_t>(field->getOffset(slang::ParameterCategory::ConstantBuffer));
-            binding.set = static_cast<uint32_t>(field->getBindingSpace(slang::ParameterCategory::ConstantBuffer));
-            bindings.push_back(binding);
-            break;
+            slang::ParameterCategory category = var->getCategoryByIndex(i);
+            if (category < kCategoryCount)
+            {
+                scope.offsets[category] += var->getOffset(category);
+                scope.spaces[category] += var->getBindingSpace(category);
+            }
         }
-        case slang::TypeReflection::Kind::Resource:
+        return scope;
+    }
+
+    class ReflectionWalker
+    {
+    public:
+        explicit ReflectionWalker(ReflectionTable::Builder& builder) : m_builder(builder) {}
+
+        void walk(const ReflectionScope& scope, slang::TypeLayoutReflection* typeLayout)
         {
-            SlangResourceShape shape = type->getResourceShape();
-            SlangResourceAccess access = type->getResourceAccess();
-            if ((shape & SLANG_RESOURCE_BASE_SHAPE_MASK) == SLANG_STRUCTURED_BUFFER) {
-                if (access == SlangResourceAccess::SLANG_RESOURCE_ACCESS_READ_WRITE) {
-                    binding.resourceType = ShaderResourceBinding::ResourceType::UAV;
-                    binding.binding = static_cast<uint32_t>(field->getOffset(slang::ParameterCategory::UnorderedAccess));
-                    binding.set = static_cast<uint32_t>(field->getBindingSpace(slang::ParameterCategory::UnorderedAccess));
+            switch (typeLayout->getKind())
+            {
+            case slang::TypeReflection::Kind::Struct:
+                for (unsigned int i = 0; i < typeLayout->getFieldCount(); ++i)
+                {
+                    slang::VariableLayoutReflection* field = typeLayout->getFieldByIndex(i);
+                    walk(enterVariable(scope, field, field->getName()), field->getTypeLayout());
                 }
-                else {
-                    binding.resourceType = ShaderResourceBinding::ResourceType::StructuredBuffer;
-                    binding.binding = static_cast<uint32_t>(field->getOffset(slang::ParameterCategory::ShaderResource));
-                    binding.set = static_cast<uint32_t>(field->getBindingSpace(slang::ParameterCategory::ShaderResource));
-                }
-                bindings.push_back(binding);
+                break;
+            case slang::TypeReflection::Kind::Array:
+            {
+                ReflectionScope element = scope;
+                size_t elementCount = typeLayout->getElementCount();
+                bool unbounded = elementCount == 0 || elementCount == ~size_t(0);
+                element.count = unbounded ? 0 : scope.count * (uint32_t)elementCount;
+                walk(element, typeLayout->getElementTypeLayout());
+                break;
             }
-            else if ((shape & SLANG_RESOURCE_BASE_SHAPE_MASK) == SLANG_TEXTURE_2D ||
-                (shape & SLANG_RESOURCE_BASE_SHAPE_MASK) == SLANG_TEXTURE_3D ||
-                (shape & SLANG_RESOURCE_BASE_SHAPE_MASK) == SLANG_TEXTURE_CUBE) {
-                if (access == SlangResourceAccess::SLANG_RESOURCE_ACCESS_READ_WRITE) {
-                    binding.resourceType = ShaderResourceBinding::ResourceType::UAV;
-                    binding.binding = static_cast<uint32_t>(field->getOffset(slang::ParameterCategory::UnorderedAccess));
-                    binding.set = static_cast<uint32_t>(field->getBindingSpace(slang::ParameterCategory::UnorderedAccess));
-                }
-                else {
-                    binding.resourceType = ShaderResourceBinding::ResourceType::Texture;
-                    binding.binding = static_cast<uint32_t>(field->getOffset(slang::ParameterCategory::ShaderResource));
-                    binding.set = static_cast<uint32_t>(field->getBindingSpace(slang::ParameterCategory::ShaderResource));
+            case slang::TypeReflection::Kind::ConstantBuffer:
+            case slang::TypeReflection::Kind::ParameterBlock:
+                walkBlock(scope, typeLayout);
+                break;
+            case slang::TypeReflection::Kind::Resource:
+            case slang::TypeReflection::Kind::TextureBuffer:
+            case slang::TypeReflection::Kind::ShaderStorageBuffer:
+                addResource(scope, typeLayout);
+                break;
+            case slang::TypeReflection::Kind::SamplerState:
+                add(scope, typeLayout, ShaderResourceBinding::ResourceType::Sampler, slang::ParameterCategory::SamplerState);
+                break;
+            default:
+                break;
+            }
+        }
+
+    private:
+        ReflectionTable::Builder& m_builder;
+
+        void walkBlock(const ReflectionScope& scope, slang::TypeLayoutReflection* typeLayout)
+        {
+            slang::VariableLayoutReflection* container = typeLayout->getContainerVarLayout();
+            slang::VariableLayoutReflection* element = typeLayout->getElementVarLayout();
+            ReflectionScope inner = scope;
+
+            // A parameter block opens a descriptor set / register space of its own
+            if (typeLayout->getKind() == slang::TypeReflection::Kind::ParameterBlock)
+            {
+                size_t space = scope.offsets[slang::ParameterCategory::SubElementRegisterSpace] +
+                    scope.offsets[slang::ParameterCategory::RegisterSpace];
+                for (size_t category = 0; category < kCategoryCount; ++category)
+                {
+                    inner.offsets[category] = 0;
+                    inner.spaces[category] = space;
                 }
-                bindings.push_back(binding);
-				auto samplerOffset = field->getOffset(slang::ParameterCategory::SamplerState);
-                if (samplerOffset >= 0) {
-                    ShaderResourceBinding samplerBinding;
-                    samplerBinding.name = binding.name + "_sampler";
-                    samplerBinding.resourceType = ShaderResourceBinding::ResourceType::Sampler;
-                    samplerBinding.binding = static_cast<uint32_t>(samplerOffset);
-                    samplerBinding.set = static_cast<uint32_t>(field->getBindingSpace(slang::ParameterCategory::SamplerState));
-                    //samplerBinding.count = 1;
-					bindings.push_back(samplerBinding);
+            }
+
+            uint32_t uniformSize = (uint32_t)element->getTypeLayout()->getSize(slang::ParameterCategory::Uniform);
+            ReflectionScope buffer = enterVariable(inner, container, nullptr);
+            if (usesCategory(typeLayout, slang::ParameterCategory::PushConstantBuffer))
+            {
+                ShaderResourceBinding binding = makeBinding(buffer, ShaderResourceBinding::ResourceType::PushConstant);
+                binding.binding = (uint32_t)buffer.offsets[slang::ParameterCategory::PushConstantBuffer];
+                binding.sizeInBytes = uniformSize;
+                m_builder.add(binding);
+            }
+            else if (uniformSize > 0)
+            {
+                ShaderResourceBinding binding = makeBinding(buffer, ShaderResourceBinding::ResourceType::ConstantBuffer);
+                if (buffer.path.empty())
+                {
+                    binding.name = buffer.defaultBlockName;
                 }
+                resolveSlot(buffer, container->getTypeLayout(), slang::ParameterCategory::ConstantBuffer, binding);
+                binding.sizeInBytes = uniformSize;
+                m_builder.add(binding);
             }
-            break;
+            walk(enterVariable(inner, element, nullptr), element->getTypeLayout());
         }
-        case slang::TypeReflection::Kind::SamplerState:
+
+        void addResource(const ReflectionScope& scope, slang::TypeLayoutReflection* typeLayout)
         {
-            binding.resourceType = ShaderResourceBinding::ResourceType::Sampler;
-            binding.binding = static_cast<uint32_t>(field->getOffset(slang::ParameterCategory::SamplerState));
-            binding.set = static_cast<uint32_t>(field->getBindingSpace(slang::ParameterCategory::SamplerState));
-            bindings.push_back(binding);
-            break;
+            using ResourceType = ShaderResourceBinding::ResourceType;
+            SlangResourceShape shape = typeLayout->getResourceShape();
+            SlangResourceAccess access = typeLayout->getResourceAccess();
+            unsigned baseShape = shape & SLANG_RESOURCE_BASE_SHAPE_MASK;
+            bool writable = access != SLANG_RESOURCE_ACCESS_NONE && access != SLANG_RESOURCE_ACCESS_READ;
+            if (typeLayout->getKind() == slang::TypeReflection::Kind::ShaderStorageBuffer)
+            {
+                writable = true;
+            }
+
+            if (baseShape == SLANG_ACCELERATION_STRUCTURE)
+            {
+                add(scope, typeLayout, ResourceType::AccelerationStructure, slang::ParameterCategory::ShaderResource);
+            }
+            else if (writable)
+            {
+                add(scope, typeLayout, ResourceType::UAV, slang::ParameterCategory::UnorderedAccess);
+            }
+            else if (baseShape == SLANG_STRUCTURED_BUFFER || baseShape == SLANG_BYTE_ADDRESS_BUFFER)
+            {
+                add(scope, typeLayout, ResourceType::StructuredBuffer, slang::ParameterCategory::ShaderResource);
+            }
+            else if (baseShape == SLANG_TEXTURE_BUFFER)
+            {
+                add(scope, typeLayout, ResourceType::TypedBuffer, slang::ParameterCategory::ShaderResource);
+            }
+            else if (usesCategory(typeLayout, slang::ParameterCategory::SamplerState))
+            {
+                // HLSL splits combined samplers into a texture and a sampler register
+                add(scope, typeLayout, ResourceType::Texture, slang::ParameterCategory::ShaderResource);
+                ReflectionScope sampler = scope;
+                sampler.path += "_sampler";
+                add(sampler, typeLayout, ResourceType::Sampler, slang::ParameterCategory::SamplerState);
+            }
+            else if (typeLayout->getBindingRangeCount() > 0 &&
+                typeLayout->getBindingRangeType(0) == slang::BindingType::CombinedTextureSampler)
+            {
+                add(scope, typeLayout, ResourceType::CombinedTextureSampler, slang::ParameterCategory::ShaderResource);
+            }
+            else
+            {
+                add(scope, typeLayout, ResourceType::Texture, slang::ParameterCategory::ShaderResource);
+            }
+        }
+
+        static ShaderResourceBinding makeBinding(const ReflectionScope& scope, ShaderResourceBinding::ResourceType type)
+        {
+            ShaderResourceBinding binding;
+            binding.resourceType = type;
+            binding.binding = 0;
+            binding.set = 0;
+            binding.count = scope.count;
+            binding.name = scope.path;
+            binding.stageMask = scope.stageMask;
+            return binding;
+        }
+
+        // Vulkan targets lay everything out as descriptor table slots, D3D per register class
+        static void resolveSlot(const ReflectionScope& scope, slang::TypeLayoutReflection* typeLayout,
+            slang::ParameterCategory d3dCategory, ShaderResourceBinding& binding)
+        {
+            slang::ParameterCategory category = usesCategory(typeLayout, slang::ParameterCategory::DescriptorTableSlot)
+                ? slang::ParameterCategory::DescriptorTableSlot : d3dCategory;
+            binding.binding = (uint32_t)scope.offsets[category];
+            binding.set = (uint32_t)scope.spaces[category];
+        }
+
+        void add(const ReflectionScope& scope, slang::TypeLayoutReflection* typeLayout,
+            ShaderResourceBinding::ResourceType type, slang::ParameterCategory d3dCategory)
+        {
+            ShaderResourceBinding binding = makeBinding(scope, type);
+            resolveSlot(scope, typeLayout, d3dCategory, binding);
+            binding.shape = typeLayout->getResourceShape();
+            binding.access = typeLayout->getResourceAccess();
+            m_builder.add(binding);
         }
+    };
+
+    // Flattens varying struct inputs down to their leaf attributes
+    void addVertexInputs(ReflectionTable::Builder& builder, const ReflectionScope& scope,
+        slang::VariableLayoutReflection* var)
+    {
+        slang::TypeLayoutReflection* typeLayout = var->getTypeLayout();
+        if (typeLayout->getKind() == slang::TypeReflection::Kind::Struct)
+        {
+            for (unsigned int i = 0; i < typeLayout->getFieldCount(); ++i)
+            {
+                slang::VariableLayoutReflection* field = typeLayout->getFieldByIndex(i);
+                addVertexInputs(builder, enterVariable(scope, field, field->getName()), field);
+            }
+            return;
+        }
+        // System values (SV_VertexID, ...) consume no input location
+        if (!usesCategory(typeLayout, slang::ParameterCategory::VaryingInput))
+        {
+            return;
+        }
+
+        slang::TypeReflection* type = typeLayout->getType();
+        VertexInputAttribute attribute;
+        attribute.name = scope.path;
+        attribute.semanticName = var->getSemanticName() ? var->getSemanticName() : "";
+        attribute.semanticIndex = (uint32_t)var->getSemanticIndex();
+        attribute.location = (uint32_t)scope.offsets[slang::ParameterCategory::VaryingInput];
+        switch (type->getKind())
+        {
+        case slang::TypeReflection::Kind::Scalar:
+            attribute.scalarType = type->getScalarType();
+            attribute.componentCount = 1;
+            break;
+        case slang::TypeReflection::Kind::Vector:
+            attribute.scalarType = type->getElementType()->getScalarType();
+            attribute.componentCount = (uint32_t)type->getElementCount();
+            break;
+        case slang::TypeReflection::Kind::Matrix:
+            attribute.scalarType = type->getElementType()->getScalarType();
+            attribute.componentCount = type->getRowCount() * type->getColumnCount();
+            break;
         default:
             break;
         }
+        builder.addVertexInput(attribute);
+    }
+}
+
+std::shared_ptr<const ReflectionTable> SlangCompiler::extractResourceBindings(slang::IComponentType* program, int targetIndex) {
+    ReflectionTable::Builder bindings;
+
+	if (!program) {
+        throw std::runtime_error("Invalid program for resource binding extraction");
+    }
+    slang::ProgramLayout* programLayout{ program->getLayout(targetIndex) };
+    if (!programLayout) {
+        throw std::runtime_error("Failed to get program layout for resource binding extraction");
+    }
+
+    // Entry points first, so global bindings know which stages can see them
+    uint32_t programStages = 0;
+    SlangUInt entryPointCount = programLayout->getEntryPointCount();
+    for (SlangUInt i = 0; i < entryPointCount; ++i) {
+        slang::EntryPointReflection* entryPoint{ programLayout->getEntryPointByIndex(i) };
+        EntryPointInfo info;
+        info.name = entryPoint->getName();
+        info.stage = entryPoint->getStage();
+        if (info.stage == SLANG_STAGE_COMPUTE || info.stage == SLANG_STAGE_MESH || info.stage == SLANG_STAGE_AMPLIFICATION) {
+            SlangUInt threadGroupSize[3] = { 0, 0, 0 };
+            entryPoint->getComputeThreadGroupSize(3, threadGroupSize);
+            for (int axis = 0; axis < 3; ++axis) {
+                info.threadGroupSize[axis] = (uint32_t)threadGroupSize[axis];
+            }
+        }
+        bindings.addEntryPoint(info);
+        programStages |= 1u << info.stage;
+    }
+
+    ReflectionScope globalScope;
+    globalScope.stageMask = programStages;
+    slang::VariableLayoutReflection* globalParams{ programLayout->getGlobalParamsVarLayout() };
+    ReflectionWalker walker(bindings);
+    walker.walk(enterVariable(globalScope, globalParams, nullptr), globalParams->getTypeLayout());
+
+    // Entry-point uniform parameters and vertex inputs
+    for (SlangUInt i = 0; i < entryPointCount; ++i) {
+        slang::EntryPointReflection* entryPoint{ programLayout->getEntryPointByIndex(i) };
+        ReflectionScope entryScope;
+        entryScope.stageMask = 1u << entryPoint->getStage();
+        entryScope.defaultBlockName = entryPoint->getName();
+        entryScope = enterVariable(entryScope, entryPoint->getVarLayout(), nullptr);
+        walker.walk(entryScope, entryPoint->getTypeLayout());
+
+        if (entryPoint->getStage() == SLANG_STAGE_VERTEX) {
+            for (unsigned int p = 0; p < entryPoint->getParameterCount(); ++p) {
+                slang::VariableLayoutReflection* param{ entryPoint->getParameterByIndex(p) };
+                addVertexInputs(bindings, enterVariable(entryScope, param, param->getName()), param);
+            }
+        }
     }
-    return bindings;
+    return bindings.build();
 }
@@ -2,77 +2,376 @@
 // SlangCompiler.h
 // A helper class that uses the Slang C API directly to compile shaders
 // into GLSL, SPIR-V, or HLSL.
+#include "CompileOptions.h"
+#include "CoreModuleCache.h"
+#include "Hash.h"
+#include "ImportScanner.h"
+#include "MemoryAccounting.h"
+#include "SessionPool.h"
+#include "ShaderReflection.h"
+#include "VirtualFileSystem.h"
 #include <slang.h>
 #include <slang-com-ptr.h> 
+#include <atomic>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
-struct ShaderResourceBinding
+struct ShaderOutput
 {
-    enum class ResourceType { ConstantBuffer, StructuredBuffer, Texture, Sampler, UAV };
+    SlangCompileTarget target = SLANG_TARGET_UNKNOWN;
+    std::string entryPointName;
+    // SPIR-V or text, owned by the blob Slang (or a cache) returned; copying a
+    // ShaderOutput only adds a reference
+    Slang::ComPtr<slang::IBlob> codeBlob;
+    // Computed once per linked program and target, shared by all its outputs
+    std::shared_ptr<const ReflectionTable> reflection;
+
+    std::span<const ShaderResourceBinding> resourceBindings() const
+    {
+        if (!reflection) return {};
+        return reflection->bindings();
+    }
 
-    ResourceType resourceType;
-    uint32_t binding;   // Vulkan binding or D3D register
-    uint32_t set;       // Vulkan set or D3D space
-    uint32_t count = 1;
+    bool empty() const { return !codeBlob || codeBlob->getBufferSize() == 0; }
 
-    std::string name;
-    // Then have separate converters:
-    // - ToD3D12RootSignature()
-    // - ToVulkanDescriptorSetLayout()
+    std::span<const uint8_t> bytes() const
+    {
+        if (!codeBlob) return {};
+        return { static_cast<const uint8_t*>(codeBlob->getBufferPointer()), codeBlob->getBufferSize() };
+    }
+
+    std::string_view text() const
+    {
+        std::span<const uint8_t> data = bytes();
+        return { reinterpret_cast<const char*>(data.data()), data.size() };
+    }
+
+    // Owning copy of text(), for callers that need a std::string
+    std::string asText() const
+    {
+        return std::string(text());
+    }
 };
 
-struct ShaderOutput
+class LazyProgram;
+class ModuleCache;
+class ShaderDiskCache;
+class ShaderMemoryCache;
+
+// Shader text compiled in place. With an owner keeping the text alive Slang
+// reads it directly; without one the text is only borrowed for the call and is
+// copied once if a module has to be loaded from it.
+struct ShaderSource
 {
-    SlangCompileTarget target = SLANG_TARGET_UNKNOWN;
-    std::string entryPointName;
-    std::vector<uint8_t> binaryData; // For SPIR-V and text formats
-    std::vector<ShaderResourceBinding> resourceBindings;
+    std::string_view text;
+    std::shared_ptr<const void> owner;
 
-    std::string asText() const
+    // Private snapshot of the file, read through fileSystem when given, so the text
+    // that is hashed for cache keys is the text Slang parses, whatever happens to
+    // the file afterwards. Throws std::runtime_error if it cannot be read.
+    static ShaderSource readFile(const std::filesystem::path& path, VirtualFileSystem* fileSystem = nullptr);
+};
+
+// A self-contained compile request, used by the batch and async front ends
+struct CompileJob
+{
+    std::string source;
+    // Compiled instead of source when it has text, e.g. a file snapshot
+    ShaderSource sourceView;
+    std::string path;
+    std::vector<std::string> entryPoints;
+    std::vector<SlangCompileTarget> targets;
+    CompileOptions options;
+    // When set to true the compile stops at the next phase boundary
+    // (module load, link, per-entry codegen) with CompileCancelledError
+    std::shared_ptr<std::atomic<bool>> cancel;
+
+    ShaderSource sourceText() const
+    {
+        return sourceView.text.data() ? sourceView : ShaderSource{ source, nullptr };
+    }
+};
+
+// Thrown when a job's cancel flag is observed mid-compile
+class CompileCancelledError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Outcome of one CompileJob; failures are reported here instead of thrown
+struct CompileResult
+{
+    std::vector<ShaderOutput> outputs; // entry-point major, as in MultiTargetOutput
+    std::string error;
+    bool cancelled = false;
+    JobMemoryStats memory;
+
+    bool succeeded() const { return error.empty(); }
+};
+
+// Outputs of a single parse/link shared by several targets
+struct MultiTargetOutput
+{
+    std::vector<std::string> entryPoints;
+    std::vector<SlangCompileTarget> targets;
+    // Entry-point major: outputs[entryIndex * targets.size() + targetIndex].
+    // An empty() output means Slang produced no code for that pair.
+    std::vector<ShaderOutput> outputs;
+
+    const ShaderOutput& at(size_t entryIndex, size_t targetIndex) const
+    {
+        return outputs.at(entryIndex * targets.size() + targetIndex);
+    }
+
+    const ShaderOutput* find(const std::string& entryPoint, SlangCompileTarget target) const
     {
-        return std::string(binaryData.begin(), binaryData.end());
+        for (const auto& output : outputs)
+        {
+            if (output.entryPointName == entryPoint && output.target == target)
+            {
+                return &output;
+            }
+        }
+        return nullptr;
     }
 };
 
+// Code bytes of outputs, counting a blob shared by several outputs once
+size_t uniqueCodeBytes(const std::vector<ShaderOutput>& outputs);
+
 class SlangCompiler
 {
 public:
     SlangCompiler();
     ~SlangCompiler();
 
+    // Directory holding the core module snapshot used by compilers constructed
+    // afterwards (see CoreModuleCache.h); empty, the default, builds it every time.
+    // Process-wide so pool workers pick it up too.
+    static void setCoreModuleCache(const std::filesystem::path& directory);
+    static std::filesystem::path coreModuleCache();
+
+    // How long the global session took to create, and whether the snapshot was used
+    std::chrono::microseconds constructionTime() const { return m_constructionTime; }
+    bool coreModuleFromCache() const { return m_coreModuleSource == CoreModuleSource::LoadedSnapshot; }
+
     // Compile multiple entry points to GLSL in one pass
-    std::vector<ShaderOutput> compileToGLSL(const std::string& source,
+    std::vector<ShaderOutput> compileToGLSL(std::string_view source,
         const std::vector<std::string>& entryPoints, const std::string& path = "");
 
     // Compile multiple entry points to HLSL in one pass
-    std::vector<ShaderOutput> compileToHLSL(const std::string& source,
+    std::vector<ShaderOutput> compileToHLSL(std::string_view source,
         const std::vector<std::string>& entryPoints, const std::string& path = "");
 
     // Compile multiple entry points to SPIR-V in one pass
-    std::vector<ShaderOutput> compileToSPIRV(const std::string& source,
+    std::vector<ShaderOutput> compileToSPIRV(std::string_view source,
         const std::vector<std::string>& entryPoints, const std::string& path = "");
 
+    // Compile multiple entry points to several targets with one parse and one link
+    MultiTargetOutput compileToTargets(std::string_view source,
+        const std::vector<std::string>& entryPoints,
+        const std::vector<SlangCompileTarget>& targets, const std::string& path = "");
+
+    // Compiles a snapshot of the file (read through the file system, if set), with the file as the module path
+    MultiTargetOutput compileFileToTargets(const std::filesystem::path& file,
+        const std::vector<std::string>& entryPoints,
+        const std::vector<SlangCompileTarget>& targets);
+
+    // Compile a job with its own options; outputs are entry-point major. Throws on failure.
+    std::vector<ShaderOutput> compile(const CompileJob& job);
+    // Same, with the job's import closure already collected by importClosure(), so a
+    // caller that also needs diskCacheKey() scans the imports once
+    std::vector<ShaderOutput> compile(const CompileJob& job, const std::vector<ImportedFile>& imports);
+
+    // Parses the job's module once, then specializes, links and generates code once per
+    // set of type arguments (passed to specialize() in order; an empty set links the
+    // program as is). Bypasses the output caches. results[i] belongs to typeArgumentSets[i];
+    // throws if the module itself fails to load.
+    std::vector<CompileResult> compileSpecializations(const CompileJob& job,
+        const std::vector<std::vector<std::string>>& typeArgumentSets);
+
+    // Loads and links the job's program, but generates each entry point's code only when
+    // the returned program is first asked for it (see LazyProgram.h). A memory cache hit
+    // returns the cached outputs; lazy results are not added to the caches. Throws on failure.
+    std::shared_ptr<const LazyProgram> compileLazy(const CompileJob& job);
+
     // Convenience methods for single entry point (returns just the text/data)
-    std::string compileToGLSLSingle(const std::string& source,
+    std::string compileToGLSLSingle(std::string_view source,
         const std::string& entryPoint, const std::string& path = "");
 
-    std::string compileToHLSLSingle(const std::string& source,
+    std::string compileToHLSLSingle(std::string_view source,
         const std::string& entryPoint, const std::string& path = "");
 
-    std::vector<uint8_t> compileToSPIRVSingle(const std::string& source,
+    std::vector<uint8_t> compileToSPIRVSingle(std::string_view source,
         const std::string& entryPoint, const std::string& path = "");
 
+    // Profile, search paths and macros used by every compile call
+    void setCompileOptions(const CompileOptions& options) { m_options = options; }
+    const CompileOptions& compileOptions() const { return m_options; }
+
+    // Warm sessions are reused across compile calls; see SessionPool.h
+    SessionPool& sessionPool() { return m_sessionPool; }
+    SessionPool::Stats sessionPoolStats() const { return m_sessionPool.stats(); }
+
+    // Memory accounting for compile(const CompileJob&); see MemoryAccounting.h
+    struct MemoryStats
+    {
+        uint64_t jobs = 0;
+        size_t outputBytes = 0;          // Totals over all jobs
+        size_t reflectionBytes = 0;
+        int64_t peakRssDelta = 0;        // Largest of any job
+        int64_t retainedRssDelta = 0;    // Sum over all jobs
+        uint64_t sessionSheds = 0;       // Times the budget dropped the warm sessions
+        size_t sessionResidentBytes = 0; // Estimated footprint of the live warm sessions
+    };
+
+    // Checked after every job; sessionRssBytes drops the warm sessions when exceeded
+    void setMemoryBudget(const MemoryBudget& budget) { m_memoryBudget = budget; }
+    const MemoryBudget& memoryBudget() const { return m_memoryBudget; }
+    const JobMemoryStats& lastJobMemory() const { return m_lastJobMemory; }
+    MemoryStats memoryStats() const;
+
+    // Optional persistent cache consulted before compiling; may be shared between compilers
+    void setDiskCache(std::shared_ptr<ShaderDiskCache> cache) { m_diskCache = std::move(cache); }
+    const std::shared_ptr<ShaderDiskCache>& diskCache() const { return m_diskCache; }
+
+    // Optional in-memory LRU cache consulted before the disk cache; thread-safe and shareable.
+    // Keyed on the contents of every imported file too, so it never needs clearing after an edit.
+    void setMemoryCache(std::shared_ptr<ShaderMemoryCache> cache) { m_memoryCache = std::move(cache); }
+    const std::shared_ptr<ShaderMemoryCache>& memoryCache() const { return m_memoryCache; }
+
+    // Optional cache of imported modules as serialized IR; thread-safe and shareable
+    void setModuleCache(std::shared_ptr<ModuleCache> cache) { m_moduleCache = std::move(cache); }
+    const std::shared_ptr<ModuleCache>& moduleCache() const { return m_moduleCache; }
+
+    // Optional file system for source and imports (see VirtualFileSystem.h); thread-safe
+    // and shareable. Changing it drops the warm sessions.
+    void setFileSystem(Slang::ComPtr<VirtualFileSystem> fileSystem);
+    const Slang::ComPtr<VirtualFileSystem>& fileSystem() const { return m_fileSystem; }
+
+    // Strong hash of everything that can change the output: source, the transitive
+    // import closure, targets, profile, macros, entry points and the Slang build
+    std::string diskCacheKey(std::string_view source,
+        const std::vector<std::string>& entryPoints,
+        const std::vector<SlangCompileTarget>& targets,
+        const std::string& path,
+        const CompileOptions& options);
+    // Same, with the import closure of source already collected
+    std::string diskCacheKey(std::string_view source,
+        const std::vector<std::string>& entryPoints,
+        const std::vector<SlangCompileTarget>& targets,
+        const std::string& path,
+        const CompileOptions& options,
+        const std::vector<ImportedFile>& imports);
+
+    // Transitive imports of source, resolved through the compiler's file system
+    std::vector<ImportedFile> importClosure(std::string_view source, const std::string& path,
+        const CompileOptions& options) const;
+
+    // Reflection of a linked program for one of its session's targets
+    static std::shared_ptr<const ReflectionTable> extractResourceBindings(slang::IComponentType* program, int targetIndex = 0);
+
+    // Code for one entry point and target of a linked program, without reflection.
+    // The output is empty() if Slang produced no code.
+    static ShaderOutput generateEntryPointCode(slang::IComponentType* linkedProgram,
+        size_t entryIndex, const std::string& entryPoint, size_t targetIndex, SlangCompileTarget target);
+    // One module with every entry point of a linked program; null if Slang produced no code
+    static Slang::ComPtr<slang::IBlob> generateTargetCode(slang::IComponentType* linkedProgram,
+        size_t targetIndex, SlangCompileTarget target);
+    // Whether outputs for target share one whole-program blob under these options
+    static bool sharesTargetCode(const CompileOptions& options, SlangCompileTarget target)
+    {
+        return options.wholeProgram && target == SLANG_SPIRV;
+    }
+
 private:
     Slang::ComPtr<slang::IGlobalSession> m_globalSession = nullptr;
     SlangGlobalSessionDesc desc = {};
+    // Serialises Slang calls on this global session between the compiler and the
+    // lazy programs it handed out, which may be used from other threads
+    std::shared_ptr<std::mutex> m_slangMutex = std::make_shared<std::mutex>();
+    std::chrono::microseconds m_constructionTime{ 0 };
+    CoreModuleSource m_coreModuleSource = CoreModuleSource::Built;
+    CompileOptions m_options;
+    // Declared after the global session so pooled sessions are released first
+    SessionPool m_sessionPool;
+    std::shared_ptr<ShaderDiskCache> m_diskCache;
+    std::shared_ptr<ShaderMemoryCache> m_memoryCache;
+    std::shared_ptr<ModuleCache> m_moduleCache;
+    Slang::ComPtr<VirtualFileSystem> m_fileSystem;
+
+    MemoryBudget m_memoryBudget;
+    MemoryStats m_memoryStats;
+    JobMemoryStats m_lastJobMemory;
+    // Only tracked inside compile(const CompileJob&)
+    bool m_trackingJob = false;
+    size_t m_jobPeakRss = 0;
+    std::weak_ptr<PooledSession> m_jobSession;
+
+    void beginJobAccounting();
+    void sampleJobMemory();
+    void endJobAccounting(const std::vector<ShaderOutput>& outputs);
 
-    std::vector<ShaderOutput> compile(const std::string& source,
+    std::vector<ShaderOutput> compile(std::string_view source,
         const std::vector<std::string>& entryPoints,
-        SlangCompileTarget target, 
+        SlangCompileTarget target,
         const std::string& path);
 
-    std::vector<ShaderResourceBinding> extractResourceBindings(slang::IComponentType* program);
+    std::vector<ShaderOutput> compile(const ShaderSource& source,
+        const std::vector<std::string>& entryPoints,
+        const std::vector<SlangCompileTarget>& targets,
+        const std::string& path,
+        const CompileOptions& options,
+        const std::atomic<bool>* cancel = nullptr,
+        const std::vector<ImportedFile>* imports = nullptr); // Collected here when null
+
+    HashKey128 memoryCacheKey(std::string_view source,
+        const std::vector<std::string>& entryPoints,
+        const std::vector<SlangCompileTarget>& targets,
+        const std::string& path,
+        const CompileOptions& options,
+        const std::vector<ImportedFile>& imports) const;
+
+    std::vector<ShaderOutput> compileWithSlang(const ShaderSource& source,
+        const std::vector<std::string>& entryPoints,
+        const std::vector<SlangCompileTarget>& targets,
+        const std::string& path,
+        const CompileOptions& options,
+        const std::vector<ImportedFile>& imports,
+        const std::atomic<bool>* cancel);
+
+    // Phases of compileWithSlang, shared with compileSpecializations
+    struct LoadedModule
+    {
+        std::shared_ptr<PooledSession> pooled;
+        slang::IModule* module = nullptr; // Owned by the pooled session
+    };
+
+    // Drops a warm session that compiled against an older version of any file in imports
+    LoadedModule loadModule(const ShaderSource& source,
+        const std::vector<SlangCompileTarget>& targets,
+        const std::string& path,
+        const CompileOptions& options,
+        const std::vector<ImportedFile>& imports,
+        const std::atomic<bool>* cancel);
+
+    static Slang::ComPtr<slang::IComponentType> composeProgram(const LoadedModule& loaded,
+        const std::vector<std::string>& entryPoints);
+
+    static Slang::ComPtr<slang::IComponentType> linkProgram(slang::IComponentType* program,
+        const std::atomic<bool>* cancel);
+
+    static std::vector<ShaderOutput> generateCode(slang::IComponentType* linkedProgram,
+        const std::vector<std::string>& entryPoints,
+        const std::vector<SlangCompileTarget>& targets, const CompileOptions& options,
+        const std::atomic<bool>* cancel);
 };
\ No newline at end of file
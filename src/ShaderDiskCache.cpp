@@ -0,0 +1,159 @@
+#include "ShaderDiskCache.h"
+#include "AtomicFile.h"
+#include "MappedFile.h"
+#include "ShaderRecord.h"
+#include <algorithm>
+
+namespace
+{
+    constexpr const char* kRecordExtension = ".sscr";
+}
+
+ShaderDiskCache::ShaderDiskCache(std::filesystem::path directory, uint64_t maxBytes)
+    : m_directory(std::move(directory)), m_maxBytes(maxBytes)
+{
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error)
+    {
+        throw std::runtime_error("Failed to create shader cache directory: " + m_directory.string());
+    }
+
+    uint64_t total = 0;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(m_directory, error))
+    {
+        if (entry.is_regular_file(error) && entry.path().extension() == kRecordExtension)
+        {
+            total += entry.file_size(error);
+        }
+    }
+    m_bytesOnDisk = total;
+}
+
+bool ShaderDiskCache::load(const std::string& key, std::vector<ShaderOutput>& outputs)
+{
+    std::filesystem::path path = recordPath(key);
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error))
+    {
+        ++m_misses;
+        return false;
+    }
+
+    try
+    {
+        // Outputs reference the mapping directly; it is unmapped with the last blob
+        auto file = std::make_shared<MappedFile>(path);
+        if (!readShaderRecord(file->bytes(), file, outputs))
+        {
+            ++m_misses;
+            return false;
+        }
+    }
+    catch (const std::exception&)
+    {
+        // Raced with trim() or another writer; treat as a miss
+        ++m_misses;
+        return false;
+    }
+
+    // Refresh the timestamp so trim() evicts least recently used records first
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    ++m_hits;
+    return true;
+}
+
+void ShaderDiskCache::store(const std::string& key, const std::vector<ShaderOutput>& outputs)
+{
+    std::vector<uint8_t> record = writeShaderRecord(outputs);
+    std::filesystem::path path = recordPath(key);
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    // A record replaced in place (e.g. by another process) no longer counts
+    uintmax_t replacedSize = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        replacedSize = 0;
+    }
+    if (!writeFileAtomically(path, { record }))
+    {
+        return;
+    }
+
+    ++m_writes;
+    m_bytesOnDisk -= std::min<uint64_t>(replacedSize, m_bytesOnDisk);
+    if ((m_bytesOnDisk += record.size()) > m_maxBytes)
+    {
+        trim();
+    }
+}
+
+void ShaderDiskCache::trim()
+{
+    std::lock_guard<std::mutex> lock(m_trimMutex);
+
+    struct RecordFile
+    {
+        std::filesystem::path path;
+        std::filesystem::file_time_type lastUse;
+        uint64_t size;
+    };
+    std::vector<RecordFile> records;
+    uint64_t total = 0;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(m_directory, error))
+    {
+        if (entry.is_regular_file(error) && entry.path().extension() == kRecordExtension)
+        {
+            RecordFile record{ entry.path(), entry.last_write_time(error), entry.file_size(error) };
+            total += record.size;
+            records.push_back(std::move(record));
+        }
+    }
+
+    std::sort(records.begin(), records.end(),
+        [](const RecordFile& a, const RecordFile& b) { return a.lastUse < b.lastUse; });
+
+    // Trim to 90% so a full cache does not rescan on every store
+    uint64_t target = m_maxBytes - m_maxBytes / 10;
+    for (const auto& record : records)
+    {
+        if (total <= target)
+        {
+            break;
+        }
+        if (std::filesystem::remove(record.path, error))
+        {
+            total -= record.size;
+            ++m_evictions;
+        }
+    }
+    m_bytesOnDisk = total;
+}
+
+void ShaderDiskCache::setMaxBytes(uint64_t maxBytes)
+{
+    m_maxBytes = maxBytes;
+    if (m_bytesOnDisk > maxBytes)
+    {
+        trim();
+    }
+}
+
+ShaderDiskCache::Stats ShaderDiskCache::stats() const
+{
+    Stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.writes = m_writes;
+    stats.evictions = m_evictions;
+    stats.bytesOnDisk = m_bytesOnDisk;
+    return stats;
+}
+
+std::filesystem::path ShaderDiskCache::recordPath(const std::string& key) const
+{
+    // Shard by the first two hex digits to keep directories small
+    return m_directory / key.substr(0, 2) / (key + kRecordExtension);
+}
@@ -0,0 +1,52 @@
+#pragma once
+// ShaderDiskCache.h
+// Persistent content-addressed cache of compile results. Each key maps to one
+// ShaderRecord file; reads go through a memory mapping. Safe to share between
+// threads and processes: records are written to a temporary file and renamed.
+#include "ShaderCompiler.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ShaderDiskCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t writes = 0;
+        uint64_t evictions = 0;
+        uint64_t bytesOnDisk = 0;
+    };
+
+    // Creates the directory if needed. maxBytes bounds the total record size;
+    // least recently used records are removed once it is exceeded.
+    explicit ShaderDiskCache(std::filesystem::path directory, uint64_t maxBytes = 512ull << 20);
+
+    // key is a hex digest, see SlangCompiler::diskCacheKey
+    bool load(const std::string& key, std::vector<ShaderOutput>& outputs);
+    void store(const std::string& key, const std::vector<ShaderOutput>& outputs);
+
+    // Removes least recently used records until the cache fits in maxBytes
+    void trim();
+    void setMaxBytes(uint64_t maxBytes);
+
+    Stats stats() const;
+    const std::filesystem::path& directory() const { return m_directory; }
+
+private:
+    std::filesystem::path m_directory;
+    std::atomic<uint64_t> m_maxBytes;
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_misses{ 0 };
+    std::atomic<uint64_t> m_writes{ 0 };
+    std::atomic<uint64_t> m_evictions{ 0 };
+    std::atomic<uint64_t> m_bytesOnDisk{ 0 };
+    std::mutex m_trimMutex;
+
+    std::filesystem::path recordPath(const std::string& key) const;
+};
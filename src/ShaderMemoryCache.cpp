@@ -0,0 +1,104 @@
+#include "ShaderMemoryCache.h"
+#include <algorithm>
+
+ShaderMemoryCache::ShaderMemoryCache(size_t budgetBytes)
+    : m_budgetBytes(budgetBytes)
+{
+}
+
+ShaderMemoryCache::Result ShaderMemoryCache::find(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_index.find(key.hash);
+    if (found == m_index.end() || found->second->key.check != key.check)
+    {
+        ++m_stats.misses;
+        return nullptr;
+    }
+    ++m_stats.hits;
+    m_lru.splice(m_lru.begin(), m_lru, found->second);
+    return found->second->result;
+}
+
+void ShaderMemoryCache::insert(const Key& key, Result result)
+{
+    if (!result)
+    {
+        return;
+    }
+    size_t bytes = footprint(*result);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Larger than the whole budget: caching it would only flush everything else
+    if (bytes > m_budgetBytes)
+    {
+        return;
+    }
+
+    auto found = m_index.find(key.hash);
+    if (found != m_index.end())
+    {
+        m_bytes -= found->second->bytes;
+        m_lru.erase(found->second);
+        m_index.erase(found);
+    }
+
+    m_lru.push_front(Entry{ key, std::move(result), bytes });
+    m_index[key.hash] = m_lru.begin();
+    m_bytes += bytes;
+    evictOverBudget();
+}
+
+void ShaderMemoryCache::setBudget(size_t budgetBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budgetBytes = budgetBytes;
+    evictOverBudget();
+}
+
+void ShaderMemoryCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.evictions += m_lru.size();
+    m_lru.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+ShaderMemoryCache::Stats ShaderMemoryCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.bytes = m_bytes;
+    stats.entries = m_lru.size();
+    return stats;
+}
+
+size_t ShaderMemoryCache::footprint(const std::vector<ShaderOutput>& outputs)
+{
+    // Whole-program outputs share one blob; count it once
+    size_t bytes = sizeof(std::vector<ShaderOutput>) + uniqueCodeBytes(outputs);
+    // Outputs of one target share a table, and targets interleave; count each table once
+    std::vector<const ReflectionTable*> tables;
+    for (const auto& output : outputs)
+    {
+        bytes += sizeof(ShaderOutput) + output.entryPointName.capacity();
+        if (output.reflection && std::find(tables.begin(), tables.end(), output.reflection.get()) == tables.end())
+        {
+            tables.push_back(output.reflection.get());
+            bytes += output.reflection->footprint();
+        }
+    }
+    return bytes;
+}
+
+void ShaderMemoryCache::evictOverBudget()
+{
+    while (m_bytes > m_budgetBytes && !m_lru.empty())
+    {
+        m_bytes -= m_lru.back().bytes;
+        m_index.erase(m_lru.back().key.hash);
+        m_lru.pop_back();
+        ++m_stats.evictions;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+// ShaderMemoryCache.h
+// In-process LRU cache of compile results under a byte budget. Results are
+// shared and immutable, and every method is safe to call from any thread, so
+// one cache can sit in front of several SlangCompilers.
+#include "Hash.h"
+#include "ShaderCompiler.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class ShaderMemoryCache
+{
+public:
+    using Result = std::shared_ptr<const std::vector<ShaderOutput>>;
+
+    using Key = HashKey128;
+
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t bytes = 0;
+        size_t entries = 0;
+    };
+
+    explicit ShaderMemoryCache(size_t budgetBytes = 64u << 20);
+
+    // Returns nullptr on a miss
+    Result find(const Key& key);
+    void insert(const Key& key, Result result);
+
+    void setBudget(size_t budgetBytes);
+    void clear();
+    Stats stats() const;
+
+    // Approximate heap footprint of a result, used against the budget
+    static size_t footprint(const std::vector<ShaderOutput>& outputs);
+
+private:
+    struct Entry
+    {
+        Key key;
+        Result result;
+        size_t bytes;
+    };
+
+    mutable std::mutex m_mutex;
+    size_t m_budgetBytes;
+    size_t m_bytes = 0;
+    // Front is most recently used
+    std::list<Entry> m_lru;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+    Stats m_stats;
+
+    void evictOverBudget();
+};
@@ -0,0 +1,143 @@
+#include "ShaderRecord.h"
+#include "BinaryStream.h"
+#include "ShaderBlob.h"
+#include <algorithm>
+
+namespace
+{
+    constexpr uint32_t kNoTable = ~0u;
+    constexpr uint32_t kOwnCode = ~0u;
+
+    struct RecordHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t outputCount;
+        uint32_t tableCount;
+    };
+
+    struct OutputHeader
+    {
+        uint32_t target;
+        uint32_t entryNameSize;
+        uint32_t tableIndex;
+        uint32_t codeSource; // Index of an earlier output whose code this shares, or kOwnCode
+        uint64_t codeSize;
+    };
+}
+
+std::vector<uint8_t> writeShaderRecord(const std::vector<ShaderOutput>& outputs)
+{
+    // Outputs of one program share a reflection table; write each table once
+    std::vector<const ReflectionTable*> tables;
+    std::vector<uint32_t> tableIndices;
+    for (const auto& output : outputs)
+    {
+        uint32_t tableIndex = kNoTable;
+        if (output.reflection)
+        {
+            auto found = std::find(tables.begin(), tables.end(), output.reflection.get());
+            tableIndex = (uint32_t)(found - tables.begin());
+            if (found == tables.end())
+            {
+                tables.push_back(output.reflection.get());
+            }
+        }
+        tableIndices.push_back(tableIndex);
+    }
+
+    std::vector<uint8_t> buffer;
+    BinaryWriter writer(buffer);
+    writer.write(RecordHeader{ kShaderRecordMagic, kShaderRecordVersion, (uint32_t)outputs.size(), (uint32_t)tables.size() });
+
+    for (const ReflectionTable* table : tables)
+    {
+        table->serialize(writer);
+    }
+
+    for (size_t i = 0; i < outputs.size(); ++i)
+    {
+        const ShaderOutput& output = outputs[i];
+        OutputHeader header{};
+        header.target = static_cast<uint32_t>(output.target);
+        header.entryNameSize = (uint32_t)output.entryPointName.size();
+        header.tableIndex = tableIndices[i];
+        header.codeSource = kOwnCode;
+        // Whole-program outputs reference one blob; write it with the first of them
+        for (size_t earlier = 0; earlier < i && output.codeBlob; ++earlier)
+        {
+            if (outputs[earlier].codeBlob == output.codeBlob)
+            {
+                header.codeSource = (uint32_t)earlier;
+                break;
+            }
+        }
+        header.codeSize = header.codeSource == kOwnCode ? output.bytes().size() : 0;
+        writer.align(8);
+        writer.write(header);
+        writer.write(output.entryPointName.data(), output.entryPointName.size());
+
+        writer.align(8);
+        writer.write(output.bytes().data(), (size_t)header.codeSize);
+    }
+    writer.align(8);
+    return buffer;
+}
+
+bool readShaderRecord(std::span<const uint8_t> record, std::shared_ptr<const void> owner,
+    std::vector<ShaderOutput>& outputs)
+{
+    BinaryReader reader(record);
+    RecordHeader recordHeader{};
+    if (!reader.read(recordHeader) || recordHeader.magic != kShaderRecordMagic ||
+        recordHeader.version != kShaderRecordVersion)
+    {
+        return false;
+    }
+
+    std::vector<std::shared_ptr<const ReflectionTable>> tables;
+    for (uint32_t t = 0; t < recordHeader.tableCount; ++t)
+    {
+        std::shared_ptr<const ReflectionTable> table = ReflectionTable::deserialize(reader);
+        if (!table) return false;
+        tables.push_back(std::move(table));
+    }
+
+    std::vector<ShaderOutput> result;
+    result.reserve(recordHeader.outputCount);
+    for (uint32_t i = 0; i < recordHeader.outputCount; ++i)
+    {
+        OutputHeader header{};
+        if (!reader.align(8) || !reader.read(header)) return false;
+
+        ShaderOutput output;
+        output.target = static_cast<SlangCompileTarget>(header.target);
+        const uint8_t* name = reader.take(header.entryNameSize);
+        if (!name) return false;
+        output.entryPointName.assign(reinterpret_cast<const char*>(name), header.entryNameSize);
+
+        if (header.tableIndex != kNoTable)
+        {
+            if (header.tableIndex >= tables.size()) return false;
+            output.reflection = tables[header.tableIndex];
+        }
+
+        if (!reader.align(8)) return false;
+        if (header.codeSource != kOwnCode)
+        {
+            if (header.codeSource >= i || header.codeSize != 0) return false;
+            output.codeBlob = result[header.codeSource].codeBlob;
+        }
+        else
+        {
+            const uint8_t* code = reader.take(header.codeSize);
+            if (!code && header.codeSize > 0) return false;
+            output.codeBlob = createBlobView(owner, code, header.codeSize);
+        }
+
+        result.push_back(std::move(output));
+    }
+
+    outputs = std::move(result);
+    return true;
+}
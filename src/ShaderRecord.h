@@ -0,0 +1,21 @@
+#pragma once
+// ShaderRecord.h
+// Compact binary encoding of a compile result (code + reflection),
+// used by the on-disk cache. Reflection tables and code blobs shared between
+// outputs are stored once, and shared again when read back. Code is 8-byte aligned so it can be used in place from a
+// mapped file.
+#include "ShaderCompiler.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+constexpr uint32_t kShaderRecordMagic = 0x52435353; // "SSCR"
+constexpr uint32_t kShaderRecordVersion = 4;
+
+std::vector<uint8_t> writeShaderRecord(const std::vector<ShaderOutput>& outputs);
+
+// Returns false if the record is truncated, corrupt or from another version.
+// Code blobs point straight into record; owner must keep that memory alive.
+bool readShaderRecord(std::span<const uint8_t> record, std::shared_ptr<const void> owner,
+    std::vector<ShaderOutput>& outputs);
@@ -0,0 +1,192 @@
+#include "ShaderReflection.h"
+#include <algorithm>
+#include <tuple>
+
+namespace
+{
+    auto slotKey(const ShaderResourceBinding& binding)
+    {
+        return std::make_tuple(binding.set, binding.binding, static_cast<int>(binding.resourceType));
+    }
+
+    // Short names live inside the string object itself
+    size_t heapBytes(const std::string& text)
+    {
+        const char* object = reinterpret_cast<const char*>(&text);
+        bool inline_ = text.data() >= object && text.data() < object + sizeof(text);
+        return inline_ ? 0 : text.capacity() + 1;
+    }
+}
+
+std::shared_ptr<const ReflectionTable> ReflectionTable::Builder::build()
+{
+    std::shared_ptr<ReflectionTable> table(new ReflectionTable());
+    table->m_bindings = std::move(m_bindings);
+    table->m_vertexInputs = std::move(m_vertexInputs);
+    table->m_entryPoints = std::move(m_entryPoints);
+    m_bindings.clear();
+    m_vertexInputs.clear();
+    m_entryPoints.clear();
+
+    const auto& bindings = table->m_bindings;
+    table->m_byName.resize(bindings.size());
+    table->m_bySlot.resize(bindings.size());
+    for (uint32_t i = 0; i < bindings.size(); ++i)
+    {
+        table->m_byName[i] = i;
+        table->m_bySlot[i] = i;
+    }
+    std::stable_sort(table->m_byName.begin(), table->m_byName.end(),
+        [&bindings](uint32_t a, uint32_t b) { return bindings[a].name < bindings[b].name; });
+    std::stable_sort(table->m_bySlot.begin(), table->m_bySlot.end(),
+        [&bindings](uint32_t a, uint32_t b) { return slotKey(bindings[a]) < slotKey(bindings[b]); });
+
+    return table;
+}
+
+const ShaderResourceBinding* ReflectionTable::findByName(std::string_view name) const
+{
+    auto it = std::lower_bound(m_byName.begin(), m_byName.end(), name,
+        [this](uint32_t index, std::string_view value) { return m_bindings[index].name < value; });
+    if (it == m_byName.end() || m_bindings[*it].name != name)
+    {
+        return nullptr;
+    }
+    return &m_bindings[*it];
+}
+
+const ShaderResourceBinding* ReflectionTable::findBySlot(uint32_t set, uint32_t binding,
+    ShaderResourceBinding::ResourceType resourceType) const
+{
+    auto key = std::make_tuple(set, binding, static_cast<int>(resourceType));
+    auto it = std::lower_bound(m_bySlot.begin(), m_bySlot.end(), key,
+        [this](uint32_t index, const auto& value) { return slotKey(m_bindings[index]) < value; });
+    if (it == m_bySlot.end() || slotKey(m_bindings[*it]) != key)
+    {
+        return nullptr;
+    }
+    return &m_bindings[*it];
+}
+
+uint32_t ReflectionTable::stageMask() const
+{
+    uint32_t mask = 0;
+    for (const auto& entryPoint : m_entryPoints)
+    {
+        mask |= 1u << entryPoint.stage;
+    }
+    return mask;
+}
+
+size_t ReflectionTable::footprint() const
+{
+    size_t bytes = sizeof(ReflectionTable) +
+        m_bindings.capacity() * sizeof(ShaderResourceBinding) +
+        m_vertexInputs.capacity() * sizeof(VertexInputAttribute) +
+        m_entryPoints.capacity() * sizeof(EntryPointInfo) +
+        (m_byName.capacity() + m_bySlot.capacity()) * sizeof(uint32_t);
+    for (const auto& binding : m_bindings)
+    {
+        bytes += heapBytes(binding.name);
+    }
+    for (const auto& attribute : m_vertexInputs)
+    {
+        bytes += heapBytes(attribute.name) + heapBytes(attribute.semanticName);
+    }
+    for (const auto& entryPoint : m_entryPoints)
+    {
+        bytes += heapBytes(entryPoint.name);
+    }
+    return bytes;
+}
+
+void ReflectionTable::serialize(BinaryWriter& writer) const
+{
+    writer.write((uint32_t)m_bindings.size());
+    writer.write((uint32_t)m_vertexInputs.size());
+    writer.write((uint32_t)m_entryPoints.size());
+
+    for (const auto& binding : m_bindings)
+    {
+        writer.write(static_cast<uint32_t>(binding.resourceType));
+        writer.write(binding.binding);
+        writer.write(binding.set);
+        writer.write(binding.count);
+        writer.write(static_cast<uint32_t>(binding.shape));
+        writer.write(static_cast<uint32_t>(binding.access));
+        writer.write(binding.sizeInBytes);
+        writer.write(binding.stageMask);
+        writer.writeString(binding.name);
+    }
+    for (const auto& attribute : m_vertexInputs)
+    {
+        writer.writeString(attribute.name);
+        writer.writeString(attribute.semanticName);
+        writer.write(attribute.semanticIndex);
+        writer.write(attribute.location);
+        writer.write(attribute.scalarType);
+        writer.write(attribute.componentCount);
+    }
+    for (const auto& entryPoint : m_entryPoints)
+    {
+        writer.writeString(entryPoint.name);
+        writer.write(static_cast<uint32_t>(entryPoint.stage));
+        writer.write(entryPoint.threadGroupSize);
+    }
+}
+
+std::shared_ptr<const ReflectionTable> ReflectionTable::deserialize(BinaryReader& reader)
+{
+    uint32_t bindingCount = 0, vertexInputCount = 0, entryPointCount = 0;
+    if (!reader.read(bindingCount) || !reader.read(vertexInputCount) || !reader.read(entryPointCount))
+    {
+        return nullptr;
+    }
+
+    Builder builder;
+    for (uint32_t i = 0; i < bindingCount; ++i)
+    {
+        ShaderResourceBinding binding;
+        uint32_t resourceType = 0, shape = 0, access = 0;
+        std::string_view name;
+        if (!reader.read(resourceType) || !reader.read(binding.binding) || !reader.read(binding.set) ||
+            !reader.read(binding.count) || !reader.read(shape) || !reader.read(access) ||
+            !reader.read(binding.sizeInBytes) || !reader.read(binding.stageMask) || !reader.readString(name))
+        {
+            return nullptr;
+        }
+        binding.name = name;
+        binding.resourceType = static_cast<ShaderResourceBinding::ResourceType>(resourceType);
+        binding.shape = static_cast<SlangResourceShape>(shape);
+        binding.access = static_cast<SlangResourceAccess>(access);
+        builder.add(std::move(binding));
+    }
+    for (uint32_t i = 0; i < vertexInputCount; ++i)
+    {
+        VertexInputAttribute attribute;
+        std::string_view name, semanticName;
+        if (!reader.readString(name) || !reader.readString(semanticName) ||
+            !reader.read(attribute.semanticIndex) || !reader.read(attribute.location) ||
+            !reader.read(attribute.scalarType) || !reader.read(attribute.componentCount))
+        {
+            return nullptr;
+        }
+        attribute.name = name;
+        attribute.semanticName = semanticName;
+        builder.addVertexInput(std::move(attribute));
+    }
+    for (uint32_t i = 0; i < entryPointCount; ++i)
+    {
+        EntryPointInfo entryPoint;
+        uint32_t stage = 0;
+        std::string_view name;
+        if (!reader.readString(name) || !reader.read(stage) || !reader.read(entryPoint.threadGroupSize))
+        {
+            return nullptr;
+        }
+        entryPoint.name = name;
+        entryPoint.stage = static_cast<SlangStage>(stage);
+        builder.addEntryPoint(std::move(entryPoint));
+    }
+    return builder.build();
+}
@@ -0,0 +1,102 @@
+#pragma once
+// ShaderReflection.h
+// Reflection of a linked program, computed once and shared immutably by every
+// ShaderOutput produced from that program: resource bindings (including
+// nested blocks, arrays and entry-point uniforms), push constants, vertex
+// inputs and entry-point stages. See PipelineLayout.h for ready-made layouts.
+#include "BinaryStream.h"
+#include <slang.h>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct ShaderResourceBinding
+{
+    enum class ResourceType { ConstantBuffer, StructuredBuffer, Texture, Sampler, UAV,
+        TypedBuffer, CombinedTextureSampler, AccelerationStructure, PushConstant };
+
+    ResourceType resourceType;
+    uint32_t binding;   // Vulkan binding or D3D register
+    uint32_t set;       // Vulkan set or D3D space
+    uint32_t count = 1; // Array element count, 0 for unbounded arrays
+
+    // Members of structs and blocks use dotted paths, e.g. "material.albedo"
+    std::string name;
+
+    SlangResourceShape shape = SLANG_RESOURCE_NONE; // Textures and buffers, incl. array/multisample flags
+    SlangResourceAccess access = SLANG_RESOURCE_ACCESS_NONE;
+    uint32_t sizeInBytes = 0; // Uniform data size of constant buffers and push constants
+    uint32_t stageMask = 0;   // Bit (1 << SlangStage) for each stage that can see the binding
+};
+
+struct VertexInputAttribute
+{
+    std::string name;
+    std::string semanticName;
+    uint32_t semanticIndex = 0;
+    uint32_t location = 0;
+    uint32_t scalarType = 0;     // slang::TypeReflection::ScalarType
+    uint32_t componentCount = 0; // 1-4, rows * columns for matrices
+};
+
+struct EntryPointInfo
+{
+    std::string name;
+    SlangStage stage = SLANG_STAGE_NONE;
+    uint32_t threadGroupSize[3] = { 0, 0, 0 }; // Compute, mesh and amplification stages
+};
+
+// Flat, immutable table: contiguous arrays and two sorted indices for
+// O(log n) binding lookup by name or by slot. Entries own their names, so
+// copies taken from the table outlive it.
+class ReflectionTable
+{
+public:
+    class Builder
+    {
+    public:
+        void add(ShaderResourceBinding binding) { m_bindings.push_back(std::move(binding)); }
+        void addVertexInput(VertexInputAttribute attribute) { m_vertexInputs.push_back(std::move(attribute)); }
+        void addEntryPoint(EntryPointInfo entryPoint) { m_entryPoints.push_back(std::move(entryPoint)); }
+        std::shared_ptr<const ReflectionTable> build();
+
+    private:
+        std::vector<ShaderResourceBinding> m_bindings;
+        std::vector<VertexInputAttribute> m_vertexInputs;
+        std::vector<EntryPointInfo> m_entryPoints;
+    };
+
+    ReflectionTable(const ReflectionTable&) = delete;
+    ReflectionTable& operator=(const ReflectionTable&) = delete;
+
+    // Declaration order
+    std::span<const ShaderResourceBinding> bindings() const { return m_bindings; }
+    std::span<const VertexInputAttribute> vertexInputs() const { return m_vertexInputs; }
+    std::span<const EntryPointInfo> entryPoints() const { return m_entryPoints; }
+
+    const ShaderResourceBinding* findByName(std::string_view name) const;
+    // HLSL register classes share slot numbers (t0 and s0), so the type is part of the slot
+    const ShaderResourceBinding* findBySlot(uint32_t set, uint32_t binding,
+        ShaderResourceBinding::ResourceType resourceType) const;
+
+    // Union of the stages of all entry points, as (1 << SlangStage) bits
+    uint32_t stageMask() const;
+
+    // Heap bytes held by the table, for cache budgeting
+    size_t footprint() const;
+
+    void serialize(BinaryWriter& writer) const;
+    static std::shared_ptr<const ReflectionTable> deserialize(BinaryReader& reader);
+
+private:
+    ReflectionTable() = default;
+
+    std::vector<ShaderResourceBinding> m_bindings;
+    std::vector<VertexInputAttribute> m_vertexInputs;
+    std::vector<EntryPointInfo> m_entryPoints;
+    std::vector<uint32_t> m_byName;
+    std::vector<uint32_t> m_bySlot;
+};
@@ -0,0 +1,328 @@
+#include "ShaderWatcher.h"
+#include "ImportScanner.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Editors save in several steps (truncate, write, rename); changes that
+    // arrive this close together are handled as one batch
+    constexpr std::chrono::milliseconds kSettleTime{ 8 };
+    constexpr std::chrono::milliseconds kPollInterval{ 50 };
+
+    // Not canonical: symlinks are kept, so paths match the ones the file system caches under
+    std::filesystem::path normalise(const std::filesystem::path& path)
+    {
+        std::error_code error;
+        std::filesystem::path absolute = std::filesystem::absolute(path, error);
+        return (error ? path : absolute).lexically_normal();
+    }
+}
+
+ShaderWatcher::ShaderWatcher(SlangCompiler& compiler)
+    : m_compiler(compiler)
+{
+#ifdef __linux__
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+#ifdef __linux__
+    if (m_inotify >= 0)
+    {
+        close(m_inotify);
+    }
+#endif
+}
+
+CompileResult ShaderWatcher::addShader(const std::filesystem::path& path, std::vector<std::string> entryPoints,
+    std::vector<SlangCompileTarget> targets)
+{
+    std::filesystem::path shaderPath = resolve(path);
+    WatchedShader& shader = m_shaders[shaderPath];
+    shader.entryPoints = std::move(entryPoints);
+    shader.targets = std::move(targets);
+    return rebuild(shaderPath, shader);
+}
+
+ShaderWatcher::Outputs ShaderWatcher::outputs(const std::filesystem::path& shader) const
+{
+    std::lock_guard<std::mutex> lock(m_publishMutex);
+    auto found = m_published.find(resolve(shader));
+    return found != m_published.end() ? found->second : nullptr;
+}
+
+size_t ShaderWatcher::poll(std::chrono::milliseconds timeout)
+{
+    std::set<std::filesystem::path> changed = waitForChanges(timeout);
+    if (changed.empty())
+    {
+        return 0;
+    }
+    auto noticed = std::chrono::steady_clock::now();
+
+    std::set<std::filesystem::path> affected;
+    for (const auto& file : changed)
+    {
+        auto found = m_dependents.find(file);
+        if (found == m_dependents.end())
+        {
+            continue;
+        }
+        affected.insert(found->second.begin(), found->second.end());
+    }
+    if (affected.empty())
+    {
+        return 0;
+    }
+
+    // Once per batch, and only what changed: the file system is shared with every
+    // other compile, and an edit may import a file an earlier lookup found missing.
+    // Cached results are keyed on import contents and the compiler replaces warm
+    // sessions that loaded an older import, so nothing else needs dropping.
+    if (VirtualFileSystem* fileSystem = m_compiler.fileSystem().get())
+    {
+        fileSystem->invalidate(std::vector<std::filesystem::path>(changed.begin(), changed.end()));
+    }
+
+    for (const auto& path : affected)
+    {
+        Rebuild rebuilt;
+        rebuilt.shader = path;
+        rebuilt.result = rebuild(path, m_shaders.at(path));
+        rebuilt.latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - noticed);
+        if (m_callback)
+        {
+            m_callback(rebuilt);
+        }
+    }
+    return affected.size();
+}
+
+void ShaderWatcher::run()
+{
+    m_stopping = false;
+    while (!m_stopping)
+    {
+        poll(std::chrono::milliseconds(100));
+    }
+}
+
+std::vector<std::filesystem::path> ShaderWatcher::dependents(const std::filesystem::path& file) const
+{
+    auto found = m_dependents.find(resolve(file));
+    if (found == m_dependents.end())
+    {
+        return {};
+    }
+    return { found->second.begin(), found->second.end() };
+}
+
+std::filesystem::path ShaderWatcher::resolve(const std::filesystem::path& path) const
+{
+    VirtualFileSystem* fileSystem = m_compiler.fileSystem().get();
+    if (!fileSystem)
+    {
+        return normalise(path);
+    }
+    std::filesystem::path onDisk = fileSystem->locate(path);
+    if (!onDisk.empty())
+    {
+        return normalise(onDisk);
+    }
+    return fileSystem->exists(path) ? path.lexically_normal() : normalise(path);
+}
+
+CompileResult ShaderWatcher::rebuild(const std::filesystem::path& path, WatchedShader& shader)
+{
+    VirtualFileSystem* fileSystem = m_compiler.fileSystem().get();
+
+    // Read and resolved the way the compiler will, so the graph matches what it imports
+    CompileJob job;
+    if (!fileSystem || !fileSystem->readText(path, job.source))
+    {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        job.source.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+    job.path = path.string();
+    job.entryPoints = shader.entryPoints;
+    job.targets = shader.targets;
+    job.options = m_compiler.compileOptions();
+
+    // The graph is refreshed on every rebuild, since an edit can add or drop imports
+    std::vector<std::filesystem::path> dependencies{ path };
+    for (const auto& import : collectImportClosure(job.source, path, job.options.searchPaths, fileSystem))
+    {
+        // Imports found through relative search paths are relative to the roots, not the working directory
+        dependencies.push_back(resolve(import.path));
+    }
+    setDependencies(path, shader, std::move(dependencies));
+
+    CompileResult result;
+    try
+    {
+        result.outputs = m_compiler.compile(job);
+        for (const auto& output : result.outputs)
+        {
+            if (output.empty())
+            {
+                result.error = "No code generated for entry point: " + output.entryPointName;
+                break;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        result.error = e.what();
+    }
+
+    // Publish only complete results, swapping the whole set in one step
+    if (result.succeeded())
+    {
+        auto published = std::make_shared<const std::vector<ShaderOutput>>(result.outputs);
+        std::lock_guard<std::mutex> lock(m_publishMutex);
+        m_published[path] = std::move(published);
+    }
+    return result;
+}
+
+void ShaderWatcher::setDependencies(const std::filesystem::path& path, WatchedShader& shader,
+    std::vector<std::filesystem::path> dependencies)
+{
+    for (const auto& file : shader.dependencies)
+    {
+        auto found = m_dependents.find(file);
+        if (found != m_dependents.end() && found->second.erase(path) && found->second.empty())
+        {
+            m_dependents.erase(found);
+        }
+    }
+    for (const auto& file : dependencies)
+    {
+        m_dependents[file].insert(path);
+        watchFile(file);
+    }
+    shader.dependencies = std::move(dependencies);
+}
+
+void ShaderWatcher::watchFile(const std::filesystem::path& file)
+{
+#ifdef __linux__
+    if (m_inotify >= 0)
+    {
+        // Watch directories rather than files: editors often replace a file
+        // by renaming a new one over it, which would orphan a file watch
+        std::filesystem::path directory = file.parent_path();
+        for (const auto& [descriptor, watched] : m_watchedDirectories)
+        {
+            if (watched == directory)
+            {
+                return;
+            }
+        }
+        int descriptor = inotify_add_watch(m_inotify, directory.c_str(),
+            IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+        if (descriptor >= 0)
+        {
+            m_watchedDirectories[descriptor] = directory;
+        }
+        return;
+    }
+#endif
+    if (!m_stamps.count(file))
+    {
+        m_stamps[file] = stamp(file);
+    }
+}
+
+std::set<std::filesystem::path> ShaderWatcher::waitForChanges(std::chrono::milliseconds timeout)
+{
+    std::set<std::filesystem::path> changed;
+#ifdef __linux__
+    if (m_inotify >= 0)
+    {
+        pollfd descriptor{ m_inotify, POLLIN, 0 };
+        if (::poll(&descriptor, 1, (int)timeout.count()) <= 0)
+        {
+            return changed;
+        }
+        do
+        {
+            std::set<std::filesystem::path> batch = readInotifyEvents();
+            changed.insert(batch.begin(), batch.end());
+        } while (::poll(&descriptor, 1, (int)kSettleTime.count()) > 0);
+        return changed;
+    }
+#endif
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;)
+    {
+        for (auto& [file, lastStamp] : m_stamps)
+        {
+            FileStamp current = stamp(file);
+            if (current != lastStamp)
+            {
+                lastStamp = current;
+                changed.insert(file);
+            }
+        }
+        if (!changed.empty() || std::chrono::steady_clock::now() >= deadline)
+        {
+            return changed;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(kPollInterval,
+            deadline - std::chrono::steady_clock::now()));
+    }
+}
+
+std::set<std::filesystem::path> ShaderWatcher::readInotifyEvents()
+{
+    std::set<std::filesystem::path> changed;
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    for (;;)
+    {
+        ssize_t length = read(m_inotify, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            break;
+        }
+        for (char* cursor = buffer; cursor < buffer + length;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+            auto directory = m_watchedDirectories.find(event->wd);
+            if (directory != m_watchedDirectories.end() && event->len > 0)
+            {
+                std::filesystem::path file = directory->second / event->name;
+                // Events for unrelated files in the same directory are ignored
+                if (m_dependents.count(file))
+                {
+                    changed.insert(file);
+                }
+            }
+            cursor += sizeof(inotify_event) + event->len;
+        }
+    }
+#endif
+    return changed;
+}
+
+ShaderWatcher::FileStamp ShaderWatcher::stamp(const std::filesystem::path& file)
+{
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(file, error);
+    auto size = std::filesystem::file_size(file, error);
+    return { error ? std::filesystem::file_time_type{} : time, error ? 0 : size };
+}
@@ -0,0 +1,97 @@
+#pragma once
+// ShaderWatcher.h
+// Watch mode: recompiles shaders when they, or anything they import, change on
+// disk. A dependency graph of import edges maps each changed file to the
+// shaders that reach it, so editing common.slang recompiles its importers and
+// nothing else. Uses inotify on Linux and polls timestamps elsewhere.
+#include "ShaderCompiler.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ShaderWatcher
+{
+public:
+    using Outputs = std::shared_ptr<const std::vector<ShaderOutput>>;
+
+    // Reported once per rebuilt shader
+    struct Rebuild
+    {
+        std::filesystem::path shader;
+        CompileResult result;
+        // From noticing the change to publishing the result
+        std::chrono::microseconds latency{ 0 };
+    };
+    using Callback = std::function<void(const Rebuild&)>;
+
+    // The compiler is used only from the thread that calls addShader/poll/run
+    explicit ShaderWatcher(SlangCompiler& compiler);
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // Compiles the shader now and watches it and its imports from then on
+    CompileResult addShader(const std::filesystem::path& path, std::vector<std::string> entryPoints,
+        std::vector<SlangCompileTarget> targets);
+
+    // Called on the watching thread after each rebuild, successful or not
+    void setCallback(Callback callback) { m_callback = std::move(callback); }
+
+    // Latest complete outputs (entry-point major). A failed rebuild keeps the
+    // previous ones, so readers never see a half-updated set. Thread-safe.
+    Outputs outputs(const std::filesystem::path& shader) const;
+
+    // Waits up to timeout for changes, then rebuilds the affected shaders.
+    // Returns the number of shaders rebuilt.
+    size_t poll(std::chrono::milliseconds timeout);
+    // Calls poll() until stop() is called, from another thread or a callback
+    void run();
+    void stop() { m_stopping = true; }
+
+    // Watched shaders that include file, directly or through imports
+    std::vector<std::filesystem::path> dependents(const std::filesystem::path& file) const;
+    bool usesInotify() const { return m_inotify >= 0; }
+
+private:
+    struct WatchedShader
+    {
+        std::vector<std::string> entryPoints;
+        std::vector<SlangCompileTarget> targets;
+        // The shader itself and every file in its import closure
+        std::vector<std::filesystem::path> dependencies;
+    };
+    using FileStamp = std::pair<std::filesystem::file_time_type, uintmax_t>;
+
+    SlangCompiler& m_compiler;
+    std::map<std::filesystem::path, WatchedShader> m_shaders;
+    std::map<std::filesystem::path, std::set<std::filesystem::path>> m_dependents; // File -> shaders
+    Callback m_callback;
+    std::atomic<bool> m_stopping{ false };
+
+    mutable std::mutex m_publishMutex;
+    std::map<std::filesystem::path, Outputs> m_published;
+
+    int m_inotify = -1;
+    std::map<int, std::filesystem::path> m_watchedDirectories; // Watch descriptor -> directory
+    std::map<std::filesystem::path, FileStamp> m_stamps;       // Polling fallback
+
+    // Absolute path of the file on disk, found through the compiler's file system
+    // roots when it has one; bundled files keep the path they were added under
+    std::filesystem::path resolve(const std::filesystem::path& path) const;
+    CompileResult rebuild(const std::filesystem::path& path, WatchedShader& shader);
+    void setDependencies(const std::filesystem::path& path, WatchedShader& shader,
+        std::vector<std::filesystem::path> dependencies);
+    void watchFile(const std::filesystem::path& file);
+    std::set<std::filesystem::path> waitForChanges(std::chrono::milliseconds timeout);
+    std::set<std::filesystem::path> readInotifyEvents();
+    static FileStamp stamp(const std::filesystem::path& file);
+};
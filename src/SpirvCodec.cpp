@@ -0,0 +1,432 @@
+#include "SpirvCodec.h"
+#include "BinaryStream.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+    constexpr uint32_t kSpirvMagic = 0x07230203;
+    constexpr size_t kSpirvHeaderWords = 5;
+    constexpr uint32_t kMaxWordCount = 0xffff;
+
+    struct EncodedHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t wordCount; // Of the decoded module, header included
+        uint32_t spirvVersion;
+        uint32_t generator;
+        uint32_t bound;
+        uint32_t schema;
+        uint32_t reserved;
+    };
+
+    // How an opcode's operands are laid out; unknown opcodes are all varint literals.
+    // Encoder and decoder share the table, so a wrong shape only costs size.
+    constexpr uint8_t kAllIds = 0xff;
+
+    struct OpShape
+    {
+        bool hasType = false;
+        bool hasResult = false;
+        uint8_t ids = 0;          // Id operands after the result, or kAllIds
+        bool rawLiterals = false; // Strings and float bits do not shrink as varints
+    };
+
+    constexpr size_t kShapeCount = 512;
+
+    constexpr std::array<OpShape, kShapeCount> makeShapes()
+    {
+        std::array<OpShape, kShapeCount> shapes{};
+        auto set = [&](uint32_t op, bool hasType, bool hasResult, uint8_t ids, bool rawLiterals = false)
+        {
+            shapes[op] = { hasType, hasResult, ids, rawLiterals };
+        };
+        auto setRange = [&](uint32_t first, uint32_t last, bool hasType, bool hasResult, uint8_t ids)
+        {
+            for (uint32_t op = first; op <= last; ++op)
+            {
+                set(op, hasType, hasResult, ids);
+            }
+        };
+
+        set(5, false, false, 1, true);    // OpName
+        set(6, false, false, 1, true);    // OpMemberName
+        set(7, false, true, 0, true);     // OpString
+        set(8, false, false, 1);          // OpLine
+        set(11, false, true, 0, true);    // OpExtInstImport
+        set(12, true, true, 1);           // OpExtInst
+        set(16, false, false, 1);         // OpExecutionMode
+        setRange(19, 22, false, true, 0); // OpTypeVoid .. OpTypeFloat
+        set(23, false, true, 1);          // OpTypeVector
+        set(24, false, true, 1);          // OpTypeMatrix
+        set(25, false, true, 1);          // OpTypeImage
+        set(26, false, true, 0);          // OpTypeSampler
+        set(27, false, true, 1);          // OpTypeSampledImage
+        set(28, false, true, kAllIds);    // OpTypeArray
+        set(29, false, true, 1);          // OpTypeRuntimeArray
+        set(30, false, true, kAllIds);    // OpTypeStruct
+        set(32, false, true, 0);          // OpTypePointer
+        set(33, false, true, kAllIds);    // OpTypeFunction
+        set(41, true, true, 0);           // OpConstantTrue
+        set(42, true, true, 0);           // OpConstantFalse
+        set(43, true, true, 0, true);     // OpConstant
+        set(44, true, true, kAllIds);     // OpConstantComposite
+        set(46, true, true, 0);           // OpConstantNull
+        set(50, true, true, 0, true);     // OpSpecConstant
+        set(54, true, true, 0);           // OpFunction
+        set(55, true, true, 0);           // OpFunctionParameter
+        set(57, true, true, kAllIds);     // OpFunctionCall
+        set(59, true, true, 0);           // OpVariable
+        set(61, true, true, 1);           // OpLoad
+        set(62, false, false, 2);         // OpStore
+        set(65, true, true, kAllIds);     // OpAccessChain
+        set(66, true, true, kAllIds);     // OpInBoundsAccessChain
+        set(71, false, false, 1);         // OpDecorate
+        set(72, false, false, 1);         // OpMemberDecorate
+        set(79, true, true, 2);           // OpVectorShuffle
+        set(80, true, true, kAllIds);     // OpCompositeConstruct
+        set(81, true, true, 1);           // OpCompositeExtract
+        set(82, true, true, 2);           // OpCompositeInsert
+        set(86, true, true, kAllIds);     // OpSampledImage
+        setRange(87, 94, true, true, 2);  // OpImageSample*
+        set(95, true, true, 2);           // OpImageFetch
+        set(98, true, true, 2);           // OpImageRead
+        set(99, false, false, 3);         // OpImageWrite
+        set(100, true, true, 1);          // OpImage
+        setRange(109, 124, true, true, kAllIds); // Conversions
+        setRange(126, 155, true, true, kAllIds); // Arithmetic, OpAny, OpAll
+        setRange(164, 200, true, true, kAllIds); // Logic, comparison, bitwise
+        setRange(207, 215, true, true, kAllIds); // Derivatives
+        set(245, true, true, kAllIds);    // OpPhi
+        set(246, false, false, 2);        // OpLoopMerge
+        set(247, false, false, 1);        // OpSelectionMerge
+        set(248, false, true, 0);         // OpLabel
+        set(249, false, false, 1);        // OpBranch
+        set(250, false, false, 3);        // OpBranchConditional
+        set(251, false, false, 1);        // OpSwitch
+        set(254, false, false, 1);        // OpReturnValue
+        return shapes;
+    }
+
+    constexpr std::array<OpShape, kShapeCount> kShapes = makeShapes();
+
+    // The most frequent opcodes get the smallest codes; the first eight fit a one-byte header
+    constexpr uint16_t kFrequentOps[] = {
+        71, 61, 62, 65, 32, 59, 43, 81, 133, 129, 248, 249, 72, 5, 80, 79,
+        57, 148, 12, 145, 142, 131, 247, 250, 253, 254, 54, 56, 55, 23, 6, 30,
+        44, 128, 124, 86, 87,
+    };
+    constexpr uint32_t kFrequentCount = (uint32_t)std::size(kFrequentOps);
+
+    constexpr std::array<uint32_t, kShapeCount> makeRemap()
+    {
+        std::array<uint32_t, kShapeCount> remap{};
+        for (uint32_t op = 0; op < kShapeCount; ++op)
+        {
+            remap[op] = op + kFrequentCount;
+        }
+        for (uint32_t i = 0; i < kFrequentCount; ++i)
+        {
+            remap[kFrequentOps[i]] = i;
+        }
+        return remap;
+    }
+
+    constexpr std::array<uint32_t, kShapeCount> kRemap = makeRemap();
+
+    OpShape shapeOf(uint32_t op)
+    {
+        return op < kShapeCount ? kShapes[op] : OpShape{};
+    }
+
+    uint32_t remapOpcode(uint32_t op)
+    {
+        return op < kShapeCount ? kRemap[op] : op + kFrequentCount;
+    }
+
+    uint32_t unmapOpcode(uint32_t code)
+    {
+        return code < kFrequentCount ? kFrequentOps[code] : code - kFrequentCount;
+    }
+
+    bool isDebugOp(uint32_t op)
+    {
+        // OpSourceContinued, OpSource, OpSourceExtension, OpName, OpMemberName,
+        // OpLine, OpNoLine, OpModuleProcessed
+        return (op >= 2 && op <= 6) || op == 8 || op == 317 || op == 330;
+    }
+
+    uint32_t zigzag(uint32_t delta)
+    {
+        return (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+    }
+
+    uint32_t unzigzag(uint32_t value)
+    {
+        return (value >> 1) ^ (0u - (value & 1));
+    }
+
+    void writeVarint(std::vector<uint8_t>& out, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    [[noreturn]] void throwCorrupt()
+    {
+        throw std::runtime_error("Encoded SPIR-V is truncated or corrupt");
+    }
+
+    class VarintReader
+    {
+    public:
+        VarintReader(const uint8_t* data, const uint8_t* end) : m_data(data), m_end(end) {}
+
+        uint32_t next()
+        {
+            // Ids and small literals are mostly one byte
+            if (m_data < m_end && *m_data < 0x80)
+            {
+                return *m_data++;
+            }
+            // Away from the end no byte needs a bounds check
+            if (m_end - m_data >= 5)
+            {
+                const uint8_t* bytes = m_data;
+                uint32_t value = bytes[0] & 0x7f;
+                if (bytes[1] < 0x80) { m_data += 2; return value | (uint32_t)bytes[1] << 7; }
+                value |= (uint32_t)(bytes[1] & 0x7f) << 7;
+                if (bytes[2] < 0x80) { m_data += 3; return value | (uint32_t)bytes[2] << 14; }
+                value |= (uint32_t)(bytes[2] & 0x7f) << 14;
+                if (bytes[3] < 0x80) { m_data += 4; return value | (uint32_t)bytes[3] << 21; }
+                value |= (uint32_t)(bytes[3] & 0x7f) << 21;
+                if (bytes[4] < 0x80) { m_data += 5; return value | (uint32_t)bytes[4] << 28; }
+                throwCorrupt();
+            }
+            uint32_t value = 0;
+            for (uint32_t shift = 0; shift < 35; shift += 7)
+            {
+                if (m_data == m_end)
+                {
+                    throwCorrupt();
+                }
+                uint8_t byte = *m_data++;
+                value |= (uint32_t)(byte & 0x7f) << shift;
+                if (byte < 0x80)
+                {
+                    return value;
+                }
+            }
+            throwCorrupt();
+        }
+
+        void raw(uint32_t* words, size_t count)
+        {
+            if ((size_t)(m_end - m_data) < count * 4)
+            {
+                throwCorrupt();
+            }
+            std::memcpy(words, m_data, count * 4);
+            m_data += count * 4;
+        }
+
+        bool done() const { return m_data == m_end; }
+
+    private:
+        const uint8_t* m_data;
+        const uint8_t* m_end;
+    };
+
+    bool readHeader(std::span<const uint8_t> data, EncodedHeader& header)
+    {
+        BinaryReader reader(data);
+        // Every encoded byte yields at most one instruction of kMaxWordCount words
+        return reader.read(header) && header.magic == kEncodedSpirvMagic &&
+            header.version == kEncodedSpirvVersion && header.wordCount >= kSpirvHeaderWords &&
+            header.wordCount - kSpirvHeaderWords <= (uint64_t)reader.remaining() * kMaxWordCount;
+    }
+}
+
+std::vector<uint8_t> encodeSpirv(std::span<const uint8_t> spirv, const SpirvEncodeOptions& options)
+{
+    if (spirv.size() % 4 != 0 || spirv.size() < kSpirvHeaderWords * 4)
+    {
+        throw std::runtime_error("Not a SPIR-V module");
+    }
+    // Copied so blobs at any alignment can be encoded
+    std::vector<uint32_t> words(spirv.size() / 4);
+    std::memcpy(words.data(), spirv.data(), spirv.size());
+    if (words[0] != kSpirvMagic)
+    {
+        throw std::runtime_error("Not a SPIR-V module, or not in host byte order");
+    }
+
+    std::vector<uint8_t> encoded;
+    encoded.reserve(spirv.size() / 2);
+    BinaryWriter writer(encoded);
+    EncodedHeader header{ kEncodedSpirvMagic, kEncodedSpirvVersion, 0, words[1], words[2], words[3], words[4], 0 };
+    writer.write(header);
+
+    uint32_t wordCount = kSpirvHeaderWords;
+    uint32_t lastResult = 0;
+    for (size_t position = kSpirvHeaderWords; position < words.size();)
+    {
+        uint32_t op = words[position] & 0xffff;
+        uint32_t count = words[position] >> 16;
+        if (count == 0 || count > words.size() - position)
+        {
+            throw std::runtime_error("SPIR-V instruction at word " + std::to_string(position) + " has a bad word count");
+        }
+        const uint32_t* operands = words.data() + position + 1;
+        position += count;
+        if (options.stripDebug && isDebugOp(op))
+        {
+            continue;
+        }
+        wordCount += count;
+
+        uint32_t length = count - 1;
+        writeVarint(encoded, (remapOpcode(op) << 4) | std::min(length, 15u));
+        if (length >= 15)
+        {
+            writeVarint(encoded, length - 15);
+        }
+
+        OpShape shape = shapeOf(op);
+        uint32_t i = 0;
+        if (shape.hasType && i < length)
+        {
+            writeVarint(encoded, operands[i++]);
+        }
+        if (shape.hasResult && i < length)
+        {
+            writeVarint(encoded, zigzag(operands[i] - lastResult));
+            lastResult = operands[i++];
+        }
+        uint32_t idEnd = shape.ids == kAllIds ? length : std::min(length, i + shape.ids);
+        for (; i < idEnd; ++i)
+        {
+            writeVarint(encoded, zigzag(lastResult - operands[i]));
+        }
+        if (shape.rawLiterals)
+        {
+            writer.write(operands + i, (length - i) * 4);
+        }
+        else
+        {
+            for (; i < length; ++i)
+            {
+                writeVarint(encoded, operands[i]);
+            }
+        }
+    }
+
+    header.wordCount = wordCount;
+    std::memcpy(encoded.data(), &header, sizeof(header));
+    return encoded;
+}
+
+bool isEncodedSpirv(std::span<const uint8_t> data)
+{
+    EncodedHeader header;
+    return readHeader(data, header);
+}
+
+size_t decodedSpirvSize(std::span<const uint8_t> encoded)
+{
+    EncodedHeader header;
+    return readHeader(encoded, header) ? (size_t)header.wordCount * 4 : 0;
+}
+
+size_t decodeSpirv(std::span<const uint8_t> encoded, std::span<uint32_t> words)
+{
+    EncodedHeader header;
+    if (!readHeader(encoded, header))
+    {
+        throwCorrupt();
+    }
+    if (words.size() < header.wordCount)
+    {
+        throw std::runtime_error("SPIR-V decode buffer is too small");
+    }
+
+    uint32_t* out = words.data();
+    uint32_t* outEnd = out + header.wordCount;
+    *out++ = kSpirvMagic;
+    *out++ = header.spirvVersion;
+    *out++ = header.generator;
+    *out++ = header.bound;
+    *out++ = header.schema;
+
+    VarintReader reader(encoded.data() + sizeof(header), encoded.data() + encoded.size());
+    uint32_t lastResult = 0;
+    while (out < outEnd)
+    {
+        uint32_t head = reader.next();
+        uint32_t length = head & 15;
+        if (length == 15)
+        {
+            uint32_t extra = reader.next();
+            if (extra >= kMaxWordCount)
+            {
+                throwCorrupt();
+            }
+            length += extra;
+        }
+        uint32_t op = unmapOpcode(head >> 4);
+        if (op > 0xffff || length >= kMaxWordCount || length >= (size_t)(outEnd - out))
+        {
+            throwCorrupt();
+        }
+        *out++ = ((length + 1) << 16) | op;
+
+        OpShape shape = shapeOf(op);
+        uint32_t i = 0;
+        if (shape.hasType && i < length)
+        {
+            out[i++] = reader.next();
+        }
+        if (shape.hasResult && i < length)
+        {
+            lastResult += unzigzag(reader.next());
+            out[i++] = lastResult;
+        }
+        uint32_t idEnd = shape.ids == kAllIds ? length : std::min(length, i + shape.ids);
+        for (; i < idEnd; ++i)
+        {
+            out[i] = lastResult - unzigzag(reader.next());
+        }
+        if (shape.rawLiterals)
+        {
+            reader.raw(out + i, length - i);
+        }
+        else
+        {
+            for (; i < length; ++i)
+            {
+                out[i] = reader.next();
+            }
+        }
+        out += length;
+    }
+    if (!reader.done())
+    {
+        throwCorrupt();
+    }
+    return header.wordCount;
+}
+
+std::vector<uint32_t> decodeSpirv(std::span<const uint8_t> encoded)
+{
+    std::vector<uint32_t> words(decodedSpirvSize(encoded) / 4);
+    decodeSpirv(encoded, words);
+    return words;
+}
@@ -0,0 +1,39 @@
+#pragma once
+// SpirvCodec.h
+// Compact encoding for shipped SPIR-V, in the spirit of SMOL-V. Each
+// instruction becomes a varint header (frequent opcodes remapped to small
+// values, word count folded in) followed by its operands: result ids as a
+// delta from the previous result, id operands relative to the current
+// result, small literals as varints and string/float literals as raw words.
+// The result is far smaller than the input and compresses better with a
+// generic compressor on top. Decoding needs no allocation and writes
+// straight into a caller buffer.
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+constexpr uint32_t kEncodedSpirvMagic = 0x56505353; // "SSPV"
+constexpr uint32_t kEncodedSpirvVersion = 1;
+
+struct SpirvEncodeOptions
+{
+    // Drops OpName, OpMemberName, OpSource*, OpLine, OpNoLine and OpModuleProcessed.
+    // Ids and the id bound are unchanged, so the module stays valid.
+    bool stripDebug = false;
+};
+
+// Throws std::runtime_error if spirv is not a well-formed SPIR-V module
+std::vector<uint8_t> encodeSpirv(std::span<const uint8_t> spirv, const SpirvEncodeOptions& options = {});
+
+bool isEncodedSpirv(std::span<const uint8_t> data);
+
+// Size of the decoded module in bytes, or 0 if data is not encoded SPIR-V
+size_t decodedSpirvSize(std::span<const uint8_t> encoded);
+
+// Decodes into words, which must hold decodedSpirvSize() / 4 words. Returns the
+// number of words written. Throws std::runtime_error on corrupt input or a short buffer.
+size_t decodeSpirv(std::span<const uint8_t> encoded, std::span<uint32_t> words);
+
+// Allocating convenience form
+std::vector<uint32_t> decodeSpirv(std::span<const uint8_t> encoded);
@@ -0,0 +1,260 @@
+#include "VirtualFileSystem.h"
+#include "ShaderBlob.h"
+#include <fstream>
+#include <mutex>
+
+Slang::ComPtr<VirtualFileSystem> VirtualFileSystem::create()
+{
+    return Slang::ComPtr<VirtualFileSystem>(new VirtualFileSystem());
+}
+
+void VirtualFileSystem::setRoots(std::vector<std::filesystem::path> roots)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_roots = std::move(roots);
+}
+
+void VirtualFileSystem::addFile(const std::filesystem::path& path, std::string contents)
+{
+    std::vector<uint8_t> bytes(contents.begin(), contents.end());
+    Slang::ComPtr<slang::IBlob> blob = createBlob(std::move(bytes));
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_bundle[key(path)] = std::move(blob);
+}
+
+void VirtualFileSystem::setDiskAccess(bool enabled)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_diskAccess = enabled;
+}
+
+void VirtualFileSystem::setNegativeLookupLifetime(std::chrono::steady_clock::duration lifetime)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_negativeLookupLifetime = lifetime;
+}
+
+void VirtualFileSystem::invalidate()
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_files.clear();
+    m_missing.clear();
+}
+
+void VirtualFileSystem::invalidate(const std::vector<std::filesystem::path>& paths)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    for (const auto& path : paths)
+    {
+        m_files.erase(diskKey(path));
+    }
+    m_missing.clear();
+}
+
+std::filesystem::path VirtualFileSystem::locate(const std::filesystem::path& path)
+{
+    std::vector<std::filesystem::path> roots;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        if (m_bundle.count(key(path)) || !m_diskAccess)
+        {
+            return {};
+        }
+        roots = m_roots;
+    }
+
+    std::error_code error;
+    if (path.is_absolute() || roots.empty())
+    {
+        return std::filesystem::is_regular_file(path, error) ? path : std::filesystem::path();
+    }
+    for (const auto& root : roots)
+    {
+        std::filesystem::path full = root / path;
+        if (std::filesystem::is_regular_file(full, error))
+        {
+            return full;
+        }
+    }
+    return {};
+}
+
+Slang::ComPtr<slang::IBlob> VirtualFileSystem::read(const std::filesystem::path& path)
+{
+    m_loads.fetch_add(1, std::memory_order_relaxed);
+    std::vector<std::filesystem::path> roots;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto bundled = m_bundle.find(key(path));
+        if (bundled != m_bundle.end())
+        {
+            m_bundleHits.fetch_add(1, std::memory_order_relaxed);
+            return bundled->second;
+        }
+        if (!m_diskAccess)
+        {
+            m_negativeHits.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        roots = m_roots;
+    }
+
+    // A lookup is one negative hit when every candidate was already known missing
+    bool knownMissing = true;
+    if (path.is_absolute() || roots.empty())
+    {
+        roots.assign(1, std::filesystem::path());
+    }
+    for (const auto& root : roots)
+    {
+        bool missing = false;
+        if (Slang::ComPtr<slang::IBlob> contents = readFromDisk(root.empty() ? path : root / path, missing))
+        {
+            return contents;
+        }
+        knownMissing = knownMissing && missing;
+    }
+    if (knownMissing)
+    {
+        m_negativeHits.fetch_add(1, std::memory_order_relaxed);
+    }
+    return nullptr;
+}
+
+bool VirtualFileSystem::readText(const std::filesystem::path& path, std::string& contents)
+{
+    Slang::ComPtr<slang::IBlob> blob = read(path);
+    if (!blob)
+    {
+        return false;
+    }
+    contents.assign(static_cast<const char*>(blob->getBufferPointer()), blob->getBufferSize());
+    return true;
+}
+
+VirtualFileSystem::Stats VirtualFileSystem::stats() const
+{
+    Stats stats;
+    stats.loads = m_loads.load(std::memory_order_relaxed);
+    stats.bundleHits = m_bundleHits.load(std::memory_order_relaxed);
+    stats.cacheHits = m_cacheHits.load(std::memory_order_relaxed);
+    stats.negativeHits = m_negativeHits.load(std::memory_order_relaxed);
+    stats.diskReads = m_diskReads.load(std::memory_order_relaxed);
+    stats.bytesRead = m_bytesRead.load(std::memory_order_relaxed);
+    return stats;
+}
+
+SlangResult VirtualFileSystem::queryInterface(SlangUUID const& uuid, void** outObject)
+{
+    *outObject = castAs(uuid);
+    if (!*outObject)
+    {
+        return SLANG_E_NO_INTERFACE;
+    }
+    addRef();
+    return SLANG_OK;
+}
+
+uint32_t VirtualFileSystem::addRef()
+{
+    return m_refCount.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+uint32_t VirtualFileSystem::release()
+{
+    uint32_t remaining = m_refCount.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    if (remaining == 0)
+    {
+        delete this;
+    }
+    return remaining;
+}
+
+void* VirtualFileSystem::castAs(const SlangUUID& guid)
+{
+    if (guid == ISlangUnknown::getTypeGuid() || guid == ISlangCastable::getTypeGuid() ||
+        guid == ISlangFileSystem::getTypeGuid())
+    {
+        return static_cast<ISlangFileSystem*>(this);
+    }
+    return nullptr;
+}
+
+SlangResult VirtualFileSystem::loadFile(char const* path, ISlangBlob** outBlob)
+{
+    *outBlob = nullptr;
+    Slang::ComPtr<slang::IBlob> contents = read(path);
+    if (!contents)
+    {
+        return SLANG_E_NOT_FOUND;
+    }
+    *outBlob = contents.detach();
+    return SLANG_OK;
+}
+
+std::string VirtualFileSystem::key(const std::filesystem::path& path)
+{
+    return path.lexically_normal().generic_string();
+}
+
+std::string VirtualFileSystem::diskKey(const std::filesystem::path& path)
+{
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    return key(error ? path : absolute);
+}
+
+Slang::ComPtr<slang::IBlob> VirtualFileSystem::readFromDisk(const std::filesystem::path& path, bool& knownMissing)
+{
+    std::string resolved = diskKey(path);
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto missing = m_missing.find(resolved);
+        if (missing != m_missing.end() && now - missing->second < m_negativeLookupLifetime)
+        {
+            knownMissing = true;
+            return nullptr;
+        }
+    }
+
+    // file_size fails for directories and missing files alike
+    std::error_code error;
+    uintmax_t size = std::filesystem::file_size(path, error);
+    std::filesystem::file_time_type modified;
+    if (!error)
+    {
+        modified = std::filesystem::last_write_time(path, error);
+    }
+    if (error)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_missing[std::move(resolved)] = now;
+        return nullptr;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto cached = m_files.find(resolved);
+        if (cached != m_files.end() && cached->second.modified == modified && cached->second.size == size)
+        {
+            m_cacheHits.fetch_add(1, std::memory_order_relaxed);
+            return cached->second.contents;
+        }
+    }
+
+    std::ifstream stream(path, std::ios::in | std::ios::binary);
+    std::vector<uint8_t> bytes((size_t)size);
+    if (!stream.read(reinterpret_cast<char*>(bytes.data()), (std::streamsize)bytes.size()))
+    {
+        return nullptr;
+    }
+    m_diskReads.fetch_add(1, std::memory_order_relaxed);
+    m_bytesRead.fetch_add(size, std::memory_order_relaxed);
+
+    Slang::ComPtr<slang::IBlob> contents = createBlob(std::move(bytes));
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_files[resolved] = CachedFile{ modified, size, contents };
+    m_missing.erase(resolved); // An expired negative lookup
+    return contents;
+}
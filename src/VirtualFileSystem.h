@@ -0,0 +1,102 @@
+#pragma once
+// VirtualFileSystem.h
+// ISlangFileSystem that resolves module and include paths against configurable
+// roots and an in-memory bundle, with a content cache shared by every session
+// and thread using it. Cached files are revalidated by mtime and size, and a
+// path that does not exist is looked up on disk only once (until invalidate(),
+// or until the negative lookup lifetime runs out).
+// With disk access disabled only bundled files exist and nothing touches the disk.
+#include <slang.h>
+#include <slang-com-ptr.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class VirtualFileSystem final : public ISlangFileSystem
+{
+public:
+    struct Stats
+    {
+        uint64_t loads = 0;        // Lookups, from Slang or read()
+        uint64_t bundleHits = 0;
+        uint64_t cacheHits = 0;    // Served from cached contents after a stat
+        uint64_t negativeHits = 0; // Lookups answered "not found" without touching the disk
+        uint64_t diskReads = 0;
+        uint64_t bytesRead = 0;
+    };
+
+    static Slang::ComPtr<VirtualFileSystem> create();
+
+    // Relative paths are tried under each root in order; with no roots they are
+    // relative to the working directory. Absolute paths are used as they are.
+    void setRoots(std::vector<std::filesystem::path> roots);
+    // Served before anything on disk, under the path as given (relative paths are not rooted)
+    void addFile(const std::filesystem::path& path, std::string contents);
+    // Off: only bundled files exist
+    void setDiskAccess(bool enabled);
+    // How long "not found" is trusted before the disk is asked again; forever by
+    // default. Long-lived processes set this so files created later are found.
+    void setNegativeLookupLifetime(std::chrono::steady_clock::duration lifetime);
+    // Drops cached contents and negative lookups, e.g. after files were created
+    void invalidate();
+    // Drops the cached contents of just these files, plus every negative lookup
+    void invalidate(const std::vector<std::filesystem::path>& paths);
+
+    // Where read(path) finds the file on disk, or empty if it is bundled or missing
+    std::filesystem::path locate(const std::filesystem::path& path);
+
+    // Contents of path, or null if it does not exist
+    Slang::ComPtr<slang::IBlob> read(const std::filesystem::path& path);
+    bool readText(const std::filesystem::path& path, std::string& contents);
+    bool exists(const std::filesystem::path& path) { return read(path) != nullptr; }
+
+    Stats stats() const;
+
+    // ISlangUnknown
+    SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const& uuid, void** outObject) override;
+    SLANG_NO_THROW uint32_t SLANG_MCALL addRef() override;
+    SLANG_NO_THROW uint32_t SLANG_MCALL release() override;
+    // ISlangCastable
+    SLANG_NO_THROW void* SLANG_MCALL castAs(const SlangUUID& guid) override;
+    // ISlangFileSystem
+    SLANG_NO_THROW SlangResult SLANG_MCALL loadFile(char const* path, ISlangBlob** outBlob) override;
+
+private:
+    struct CachedFile
+    {
+        std::filesystem::file_time_type modified;
+        uintmax_t size = 0;
+        Slang::ComPtr<slang::IBlob> contents;
+    };
+
+    VirtualFileSystem() = default;
+
+    std::atomic<uint32_t> m_refCount{ 0 };
+    mutable std::shared_mutex m_mutex;
+    std::vector<std::filesystem::path> m_roots;
+    bool m_diskAccess = true;
+    std::chrono::steady_clock::duration m_negativeLookupLifetime = std::chrono::steady_clock::duration::max();
+    std::unordered_map<std::string, Slang::ComPtr<slang::IBlob>> m_bundle;
+    std::unordered_map<std::string, CachedFile> m_files; // By diskKey() of the resolved path
+    // Resolved paths known not to exist, and when that was found
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> m_missing;
+
+    std::atomic<uint64_t> m_loads{ 0 };
+    std::atomic<uint64_t> m_bundleHits{ 0 };
+    std::atomic<uint64_t> m_cacheHits{ 0 };
+    std::atomic<uint64_t> m_negativeHits{ 0 };
+    std::atomic<uint64_t> m_diskReads{ 0 };
+    std::atomic<uint64_t> m_bytesRead{ 0 };
+
+    static std::string key(const std::filesystem::path& path);
+    // Absolute, so a file is cached once however it was reached
+    static std::string diskKey(const std::filesystem::path& path);
+    // knownMissing is set when a cached negative lookup answered without touching the disk
+    Slang::ComPtr<slang::IBlob> readFromDisk(const std::filesystem::path& path, bool& knownMissing);
+};
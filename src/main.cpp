@@ -1,7 +1,33 @@
+#include "AtomicFile.h"
+#include "BatchCompiler.h"
+#include "CompileDaemon.h"
+#include "CompileTrace.h"
+#include "CompilerPool.h"
+#include "LazyProgram.h"
+#include "ModuleCache.h"
+#include "PipelineLayout.h"
+#include "PipelineLayoutRegistry.h"
+#include "ShaderArchive.h"
 #include "ShaderCompiler.h"
+#include "ShaderDiskCache.h"
+#include "ShaderMemoryCache.h"
+#include "ShaderWatcher.h"
+#include "SpirvCodec.h"
+#include "VirtualFileSystem.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
+// Harness checks stay on in release builds; a failure fails the example it is in
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+void check(bool condition, const char* expression, int line) {
+    if (!condition) {
+        throw std::runtime_error("Check failed at main.cpp:" + std::to_string(line) + ": " + expression);
+    }
+}
+
 void printUsage(const char* programName) {
     std::cout << "Slang Shader Compiler Test Harness\n";
     std::cout << "Usage:\n";
@@ -10,6 +36,18 @@ void printUsage(const char* programName) {
     std::cout << "  -string                      Run hardcoded string example\n";
     std::cout << "  -file <path>                 Run file example (default: shaders/obj_tex_shader.slang)\n";
     std::cout << "  -entry <name1,name2,...>     Specify entry points (default: vertexMain,fragmentMain)\n";
+    std::cout << "  -cache <dir>                 Reuse compiled shaders, module IR and the core module from a cache in <dir>\n";
+    std::cout << "  -root <dir>                  Resolve shader and import paths under <dir> (repeatable, default: working directory)\n";
+    std::cout << "  -watch                       Recompile the file example whenever it or its imports change\n";
+    std::cout << "  -trace <file>                Write a Chrome/Perfetto trace of every compile phase to <file>\n";
+    std::cout << "  -manifest <file>             Compile every shader listed in <file> (see BatchCompiler.h) and exit\n";
+    std::cout << "  -j <n>                       Worker threads for -manifest (default: one per hardware thread)\n";
+    std::cout << "  -out <dir>                   Output directory for -manifest (default: shader_out)\n";
+    std::cout << "  -force                       Recompile -manifest shaders even if their inputs are unchanged\n";
+    std::cout << "  -max-rss <MB>                Drop warm sessions and run one job at a time while RSS is above <MB>\n";
+    std::cout << "  -daemon <socket>             Serve compile requests on a Unix domain socket until shut down\n";
+    std::cout << "  -connect <socket>            Send -manifest or -file work to a running daemon instead of compiling here\n";
+    std::cout << "  -shutdown                    With -connect, stop the daemon\n";
     std::cout << "  <path>                       Quick file test (shorthand for -file <path>)\n";
     std::cout << "  (no args)                    Run both examples with defaults\n\n";
     std::cout << "Examples:\n";
@@ -17,23 +55,81 @@ void printUsage(const char* programName) {
     std::cout << "  " << programName << " shaders/test.slang -entry computeMain\n";
 }
 
-void stringExample(SlangCompiler& compiler, const std::string& source, const std::vector<std::string>& entryPoints, const std::string& path = "") {
-        // Get all shaders as GLSL
-        auto glslShaders = compiler.compileToGLSL(source, entryPoints, path);
-        std::cout << "Compiled " << glslShaders.size() << " GLSL shaders:\n";
-        for (const auto& shader : glslShaders)
+void stringExample(SlangCompiler& compiler, std::string_view source, const std::vector<std::string>& entryPoints, const std::string& path = "") {
+        // Get all shaders as GLSL and SPIR-V from a single parse/link
+        MultiTargetOutput shaders = compiler.compileToTargets(source, entryPoints, { SLANG_GLSL, SLANG_SPIRV }, path);
+        std::cout << "Compiled " << shaders.entryPoints.size() << " GLSL shaders:\n";
+        for (size_t i = 0; i < shaders.entryPoints.size(); ++i)
         {
+            const ShaderOutput& shader = shaders.at(i, 0);
             std::cout << "\n=== " << shader.entryPointName << " ===\n";
-            std::cout << shader.asText() << "\n";
+            std::cout << shader.text() << "\n";
+        }
+
+        std::cout << "\nCompiled " << shaders.entryPoints.size() << " SPIR-V shaders:\n";
+        ShaderArchiveWriter archiveWriter;
+        archiveWriter.setSpirvEncoding(true);
+        for (size_t i = 0; i < shaders.entryPoints.size(); ++i)
+        {
+            const ShaderOutput& shader = shaders.at(i, 1);
+            // Compact encoding round trip, with and without debug names
+            std::vector<uint8_t> encoded = encodeSpirv(shader.bytes());
+            std::vector<uint8_t> stripped = encodeSpirv(shader.bytes(), { true });
+            std::vector<uint32_t> decoded(decodedSpirvSize(encoded) / 4);
+            CHECK(decodeSpirv(encoded, decoded) * 4 == shader.bytes().size());
+            CHECK(std::memcmp(decoded.data(), shader.bytes().data(), shader.bytes().size()) == 0);
+            CHECK(decodeSpirv(stripped).size() * 4 <= shader.bytes().size());
+            std::cout << shader.entryPointName << ": " << shader.bytes().size() << " bytes, "
+                << encoded.size() << " encoded, " << stripped.size() << " without debug names\n";
+            archiveWriter.add("example", shader);
+        }
+        std::shared_ptr<const ShaderArchive> archive = ShaderArchive::fromBytes(archiveWriter.build());
+        for (size_t i = 0; i < archive->size(); ++i)
+        {
+            ArchiveShader archived = archive->shader(i);
+            ShaderOutput restored = archive->toOutput(archived);
+            const ShaderOutput* original = shaders.find(restored.entryPointName, SLANG_SPIRV);
+            CHECK(archived.encoding == ArchiveCodeEncoding::EncodedSpirv && original);
+            CHECK(std::ranges::equal(restored.bytes(), original->bytes()));
         }
 
-        // Get all shaders as SPIR-V
-        auto spirvShaders = compiler.compileToSPIRV(source, entryPoints, path);
-        std::cout << "\nCompiled " << spirvShaders.size() << " SPIR-V shaders:\n";
-        for (const auto& shader : spirvShaders)
+        // Whole-program SPIR-V: one module shared by every entry point's output
+        CompileJob wholeProgramJob;
+        wholeProgramJob.sourceView.text = source;
+        wholeProgramJob.path = path;
+        wholeProgramJob.entryPoints = entryPoints;
+        wholeProgramJob.targets = { SLANG_SPIRV };
+        wholeProgramJob.options.wholeProgram = true;
+        std::vector<ShaderOutput> wholeProgram = compiler.compile(wholeProgramJob);
+        CHECK(wholeProgram.size() == entryPoints.size());
+        for (size_t i = 0; i < wholeProgram.size(); ++i)
         {
-            std::cout << shader.entryPointName << ": " << shader.binaryData.size() << " bytes\n";
+            CHECK(wholeProgram[i].entryPointName == entryPoints[i] && wholeProgram[i].codeBlob == wholeProgram[0].codeBlob);
         }
+        size_t perEntryBytes = 0;
+        for (size_t i = 0; i < shaders.entryPoints.size(); ++i)
+        {
+            perEntryBytes += shaders.at(i, 1).bytes().size();
+        }
+        std::cout << "\nWhole-program SPIR-V: " << uniqueCodeBytes(wholeProgram) << " bytes for "
+            << wholeProgram.size() << " entry points (" << perEntryBytes << " as separate modules)\n";
+
+        // Lazy program: only the stages that are asked for are generated
+        CompileJob lazyJob;
+        lazyJob.sourceView.text = source;
+        lazyJob.path = path;
+        lazyJob.entryPoints = entryPoints;
+        lazyJob.targets = { SLANG_GLSL, SLANG_SPIRV };
+        std::shared_ptr<const LazyProgram> lazy = compiler.compileLazy(lazyJob);
+        const ShaderOutput& lazyVertex = lazy->output(entryPoints[0], SLANG_SPIRV);
+        CHECK(lazy->generated(0, 1) && std::ranges::equal(lazyVertex.bytes(), shaders.at(0, 1).bytes()));
+        MultiTargetOutput materialized = lazy->materialize();
+        CHECK(materialized.outputs.size() == shaders.outputs.size());
+        for (size_t i = 0; i < materialized.outputs.size(); ++i)
+        {
+            CHECK(std::ranges::equal(materialized.outputs[i].bytes(), shaders.outputs[i].bytes()));
+        }
+        std::cout << "\nLazy program: " << lazy->generatedCount() << " outputs generated on demand\n";
 
         // Single entry point convenience method
         std::string singleGlsl = compiler.compileToGLSLSingle(source, "vertexMain", path);
@@ -42,22 +138,18 @@ void stringExample(SlangCompiler& compiler, const std::string& source, const std
 }
 
 void fileExample(SlangCompiler& compiler, const std::vector<std::string>& entryPoints, const std::string& path) {
-    std::ifstream stream(path, std::ios::in);
-    if (!stream.is_open()) {
-        throw std::runtime_error("Failed to open shader file: " + path);
-    }
-    std::string source = std::string{(std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>()};
-    stringExample(compiler, source, entryPoints, path);
+    ShaderSource source = ShaderSource::readFile(path, compiler.fileSystem().get());
+    stringExample(compiler, source.text, entryPoints, path);
 }
 
-void TestShaderReflection(SlangCompiler& compiler, const std::string& source, const std::vector<std::string>& entryPoints, const std::string& path = "") 
+void TestShaderReflection(SlangCompiler& compiler, std::string_view source, const std::vector<std::string>& entryPoints, const std::string& path = "") 
 {
     std::vector<ShaderOutput> shaderOutputs = compiler.compileToHLSL(source, entryPoints, path);
     ShaderOutput shaderOutput{ shaderOutputs.at(0) };
 
     // 2. Print extracted bindings
     std::cout << "=== Texture Shader Reflection ===" << std::endl;
-    for (const auto& binding : shaderOutput.resourceBindings)
+    for (const auto& binding : shaderOutput.resourceBindings())
     {
         std::cout << "Name: " << binding.name
             << ", Type: " << (int)binding.resourceType
@@ -67,45 +159,375 @@ void TestShaderReflection(SlangCompiler& compiler, const std::string& source, co
     }
 
     // 3. Verify expected bindings
-    assert(shaderOutput.resourceBindings.size() == 6); // b0, b1, b2, t0, s0
+    CHECK(shaderOutput.resourceBindings().size() == 6); // b0, b1, b2, t0, s0
+
+    // Every entry point shares the same reflection table
+    for (const auto& output : shaderOutputs) {
+        CHECK(output.reflection == shaderOutput.reflection);
+    }
 
     // Find each binding and verify
     auto findBinding = [&](const std::string& name) {
-        auto it = std::find_if(shaderOutput.resourceBindings.begin(),
-            shaderOutput.resourceBindings.end(),
-            [&](const auto& b) { return b.name == name; });
-        assert(it != shaderOutput.resourceBindings.end());
-        return *it;
+        const ShaderResourceBinding* found = shaderOutput.reflection->findByName(name);
+        CHECK(found != nullptr);
+        return *found;
         };
 
     auto globals = findBinding("Globals");
-    assert(globals.resourceType == ShaderResourceBinding::ResourceType::ConstantBuffer);
-    assert(globals.binding == 0 && globals.set == 0);
+    CHECK(globals.resourceType == ShaderResourceBinding::ResourceType::ConstantBuffer);
+    CHECK(globals.binding == 0 && globals.set == 0);
 
     auto colors = findBinding("FragmentColors");
-    assert(colors.resourceType == ShaderResourceBinding::ResourceType::ConstantBuffer);
-    assert(colors.binding == 1 && colors.set == 0);
+    CHECK(colors.resourceType == ShaderResourceBinding::ResourceType::ConstantBuffer);
+    CHECK(colors.binding == 1 && colors.set == 0);
 
     auto camera = findBinding("FragmentCameraPos");
-    assert(camera.resourceType == ShaderResourceBinding::ResourceType::ConstantBuffer);
-    assert(camera.binding == 2 && camera.set == 0);
+    CHECK(camera.resourceType == ShaderResourceBinding::ResourceType::ConstantBuffer);
+    CHECK(camera.binding == 2 && camera.set == 0);
 
     auto texture = findBinding("TextureSampler");
-    assert(texture.resourceType == ShaderResourceBinding::ResourceType::Texture);
-    assert(texture.binding == 0 && texture.set == 0);
+    CHECK(texture.resourceType == ShaderResourceBinding::ResourceType::Texture);
+    CHECK(texture.binding == 0 && texture.set == 0);
+    CHECK(shaderOutput.reflection->findBySlot(0, 0, ShaderResourceBinding::ResourceType::Texture)->name == "TextureSampler");
 
     auto sampler = findBinding("TextureSampler_sampler");
-    assert(sampler.resourceType == ShaderResourceBinding::ResourceType::Sampler);
-    assert(sampler.binding == 0 && sampler.set == 0);
+    CHECK(sampler.resourceType == ShaderResourceBinding::ResourceType::Sampler);
+    CHECK(sampler.binding == 0 && sampler.set == 0);
+
+    // Space 0 holds everything: one CBV/SRV table plus a separate sampler table
+    RootSignatureDesc rootSignature = ToD3D12RootSignature(*shaderOutput.reflection);
+    CHECK(rootSignature.parameters.size() == 2);
+    CHECK(rootSignature.parameters[1].ranges.at(0).rangeType == DescriptorRangeType::Sampler);
+
+    // The same bindings declared in another order intern to the same layouts
+    auto reversedTable = [](const ReflectionTable& table) {
+        ReflectionTable::Builder builder;
+        std::span<const ShaderResourceBinding> bindings = table.bindings();
+        for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+            builder.add(*it);
+        }
+        return builder.build();
+    };
+    PipelineLayoutRegistry layoutRegistry;
+    PipelineLayoutHandle layout = layoutRegistry.intern(*shaderOutput.reflection, SLANG_HLSL);
+    PipelineLayoutHandle reversedLayout = layoutRegistry.intern(*reversedTable(*shaderOutput.reflection), SLANG_HLSL);
+    CHECK(layout.rootSignature == reversedLayout.rootSignature && *layout.rootSignature == rootSignature);
+    CHECK(layoutRegistry.findRootSignature(layout.rootSignatureHash) == layout.rootSignature);
+
+    // b0, t0 and s0 all sit at binding 0, which no Vulkan set layout can hold
+    bool rejected = false;
+    try {
+        ToVulkanDescriptorSetLayout(*shaderOutput.reflection);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    CHECK(rejected);
+
+    // Vulkan layouts come from SPIR-V reflection, where every slot is unique
+    std::vector<ShaderOutput> spirvOutputs = compiler.compileToSPIRV(source, entryPoints, path);
+    const ReflectionTable& spirvReflection = *spirvOutputs.at(0).reflection;
+    PipelineLayoutHandle vulkanLayout = layoutRegistry.intern(spirvReflection, SLANG_SPIRV);
+    PipelineLayoutHandle reversedVulkanLayout = layoutRegistry.intern(*reversedTable(spirvReflection), SLANG_SPIRV);
+    CHECK(vulkanLayout.vulkan == reversedVulkanLayout.vulkan && vulkanLayout.vulkanHash == reversedVulkanLayout.vulkanHash);
+    CHECK(vulkanLayout.sets.at(0) == reversedVulkanLayout.sets.at(0));
+    CHECK(layoutRegistry.findVulkan(vulkanLayout.vulkanHash) == vulkanLayout.vulkan);
+    CHECK(layoutRegistry.stats().hits == 2 && layoutRegistry.stats().rootSignatures == 1 &&
+        layoutRegistry.stats().vulkanLayouts == 1);
+    CHECK(shaderOutput.reflection->entryPoints().size() == entryPoints.size());
+
+    // Archive round trip: code and reflection are read in place
+    ShaderArchiveWriter archiveWriter;
+    archiveWriter.add("texture", shaderOutputs);
+    std::shared_ptr<const ShaderArchive> archive = ShaderArchive::fromBytes(archiveWriter.build());
+    std::optional<ArchiveShader> archived = archive->find({ "texture", shaderOutput.entryPointName, SLANG_HLSL });
+    CHECK(archived && archived->code.size() == shaderOutput.bytes().size());
+    CHECK(archived->reflection.bindings().size() == shaderOutput.resourceBindings().size());
+    CHECK(archived->reflection.findByName("TextureSampler_sampler")->binding == 0);
+    CHECK(!archive->find({ "texture", shaderOutput.entryPointName, SLANG_SPIRV }));
 
     std::cout << "All texture shader reflection tests passed!" << std::endl;
 }
 
+// Empty directory under the system temp directory, removed with everything in it
+struct ScratchDirectory {
+    std::filesystem::path path;
+    explicit ScratchDirectory(const std::string& name)
+        : path(uniqueTempPath(std::filesystem::temp_directory_path() / name)) {
+        std::filesystem::create_directories(path);
+    }
+    ~ScratchDirectory() {
+        std::error_code error;
+        std::filesystem::remove_all(path, error);
+    }
+};
+
+// Gives the compiler another file system and options for one test, restoring its own after
+struct ScopedFileSystem {
+    SlangCompiler& compiler;
+    Slang::ComPtr<VirtualFileSystem> previousFileSystem;
+    CompileOptions previousOptions;
+    ScopedFileSystem(SlangCompiler& compiler, Slang::ComPtr<VirtualFileSystem> fileSystem, const CompileOptions& options)
+        : compiler(compiler), previousFileSystem(compiler.fileSystem()), previousOptions(compiler.compileOptions()) {
+        compiler.setFileSystem(std::move(fileSystem));
+        compiler.setCompileOptions(options);
+    }
+    ~ScopedFileSystem() {
+        compiler.setFileSystem(previousFileSystem);
+        compiler.setCompileOptions(previousOptions);
+    }
+};
+
+void writeTextFile(const std::filesystem::path& path, std::string_view text) {
+    std::ofstream stream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    stream << text;
+    if (!stream.flush()) {
+        throw std::runtime_error("Cannot write " + path.string());
+    }
+}
+
+// -root with -watch: the shader and its imports are found, read and watched
+// under the root, including imports found through a relative search path
+void TestWatchUnderRoot(SlangCompiler& compiler) {
+    ScratchDirectory root("watch-root");
+    std::filesystem::create_directories(root.path / "lib");
+    writeTextFile(root.path / "lib" / "scale.slang", "float scale() { return 2.0; }\n");
+    writeTextFile(root.path / "watched.slang",
+        "import scale;\n"
+        "[shader(\"compute\")]\n"
+        "[numthreads(1, 1, 1)]\n"
+        "void computeMain(uniform RWStructuredBuffer<float> result) { result[0] = scale(); }\n");
+
+    Slang::ComPtr<VirtualFileSystem> rootedFileSystem = VirtualFileSystem::create();
+    rootedFileSystem->setRoots({ root.path });
+    CompileOptions options = compiler.compileOptions();
+    options.searchPaths = { "lib" };
+    ScopedFileSystem scoped(compiler, rootedFileSystem, options);
+
+    ShaderWatcher watcher(compiler);
+    CompileResult initial = watcher.addShader("watched.slang", { "computeMain" }, { SLANG_SPIRV });
+    CHECK(initial.succeeded());
+    CHECK(watcher.outputs("watched.slang") != nullptr);
+    std::vector<std::filesystem::path> importers = watcher.dependents(root.path / "lib" / "scale.slang");
+    CHECK(importers.size() == 1 && importers[0] == std::filesystem::absolute(root.path / "watched.slang").lexically_normal());
+
+    std::vector<uint8_t> before(initial.outputs.at(0).bytes().begin(), initial.outputs.at(0).bytes().end());
+    writeTextFile(root.path / "lib" / "scale.slang", "float scale() { return 3.0; }\n");
+    CHECK(watcher.poll(std::chrono::seconds(5)) == 1);
+    ShaderWatcher::Outputs rebuilt = watcher.outputs("watched.slang");
+    CHECK(rebuilt && !std::ranges::equal(rebuilt->at(0).bytes(), before));
+    std::cout << "Watch under -root test passed!" << std::endl;
+}
+
+// Bundled sources compile without touching the disk, and a missing file costs
+// one disk lookup, then one negative hit per lookup however many roots there are
+void TestBundledFileSystem(SlangCompiler& compiler) {
+    ScratchDirectory root("bundle-root");
+    Slang::ComPtr<VirtualFileSystem> bundle = VirtualFileSystem::create();
+    bundle->setRoots({ root.path, root.path / "second" });
+    bundle->addFile("bundled.slang",
+        "[shader(\"compute\")]\n"
+        "[numthreads(1, 1, 1)]\n"
+        "void computeMain(uniform RWStructuredBuffer<float> result) { result[0] = 1.0; }\n");
+    bundle->setDiskAccess(false);
+    ScopedFileSystem scoped(compiler, bundle, compiler.compileOptions());
+
+    CompileJob job;
+    job.sourceView = ShaderSource::readFile("bundled.slang", bundle.get());
+    job.path = "bundled.slang";
+    job.entryPoints = { "computeMain" };
+    job.targets = { SLANG_SPIRV };
+    std::vector<ShaderOutput> outputs = compiler.compile(job);
+    CHECK(outputs.size() == 1 && !outputs[0].empty());
+    CHECK(bundle->stats().diskReads == 0 && bundle->stats().bundleHits >= 1);
+
+    bundle->setDiskAccess(true);
+    VirtualFileSystem::Stats before = bundle->stats();
+    CHECK(!bundle->exists("missing.slang"));
+    CHECK(bundle->stats().negativeHits == before.negativeHits);
+    CHECK(!bundle->exists("missing.slang"));
+    CHECK(bundle->stats().negativeHits == before.negativeHits + 1 && bundle->stats().diskReads == 0);
+    std::cout << "Bundled file system test passed!" << std::endl;
+}
+
+// Disk cache round trip: a second compile is a hit with identical bytes, and a
+// truncated record is read as a miss and recompiled rather than trusted
+void TestDiskCache(SlangCompiler& compiler) {
+    ScratchDirectory directory("disk-cache");
+    auto diskCache = std::make_shared<ShaderDiskCache>(directory.path);
+    std::shared_ptr<ShaderMemoryCache> previousMemoryCache = compiler.memoryCache();
+    std::shared_ptr<ShaderDiskCache> previousDiskCache = compiler.diskCache();
+    struct RestoreCaches {
+        SlangCompiler& compiler;
+        std::shared_ptr<ShaderMemoryCache> memoryCache;
+        std::shared_ptr<ShaderDiskCache> diskCache;
+        ~RestoreCaches() {
+            compiler.setMemoryCache(memoryCache);
+            compiler.setDiskCache(diskCache);
+        }
+    } restore{ compiler, previousMemoryCache, previousDiskCache };
+    // Without this the second compile would never reach the disk cache
+    compiler.setMemoryCache(nullptr);
+    compiler.setDiskCache(diskCache);
+
+    CompileJob job;
+    job.source =
+        "[shader(\"compute\")]\n"
+        "[numthreads(4, 1, 1)]\n"
+        "void computeMain(uniform RWStructuredBuffer<float> result) { result[0] = 4.0; }\n";
+    job.path = "disk-cache.slang";
+    job.entryPoints = { "computeMain" };
+    job.targets = { SLANG_SPIRV };
+
+    std::vector<ShaderOutput> compiled = compiler.compile(job);
+    CHECK(compiled.size() == 1 && !compiled[0].empty());
+    CHECK(diskCache->stats().misses == 1 && diskCache->stats().writes == 1);
+    std::vector<ShaderOutput> cached = compiler.compile(job);
+    CHECK(diskCache->stats().hits == 1);
+    CHECK(cached.size() == 1 && std::ranges::equal(cached[0].bytes(), compiled[0].bytes()));
+
+    std::filesystem::path record;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory.path)) {
+        if (entry.is_regular_file()) {
+            record = entry.path();
+        }
+    }
+    CHECK(!record.empty());
+    std::filesystem::resize_file(record, std::filesystem::file_size(record) / 2);
+    std::vector<ShaderOutput> loaded;
+    std::string key = compiler.diskCacheKey(job.source, job.entryPoints, job.targets, job.path, job.options);
+    CHECK(!diskCache->load(key, loaded) && diskCache->stats().misses == 2);
+    std::vector<ShaderOutput> recompiled = compiler.compile(job);
+    CHECK(recompiled.size() == 1 && std::ranges::equal(recompiled[0].bytes(), compiled[0].bytes()));
+    CHECK(diskCache->stats().writes == 2);
+    std::cout << "Disk cache test passed!" << std::endl;
+}
+
+// compileAsync on one worker: queued jobs start in priority order, and a job
+// cancelled while queued completes as cancelled without being compiled
+void TestAsyncCompile() {
+    CompilerPool pool(1);
+    CompileJob job;
+    job.source =
+        "[shader(\"compute\")]\n"
+        "[numthreads(1, 1, 1)]\n"
+        "void computeMain(uniform RWStructuredBuffer<float> result) { result[0] = 1.0; }\n";
+    job.entryPoints = { "computeMain" };
+    job.targets = { SLANG_SPIRV };
+
+    // Holds the only worker until every job is queued
+    std::promise<void> started, release;
+    std::shared_future<void> released = release.get_future().share();
+    std::future<void> blocker = pool.run([&started, released](SlangCompiler&) {
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait();
+
+    std::mutex orderMutex;
+    std::vector<int> completionOrder;
+    auto submit = [&](int priority) {
+        return pool.compileAsync(job, priority, [&orderMutex, &completionOrder, priority](const CompileResult&) {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            completionOrder.push_back(priority);
+        });
+    };
+    CompileHandle low = submit(0);
+    CompileHandle cancelled = submit(3);
+    CompileHandle high = submit(2);
+    CompileHandle middle = submit(1);
+    cancelled.cancel();
+    release.set_value();
+    blocker.get();
+
+    CHECK(low.get().succeeded() && middle.get().succeeded() && high.get().succeeded());
+    CHECK(cancelled.get().cancelled && cancelled.get().outputs.empty());
+    // Runs after every job above on the same worker, so its compiler has seen them all
+    uint64_t compiledJobs = 0;
+    pool.run([&compiledJobs](SlangCompiler& compiler) { compiledJobs = compiler.memoryStats().jobs; }).get();
+    CHECK(compiledJobs == 3);
+    std::lock_guard<std::mutex> lock(orderMutex);
+    CHECK((completionOrder == std::vector<int>{ 3, 2, 1, 0 }));
+    std::cout << "Async compile test passed!" << std::endl;
+}
+
+void printMemoryStats(const CompilerPool::MemoryStats& stats) {
+    std::cout << "Memory: " << (stats.rssBytes >> 20) << " MB resident, " << (stats.peakRssBytes >> 20) << " MB peak; "
+        << stats.compilers.jobs << " job(s) returned " << stats.compilers.outputBytes << " code bytes and "
+        << stats.compilers.reflectionBytes << " reflection bytes; largest job peak +"
+        << (std::max<int64_t>(stats.compilers.peakRssDelta, 0) >> 10) << " KB; " << stats.liveSessions << " warm session(s) holding ~"
+        << (stats.compilers.sessionResidentBytes >> 20) << " MB\n";
+    if (stats.compilers.sessionSheds || stats.throttledJobs || stats.shedJobs) {
+        std::cout << "Memory budget: " << stats.compilers.sessionSheds << " session drop(s), "
+            << stats.throttledJobs << " job(s) delayed, " << stats.shedJobs << " job(s) shed\n";
+    }
+}
+
+int printBatchReport(const BatchReport& report) {
+    for (const auto& item : report.items) {
+        if (item.status == BatchItemResult::Status::Failed) {
+            std::cerr << "FAILED " << item.name << ": " << item.error << "\n";
+        } else {
+            std::cout << (item.status == BatchItemResult::Status::Compiled ? "compiled " : "up to date ") << item.name << "\n";
+        }
+    }
+    std::cout << "Batch: " << report.compiled << " compiled, " << report.skipped << " up to date, "
+        << report.failed << " failed\n";
+    return report.succeeded() ? 0 : 1;
+}
+
+// Thin client: the daemon does the work with its warm sessions and caches
+int runClient(const std::string& socketPath, const std::string& manifestPath, const BatchOptions& batchOptions,
+    bool shutdown, bool runFileTest, const std::string& testFilePath, const std::vector<std::string>& entryPoints) {
+    try
+    {
+        CompileClient client(socketPath);
+        int exitCode = 0;
+        if (!manifestPath.empty()) {
+            exitCode = printBatchReport(client.runBatch(manifestPath, batchOptions));
+        }
+        else if (runFileTest) {
+            CompileJob job;
+            job.path = testFilePath;
+            job.entryPoints = entryPoints;
+            job.targets = { SLANG_SPIRV };
+            job.sourceView = ShaderSource::readFile(testFilePath);
+            CompileResult result = client.compile(job);
+            if (!result.succeeded()) {
+                std::cerr << "Error: " << result.error << "\n";
+                exitCode = 1;
+            }
+            for (const auto& output : result.outputs) {
+                std::cout << output.entryPointName << ": " << output.bytes().size() << " bytes of SPIR-V\n";
+            }
+        }
+        if (shutdown) {
+            client.shutdownDaemon();
+        }
+        return exitCode;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
 int main(int argc, char* argv[])
 {
 	std::cout << "Slang Shader Compiler Example Tests:\n";
     std::string testFilePath = "shaders/obj_tex_shader.slang";
     std::vector<std::string> entryPoints = { "vertexMain", "fragmentMain" };
+    std::string cacheDirectory;
+    std::vector<std::filesystem::path> fileRoots;
+    bool watch = false;
+    std::string tracePath;
+    std::string manifestPath;
+    unsigned jobCount = 0;
+    BatchOptions batchOptions;
+    MemoryBudget memoryBudget;
+    std::string daemonSocket;
+    std::string connectSocket;
+    bool shutdownDaemon = false;
     uint16_t examplesFailed = 0;
 
     bool runStringTest = false, runFileTest = false;
@@ -141,6 +563,80 @@ int main(int argc, char* argv[])
                     return 1;
                 }
             }
+            else if (arg == "-cache") {
+                if (i + 1 < argc) {
+                    cacheDirectory = argv[++i];
+                } else {
+                    std::cerr << "Error: -cache requires a directory\n";
+                    return 1;
+                }
+            }
+            else if (arg == "-root") {
+                if (i + 1 < argc) {
+                    fileRoots.emplace_back(argv[++i]);
+                } else {
+                    std::cerr << "Error: -root requires a directory\n";
+                    return 1;
+                }
+            }
+            else if (arg == "-watch") {
+                watch = true;
+            }
+            else if (arg == "-trace") {
+                if (i + 1 < argc) {
+                    tracePath = argv[++i];
+                } else {
+                    std::cerr << "Error: -trace requires a file\n";
+                    return 1;
+                }
+            }
+            else if (arg == "-manifest") {
+                if (i + 1 < argc) {
+                    manifestPath = argv[++i];
+                } else {
+                    std::cerr << "Error: -manifest requires a file\n";
+                    return 1;
+                }
+            }
+            else if (arg == "-out") {
+                if (i + 1 < argc) {
+                    batchOptions.outputDirectory = argv[++i];
+                } else {
+                    std::cerr << "Error: -out requires a directory\n";
+                    return 1;
+                }
+            }
+            else if (arg == "-j") {
+                if (i + 1 < argc) {
+                    jobCount = (unsigned)std::stoul(argv[++i]);
+                } else {
+                    std::cerr << "Error: -j requires a worker count\n";
+                    return 1;
+                }
+            }
+            else if (arg == "-force") {
+                batchOptions.force = true;
+            }
+            else if (arg == "-max-rss") {
+                if (i + 1 < argc) {
+                    memoryBudget.sessionRssBytes = (size_t)std::stoull(argv[++i]) << 20;
+                    memoryBudget.queueRssBytes = memoryBudget.sessionRssBytes;
+                } else {
+                    std::cerr << "Error: -max-rss requires a size in MB\n";
+                    return 1;
+                }
+            }
+            else if (arg == "-daemon" || arg == "-connect") {
+                if (i + 1 < argc) {
+                    (arg == "-daemon" ? daemonSocket : connectSocket) = argv[++i];
+                } else {
+                    std::cerr << "Error: " << arg << " requires a socket path\n";
+                    return 1;
+                }
+            }
+            else if (arg == "-shutdown") {
+                shutdownDaemon = true;
+            }
             else if (arg == "-file") {
                 runFileTest = true;
                 if (i + 1 < argc && argv[i + 1][0] != '-') {
@@ -158,7 +654,104 @@ int main(int argc, char* argv[])
             }
         }
     }
+    // Installed before the compiler so global session creation is traced too
+    std::shared_ptr<ChromeTraceSink> traceSink;
+    std::shared_ptr<HistogramSink> histogramSink;
+    if (!tracePath.empty()) {
+        traceSink = std::make_shared<ChromeTraceSink>();
+        histogramSink = std::make_shared<HistogramSink>();
+        CompileTrace::setSink(std::make_shared<TeeTraceSink>(
+            std::vector<std::shared_ptr<TraceSink>>{ traceSink, histogramSink }));
+    }
+    auto reportTrace = [&]() {
+        if (!histogramSink) return;
+        for (const auto& [name, histogram] : histogramSink->histograms()) {
+            std::cout << "Trace " << name << ": " << histogram.count << " call(s), "
+                << histogram.totalUs << " us total, p50 <= " << histogram.percentileUs(0.5)
+                << " us, max " << histogram.maxUs << " us\n";
+        }
+        if (!traceSink->writeFile(tracePath)) {
+            std::cerr << "Error: cannot write trace to " << tracePath << "\n";
+        }
+    };
+
+    if (!cacheDirectory.empty()) {
+        SlangCompiler::setCoreModuleCache(std::filesystem::path(cacheDirectory) / "core");
+    }
+    // Source and import reads are cached and shared by every compiler in the process
+    Slang::ComPtr<VirtualFileSystem> fileSystem = VirtualFileSystem::create();
+    fileSystem->setRoots(fileRoots);
+
+    if (!connectSocket.empty()) {
+        return runClient(connectSocket, manifestPath, batchOptions, shutdownDaemon,
+            runFileTest, testFilePath, entryPoints);
+    }
+
+    if (!daemonSocket.empty()) {
+        try
+        {
+            CompilerPool pool(jobCount);
+            pool.setMemoryBudget(memoryBudget);
+            // Lives as long as the daemon; keyed on import contents, so it never goes stale
+            pool.setMemoryCache(std::make_shared<ShaderMemoryCache>());
+            // Same roots as -manifest; "not found" is rechecked so files created between requests are seen
+            fileSystem->setNegativeLookupLifetime(std::chrono::seconds(1));
+            pool.setFileSystem(fileSystem);
+            if (!cacheDirectory.empty()) {
+                pool.setDiskCache(std::make_shared<ShaderDiskCache>(cacheDirectory));
+            }
+            pool.setModuleCache(std::make_shared<ModuleCache>(cacheDirectory.empty()
+                ? std::filesystem::path() : std::filesystem::path(cacheDirectory) / "modules"));
+            CompileDaemon daemon(pool, daemonSocket);
+            std::cout << "Compile daemon listening on " << daemonSocket << " with " << pool.workerCount() << " worker(s)\n";
+            daemon.serve();
+            std::cout << "Compile daemon stopped after " << daemon.requestsServed() << " request(s)\n";
+            printMemoryStats(pool.memoryStats());
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        reportTrace();
+        return 0;
+    }
+
+    if (!manifestPath.empty()) {
+        BatchReport report;
+        try
+        {
+            std::vector<ManifestEntry> manifest = readManifest(manifestPath);
+            CompilerPool pool(jobCount);
+            pool.setMemoryBudget(memoryBudget);
+            pool.setFileSystem(fileSystem);
+            pool.setModuleCache(std::make_shared<ModuleCache>(cacheDirectory.empty()
+                ? std::filesystem::path() : std::filesystem::path(cacheDirectory) / "modules"));
+            report = runBatch(pool, manifest, batchOptions);
+            printMemoryStats(pool.memoryStats());
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        int exitCode = printBatchReport(report);
+        reportTrace();
+        return exitCode;
+    }
+
     SlangCompiler compiler;
+    compiler.setMemoryBudget(memoryBudget);
+    std::cout << "Global session: " << compiler.constructionTime().count() / 1000.0 << " ms ("
+        << (compiler.coreModuleFromCache() ? "core module snapshot" : "core module built") << ")\n";
+    compiler.setMemoryCache(std::make_shared<ShaderMemoryCache>());
+    compiler.setFileSystem(fileSystem);
+    if (!cacheDirectory.empty()) {
+        compiler.setDiskCache(std::make_shared<ShaderDiskCache>(cacheDirectory));
+        compiler.setModuleCache(std::make_shared<ModuleCache>(std::filesystem::path(cacheDirectory) / "modules"));
+    } else {
+        compiler.setModuleCache(std::make_shared<ModuleCache>());
+    }
     if (runStringTest) {
         try
         {
@@ -184,15 +777,36 @@ int main(int argc, char* argv[])
             std::cerr << "Error: " << e.what() << "\n";
             ++examplesFailed;
         }
+        try
+        {
+            TestAsyncCompile();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error: " << e.what() << "\n";
+            ++examplesFailed;
+        }
+        try
+        {
+            TestDiskCache(compiler);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error: " << e.what() << "\n";
+            ++examplesFailed;
+        }
     }
     if (runFileTest) {
+        // Read once through the file system cache; both examples compile the same text in place
+        Slang::ComPtr<slang::IBlob> sourceBlob;
+        std::string_view source;
         try
         {
-            std::ifstream stream(testFilePath, std::ios::in);
-            if (!stream.is_open()) {
+            sourceBlob = fileSystem->read(testFilePath);
+            if (!sourceBlob) {
                 throw std::runtime_error("Failed to open shader file. Check filename");
             }
-            std::string source = std::string{(std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>()};
+            source = { static_cast<const char*>(sourceBlob->getBufferPointer()), sourceBlob->getBufferSize() };
             stringExample(compiler, source, entryPoints, testFilePath);
         } 
         catch (const std::exception& e)
@@ -202,11 +816,9 @@ int main(int argc, char* argv[])
         }
         try
         {
-			std::ifstream stream(testFilePath, std::ios::in);
-			if (!stream.is_open()) {
-				throw std::runtime_error("Failed to open shader file. Check filename");
-			}
-			std::string source = std::string{(std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>()};
+            if (source.empty()) {
+                throw std::runtime_error("Failed to open shader file. Check filename");
+            }
             TestShaderReflection(compiler, source, entryPoints, testFilePath);
 
         }
@@ -215,8 +827,64 @@ int main(int argc, char* argv[])
             std::cerr << "Error: " << e.what() << "\n";
             ++examplesFailed;
         }
+        try
+        {
+            TestWatchUnderRoot(compiler);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error: " << e.what() << "\n";
+            ++examplesFailed;
+        }
+        try
+        {
+            TestBundledFileSystem(compiler);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error: " << e.what() << "\n";
+            ++examplesFailed;
+        }
     }
+    SessionPool::Stats poolStats = compiler.sessionPoolStats();
+    std::cout << "Session pool: " << poolStats.hits << " hit(s), " << poolStats.misses
+        << " miss(es), " << poolStats.evictions << " eviction(s)\n";
+    std::cout << "Memory: " << (currentRssBytes() >> 20) << " MB resident, " << (peakRssBytes() >> 20) << " MB peak\n";
+    ShaderMemoryCache::Stats memoryStats = compiler.memoryCache()->stats();
+    std::cout << "Memory cache: " << memoryStats.hits << " hit(s), " << memoryStats.misses
+        << " miss(es), " << memoryStats.entries << " entries, " << memoryStats.bytes << " bytes\n";
+    ModuleCache::Stats moduleStats = compiler.moduleCache()->stats();
+    std::cout << "Module cache: " << moduleStats.hits << " loaded from IR, "
+        << moduleStats.misses << " compiled from source\n";
+    VirtualFileSystem::Stats fileStats = fileSystem->stats();
+    std::cout << "File system: " << fileStats.loads << " lookup(s), " << fileStats.diskReads << " disk read(s) ("
+        << fileStats.bytesRead << " bytes), " << fileStats.cacheHits << " cached, " << fileStats.negativeHits
+        << " known missing\n";
+    if (compiler.diskCache()) {
+        ShaderDiskCache::Stats cacheStats = compiler.diskCache()->stats();
+        std::cout << "Disk cache: " << cacheStats.hits << " hit(s), " << cacheStats.misses
+            << " miss(es), " << cacheStats.writes << " write(s), " << cacheStats.bytesOnDisk << " bytes\n";
+    }
+    reportTrace();
     std::cout << "Summary: " << examplesFailed << " example(s) failed.\n";
+
+    if (watch) {
+        ShaderWatcher watcher(compiler);
+        watcher.setCallback([](const ShaderWatcher::Rebuild& rebuilt) {
+            if (rebuilt.result.succeeded()) {
+                std::cout << "Rebuilt " << rebuilt.shader.string() << " in " << rebuilt.latency.count() / 1000.0 << " ms\n";
+            } else {
+                std::cerr << "Rebuild of " << rebuilt.shader.string() << " failed: " << rebuilt.result.error << "\n";
+            }
+        });
+        CompileResult initial = watcher.addShader(testFilePath, entryPoints, { SLANG_SPIRV });
+        if (!initial.succeeded()) {
+            std::cerr << "Error: " << initial.error << "\n";
+        }
+        std::cout << "Watching " << testFilePath << (watcher.usesInotify() ? " (inotify)" : " (polling)")
+            << ", press Ctrl+C to stop\n";
+        watcher.run();
+    }
     if (examplesFailed > 0) return 1;
     return 0;
 }